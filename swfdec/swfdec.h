@@ -29,6 +29,7 @@
 #include <swfdec/swfdec_as_function.h>
 #include <swfdec/swfdec_as_native_function.h>
 #include <swfdec/swfdec_as_object.h>
+#include <swfdec/swfdec_as_profiler.h>
 #include <swfdec/swfdec_as_relay.h>
 #include <swfdec/swfdec_as_types.h>
 #include <swfdec/swfdec_script.h>
@@ -38,8 +39,10 @@
 #include <swfdec/swfdec_enums.h>
 #include <swfdec/swfdec_file_loader.h>
 #include <swfdec/swfdec_keys.h>
+#include <swfdec/swfdec_load_cache.h>
 #include <swfdec/swfdec_loader.h>
 #include <swfdec/swfdec_player.h>
+#include <swfdec/swfdec_player_pool.h>
 #include <swfdec/swfdec_player_scripting.h>
 #include <swfdec/swfdec_rectangle.h>
 #include <swfdec/swfdec_renderer.h>
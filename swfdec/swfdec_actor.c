@@ -39,6 +39,7 @@ swfdec_actor_dispose (GObject *object)
 {
   SwfdecActor *actor = SWFDEC_ACTOR (object);
 
+  g_assert (g_queue_is_empty (&actor->actions));
   if (actor->events) {
     swfdec_event_list_free (actor->events);
     actor->events = NULL;
@@ -155,6 +156,9 @@ swfdec_actor_constructor (GType type, guint n_construct_properties,
    * cause new movies to be created (and added to this list).
    */
   priv->actors = g_list_prepend (priv->actors, object);
+  /* new actors are always iterated once, they're the newest so they go first */
+  SWFDEC_ACTOR (object)->serial = priv->actor_serial++;
+  SWFDEC_ACTOR (object)->active = g_sequence_prepend (priv->active_actors, object);
 
   return object;
 }
@@ -359,6 +363,99 @@ swfdec_actor_queue_script (SwfdecActor *actor, SwfdecEventType condition)
   swfdec_actor_queue_script_with_key (actor, condition, 0);
 }
 
+/*** ITERATING ***/
+
+/* The player only iterates actors that need it. Those are kept in a 
+ * sequence sorted like the player's list of actors: newest actor first.
+ * Actors get removed from it by the player when iterating them does nothing
+ * anymore and have to be added back using swfdec_actor_activate() whenever 
+ * something happens that makes swfdec_actor_needs_iterate() return %TRUE.
+ */
+
+static int
+swfdec_actor_compare_serial (gconstpointer a, gconstpointer b, gpointer unused)
+{
+  guint sa = ((const SwfdecActor *) a)->serial;
+  guint sb = ((const SwfdecActor *) b)->serial;
+
+  if (sa == sb)
+    return 0;
+  return sa > sb ? -1 : 1;
+}
+
+/**
+ * swfdec_actor_activate:
+ * @actor: a #SwfdecActor
+ *
+ * Makes sure the player iterates @actor again. Call this function whenever
+ * the state of @actor changes in a way that causes 
+ * swfdec_actor_needs_iterate() to return %TRUE.
+ **/
+void
+swfdec_actor_activate (SwfdecActor *actor)
+{
+  SwfdecPlayerPrivate *priv;
+
+  g_return_if_fail (SWFDEC_IS_ACTOR (actor));
+
+  if (actor->active != NULL ||
+      SWFDEC_MOVIE (actor)->state >= SWFDEC_MOVIE_STATE_DESTROYED)
+    return;
+
+  priv = SWFDEC_PLAYER (swfdec_gc_object_get_context (actor))->priv;
+  actor->active = g_sequence_insert_sorted (priv->active_actors, actor,
+      swfdec_actor_compare_serial, NULL);
+}
+
+/**
+ * swfdec_actor_deactivate:
+ * @actor: a #SwfdecActor
+ *
+ * Stops iterating @actor until swfdec_actor_activate() is called.
+ **/
+void
+swfdec_actor_deactivate (SwfdecActor *actor)
+{
+  g_return_if_fail (SWFDEC_IS_ACTOR (actor));
+
+  if (actor->active == NULL)
+    return;
+
+  g_sequence_remove (actor->active);
+  actor->active = NULL;
+}
+
+/**
+ * swfdec_actor_needs_iterate:
+ * @actor: a #SwfdecActor
+ *
+ * Checks if iterating @actor can have any effect. This is the case for 
+ * removed movies that need to be destroyed and for actors whose 
+ * needs_iterate vfunc says so.
+ *
+ * Returns: %TRUE if the player needs to iterate @actor
+ **/
+gboolean
+swfdec_actor_needs_iterate (SwfdecActor *actor)
+{
+  SwfdecActorClass *klass;
+  SwfdecMovie *movie;
+
+  g_return_val_if_fail (SWFDEC_IS_ACTOR (actor), TRUE);
+
+  movie = SWFDEC_MOVIE (actor);
+  /* see swfdec_actor_iterate_end() */
+  if (movie->state >= SWFDEC_MOVIE_STATE_REMOVED)
+    return movie->parent != NULL;
+
+  klass = SWFDEC_ACTOR_GET_CLASS (actor);
+  if (klass->iterate_start == NULL)
+    return FALSE;
+  if (klass->needs_iterate == NULL)
+    return TRUE;
+  return klass->needs_iterate (actor);
+}
+
 /**
  * swfdec_actor_get_mouse_events:
  * @movie: a #SwfdecActor
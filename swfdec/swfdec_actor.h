@@ -48,6 +48,11 @@ struct _SwfdecActor
 
   /* sound */
   SwfdecSoundMatrix	sound_matrix;		/* movie's sound matrix */
+
+  /* iterating */
+  guint			serial;			/* creation order, newer actors have higher serials */
+  GSequenceIter *	active;			/* position in the player's active actors or NULL */
+  GQueue		actions;		/* actions queued in the player for this actor */
 };
 
 struct _SwfdecActorClass
@@ -58,6 +63,7 @@ struct _SwfdecActorClass
   void			(* update_matrix)	(SwfdecActor *		actor);
 
   /* iterating */
+  gboolean		(* needs_iterate)	(SwfdecActor *		actor);
   void			(* iterate_start)     	(SwfdecActor *		actor);
   gboolean		(* iterate_end)		(SwfdecActor *		actor);
 
@@ -96,6 +102,10 @@ void		swfdec_actor_queue_script_with_key (SwfdecActor *		actor,
 void		swfdec_actor_queue_script	(SwfdecActor *		actor,
   						 SwfdecEventType	condition);
 
+void		swfdec_actor_activate		(SwfdecActor *		actor);
+void		swfdec_actor_deactivate		(SwfdecActor *		actor);
+gboolean	swfdec_actor_needs_iterate	(SwfdecActor *		actor);
+
 gboolean	swfdec_actor_get_mouse_events	(SwfdecActor *		actor);
 gboolean	swfdec_actor_has_focusrect	(SwfdecActor *		actor);
 
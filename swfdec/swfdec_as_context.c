@@ -35,6 +35,7 @@
 #include "swfdec_as_movie_value.h"
 #include "swfdec_as_native_function.h"
 #include "swfdec_as_object.h"
+#include "swfdec_as_profiler_internal.h"
 #include "swfdec_as_stack.h"
 #include "swfdec_as_strings.h"
 #include "swfdec_as_types.h"
@@ -182,7 +183,9 @@ swfdec_as_context_abort (SwfdecAsContext *context, const char *reason)
  *
  * Tries to register @bytes additional bytes as in use by the @context. This
  * function keeps track of the memory that script code consumes. The scripting
- * engine won't be stopped, even if there wasn't enough memory left.
+ * engine won't be stopped, even if there wasn't enough memory left. Allocations
+ * fail when they would exceed the limit set with 
+ * swfdec_as_context_set_max_memory().
  *
  * Returns: %TRUE if the memory could be allocated. %FALSE on OOM.
  **/
@@ -194,6 +197,11 @@ swfdec_as_context_try_use_mem (SwfdecAsContext *context, gsize bytes)
 
   if (context->state == SWFDEC_AS_CONTEXT_ABORTED)
     return FALSE;
+  if (context->priv->max_memory > 0 && context->memory + bytes > context->priv->max_memory) {
+    SWFDEC_INFO ("not allocating %"G_GSIZE_FORMAT" bytes, limit of %"G_GSIZE_FORMAT" bytes reached",
+	bytes, context->priv->max_memory);
+    return FALSE;
+  }
   
   context->memory += bytes;
   context->memory_since_gc += bytes;
@@ -248,6 +256,40 @@ swfdec_as_context_unuse_mem (SwfdecAsContext *context, gsize bytes)
       bytes, context->memory, context->memory_since_gc);
 }
 
+/**
+ * swfdec_as_context_get_max_memory:
+ * @context: a #SwfdecAsContext
+ *
+ * Queries the maximum amount of memory scripts in @context may use. See
+ * swfdec_as_context_set_max_memory() for details.
+ *
+ * Returns: the maximum amount of memory in bytes or 0 for no limit
+ **/
+gsize
+swfdec_as_context_get_max_memory (SwfdecAsContext *context)
+{
+  g_return_val_if_fail (SWFDEC_IS_AS_CONTEXT (context), 0);
+
+  return context->priv->max_memory;
+}
+
+/**
+ * swfdec_as_context_set_max_memory:
+ * @context: a #SwfdecAsContext
+ * @bytes: the maximum amount of memory in bytes or 0 for no limit
+ *
+ * Limits the amount of memory scripts in @context may use. When the limit is
+ * reached, swfdec_as_context_try_use_mem() fails.
+ **/
+void
+swfdec_as_context_set_max_memory (SwfdecAsContext *context, gsize bytes)
+{
+  g_return_if_fail (SWFDEC_IS_AS_CONTEXT (context));
+
+  context->priv->max_memory = bytes;
+  g_object_notify (G_OBJECT (context), "max-memory");
+}
+
 /*** GC ***/
 
 static void
@@ -282,8 +324,15 @@ static void
 swfdec_as_context_collect_string (SwfdecAsContext *context, gpointer gc)
 {
   SwfdecAsStringValue *string;
+  SwfdecAsStringCursor *bucket;
+  guint i;
 
   string = gc;
+  bucket = SWFDEC_AS_CONTEXT_STRING_CURSOR_BUCKET (context, string->string);
+  for (i = 0; i < SWFDEC_AS_CONTEXT_STRING_CURSOR_WAYS; i++) {
+    if (bucket[i].string == string->string)
+      bucket[i].string = NULL;
+  }
   if (!g_hash_table_remove (context->interned_strings, string->string)) {
     g_assert_not_reached ();
   }
@@ -315,6 +364,8 @@ swfdec_as_context_collect (SwfdecAsContext *context)
   SWFDEC_INFO (">> collecting garbage");
   
   swfdec_as_context_remove_gc_objects (context);
+  /* cached strings aren't marked, so they may go away */
+  memset (context->priv->integer_strings, 0, sizeof (context->priv->integer_strings));
 
   context->objects = swfdec_as_gcable_collect (context, context->objects,
       (SwfdecAsGcableDestroyNotify) swfdec_as_object_free);
@@ -345,7 +396,7 @@ swfdec_as_string_mark (const char *string)
 
   g_return_if_fail (string != NULL);
 
-  value = (SwfdecAsStringValue *) (gpointer) ((guint8 *) string - G_STRUCT_OFFSET (SwfdecAsStringValue, string));
+  value = SWFDEC_AS_STRING_VALUE (string);
   if (!SWFDEC_AS_GCABLE_FLAG_IS_SET (value, SWFDEC_AS_GC_ROOT))
     SWFDEC_AS_GCABLE_SET_FLAG (value, SWFDEC_AS_GC_MARK);
 }
@@ -481,9 +532,11 @@ enum {
 enum {
   PROP_0,
   PROP_DEBUGGER,
+  PROP_PROFILER,
   PROP_RANDOM_SEED,
   PROP_ABORTED,
-  PROP_UNTIL_GC
+  PROP_UNTIL_GC,
+  PROP_MAX_MEMORY
 };
 
 G_DEFINE_TYPE (SwfdecAsContext, swfdec_as_context, G_TYPE_OBJECT)
@@ -499,12 +552,18 @@ swfdec_as_context_get_property (GObject *object, guint param_id, GValue *value,
     case PROP_DEBUGGER:
       g_value_set_object (value, context->debugger);
       break;
+    case PROP_PROFILER:
+      g_value_set_object (value, context->profiler);
+      break;
     case PROP_ABORTED:
       g_value_set_boolean (value, context->state == SWFDEC_AS_CONTEXT_ABORTED);
       break;
     case PROP_UNTIL_GC:
       g_value_set_ulong (value, (gulong) context->memory_until_gc);
       break;
+    case PROP_MAX_MEMORY:
+      g_value_set_ulong (value, (gulong) context->priv->max_memory);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
       break;
@@ -521,12 +580,26 @@ swfdec_as_context_set_property (GObject *object, guint param_id, const GValue *v
     case PROP_DEBUGGER:
       context->debugger = SWFDEC_AS_DEBUGGER (g_value_dup_object (value));
       break;
+    case PROP_PROFILER:
+      {
+	SwfdecAsFrame *frame;
+	if (context->profiler)
+	  g_object_unref (context->profiler);
+	context->profiler = g_value_dup_object (value);
+	/* stack nodes belong to the old profiler */
+	for (frame = context->frame; frame; frame = frame->next)
+	  frame->profile_node = 0;
+      }
+      break;
     case PROP_RANDOM_SEED:
       g_rand_set_seed (context->rand, g_value_get_uint (value));
       break;
     case PROP_UNTIL_GC:
       context->memory_until_gc = g_value_get_ulong (value);
       break;
+    case PROP_MAX_MEMORY:
+      swfdec_as_context_set_max_memory (context, g_value_get_ulong (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
       break;
@@ -558,6 +631,10 @@ swfdec_as_context_dispose (GObject *object)
     g_object_unref (context->debugger);
     context->debugger = NULL;
   }
+  if (context->profiler) {
+    g_object_unref (context->profiler);
+    context->profiler = NULL;
+  }
 
   G_OBJECT_CLASS (swfdec_as_context_parent_class)->dispose (object);
 }
@@ -567,6 +644,8 @@ swfdec_as_context_class_init (SwfdecAsContextClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
+  g_type_class_add_private (klass, sizeof (SwfdecAsContextPrivate));
+
   object_class->dispose = swfdec_as_context_dispose;
   object_class->get_property = swfdec_as_context_get_property;
   object_class->set_property = swfdec_as_context_set_property;
@@ -574,6 +653,9 @@ swfdec_as_context_class_init (SwfdecAsContextClass *klass)
   g_object_class_install_property (object_class, PROP_DEBUGGER,
       g_param_spec_object ("debugger", "debugger", "debugger used in this player",
 	  SWFDEC_TYPE_AS_DEBUGGER, G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+  g_object_class_install_property (object_class, PROP_PROFILER,
+      g_param_spec_object ("profiler", "profiler", "profiler collecting statistics about executed scripts",
+	  SWFDEC_TYPE_AS_PROFILER, G_PARAM_READWRITE));
   g_object_class_install_property (object_class, PROP_RANDOM_SEED,
       g_param_spec_uint ("random-seed", "random seed", 
 	  "seed used for calculating random numbers",
@@ -585,6 +667,10 @@ swfdec_as_context_class_init (SwfdecAsContextClass *klass)
       g_param_spec_ulong ("memory-until-gc", "memory until gc", 
 	  "amount of bytes that need to be allocated before garbage collection triggers",
 	  0, G_MAXULONG, 8 * 1024 * 1024, G_PARAM_READWRITE | G_PARAM_CONSTRUCT));
+  g_object_class_install_property (object_class, PROP_MAX_MEMORY,
+      g_param_spec_ulong ("max-memory", "maximum memory", 
+	  "amount of bytes scripts may use at most or 0 for no limit",
+	  0, G_MAXULONG, 0, G_PARAM_READWRITE));
 
   /**
    * SwfdecAsContext::trace:
@@ -606,6 +692,7 @@ swfdec_as_context_init (SwfdecAsContext *context)
 {
   const SwfdecAsConstantStringValue *s;
 
+  context->priv = G_TYPE_INSTANCE_GET_PRIVATE (context, SWFDEC_TYPE_AS_CONTEXT, SwfdecAsContextPrivate);
   context->version = G_MAXUINT;
 
   context->interned_strings = g_hash_table_new (g_str_hash, g_str_equal);
@@ -620,6 +707,16 @@ swfdec_as_context_init (SwfdecAsContext *context)
 
 /*** STRINGS ***/
 
+static const char *
+swfdec_as_context_add_string (SwfdecAsContext *context, SwfdecAsStringValue *new)
+{
+  g_hash_table_insert (context->interned_strings, new->string, new);
+  SWFDEC_AS_GCABLE_SET_NEXT (new, context->strings);
+  context->strings = new;
+
+  return new->string;
+}
+
 static const char *
 swfdec_as_context_create_string (SwfdecAsContext *context, const char *string, gsize len)
 {
@@ -628,11 +725,8 @@ swfdec_as_context_create_string (SwfdecAsContext *context, const char *string, g
   new = swfdec_as_gcable_alloc (context, sizeof (SwfdecAsStringValue) + len + 1);
   new->length = len;
   memcpy (new->string, string, new->length + 1);
-  g_hash_table_insert (context->interned_strings, new->string, new);
-  SWFDEC_AS_GCABLE_SET_NEXT (new, context->strings);
-  context->strings = new;
 
-  return new->string;
+  return swfdec_as_context_add_string (context, new);
 }
 
 /**
@@ -687,6 +781,105 @@ swfdec_as_context_give_string (SwfdecAsContext *context, char *string)
   return ret;
 }
 
+/* returns the interned version of new, freeing new if it already exists */
+static const char *
+swfdec_as_context_intern_string (SwfdecAsContext *context, 
+    SwfdecAsStringValue *new)
+{
+  const SwfdecAsStringValue *ret;
+
+  ret = g_hash_table_lookup (context->interned_strings, new->string);
+  if (ret) {
+    swfdec_as_gcable_free (context, new, 
+	sizeof (SwfdecAsStringValue) + new->length + 1);
+    return ret->string;
+  }
+  return swfdec_as_context_add_string (context, new);
+}
+
+/**
+ * swfdec_as_context_get_string_len:
+ * @context: a #SwfdecAsContext
+ * @string: a string that is not garbage-collected
+ * @len: number of bytes of @string to use
+ *
+ * Gets the garbage-collected version of the first @len bytes of @string, 
+ * without requiring a 0-terminated copy of them. @string must not contain a
+ * 0 byte in those @len bytes.
+ *
+ * Returns: the garbage-collected version of @string
+ **/
+const char *
+swfdec_as_context_get_string_len (SwfdecAsContext *context, const char *string,
+    gsize len)
+{
+  SwfdecAsStringValue *new;
+
+  g_return_val_if_fail (SWFDEC_IS_AS_CONTEXT (context), SWFDEC_AS_STR_EMPTY);
+  g_return_val_if_fail (string != NULL || len == 0, SWFDEC_AS_STR_EMPTY);
+
+  if (len == 0)
+    return SWFDEC_AS_STR_EMPTY;
+
+  new = swfdec_as_gcable_alloc (context, sizeof (SwfdecAsStringValue) + len + 1);
+  new->length = len;
+  /* the terminating 0 was set by the zeroed allocation */
+  memcpy (new->string, string, len);
+
+  return swfdec_as_context_intern_string (context, new);
+}
+
+/**
+ * swfdec_as_context_join_strings:
+ * @context: a #SwfdecAsContext
+ * @strings: garbage-collected strings to join
+ * @n_strings: number of strings in @strings
+ *
+ * Concatenates the given @strings. The result is built directly in the memory
+ * of the new garbage-collected string, using the lengths the strings already
+ * know, so it is only copied once. This is important for scripts that build
+ * long strings by appending to them in a loop.
+ *
+ * Returns: the garbage-collected concatenation of @strings
+ **/
+const char *
+swfdec_as_context_join_strings (SwfdecAsContext *context, const char **strings,
+    guint n_strings)
+{
+  SwfdecAsStringValue *new;
+  gsize len;
+  guint i, last;
+  char *s;
+
+  g_return_val_if_fail (SWFDEC_IS_AS_CONTEXT (context), SWFDEC_AS_STR_EMPTY);
+  g_return_val_if_fail (strings != NULL || n_strings == 0, SWFDEC_AS_STR_EMPTY);
+
+  len = 0;
+  last = 0;
+  for (i = 0; i < n_strings; i++) {
+    if (SWFDEC_AS_STR_LENGTH (strings[i]) == 0)
+      continue;
+    len += SWFDEC_AS_STR_LENGTH (strings[i]);
+    last = i;
+  }
+  /* no need to copy anything if at most one string is not empty */
+  if (len == 0)
+    return SWFDEC_AS_STR_EMPTY;
+  if (len == SWFDEC_AS_STR_LENGTH (strings[last]))
+    return strings[last];
+
+  new = swfdec_as_gcable_alloc (context, sizeof (SwfdecAsStringValue) + len + 1);
+  new->length = len;
+  s = new->string;
+  for (i = 0; i < n_strings; i++) {
+    memcpy (s, strings[i], SWFDEC_AS_STR_LENGTH (strings[i]));
+    s += SWFDEC_AS_STR_LENGTH (strings[i]);
+  }
+  /* the terminating 0 was set by the zeroed allocation */
+
+  return swfdec_as_context_intern_string (context, new);
+}
+
 /**
  * swfdec_as_context_is_constructing:
  * @context: a #SwfdecAsConstruct
@@ -812,6 +1005,8 @@ swfdec_as_context_return (SwfdecAsContext *context, SwfdecAsValue *return_value)
   g_return_if_fail (context->frame != NULL);
 
   frame = context->frame;
+  if (context->profiler)
+    swfdec_as_profiler_leave_frame (context->profiler, frame);
 
   /* save return value in case it was on the stack somewhere */
   if (frame->construct) {
@@ -895,6 +1090,7 @@ swfdec_as_context_run (SwfdecAsContext *context)
 #endif
   guint action, len;
   const guint8 *data;
+  guint64 start;
   guint original_version;
   void (* step) (SwfdecAsDebugger *debugger, SwfdecAsContext *context);
   gboolean check_block; /* some opcodes avoid a scope check */
@@ -1020,7 +1216,15 @@ swfdec_as_context_run (SwfdecAsContext *context)
     check = (spec->add >= 0 && spec->remove >= 0) ? context->cur + spec->add - spec->remove : NULL;
 #endif
     /* execute action */
-    spec->exec (context, action, data, len);
+    if (context->profiler) {
+      start = swfdec_as_profiler_now ();
+      spec->exec (context, action, data, len);
+      /* the profiler might have been unset by the action */
+      if (context->profiler)
+	swfdec_as_profiler_add_action (context->profiler, action, start);
+    } else {
+      spec->exec (context, action, data, len);
+    }
     /* adapt the pc if the action did not, otherwise, leave it alone */
     /* FIXME: do this via flag? */
     if (frame->pc == pc) {
@@ -1250,6 +1454,47 @@ swfdec_as_context_init_global (SwfdecAsContext *context)
   swfdec_as_object_set_variable (context->global, SWFDEC_AS_STR_Infinity, &val);
 }
 
+/* Init scripts are run for every context and every sandbox, so parse them 
+ * only once. The data passed in is static, so the scripts are kept around 
+ * forever. As they are reused, so are the functions they define. */
+typedef struct {
+  const guint8 *	data;		/* data the script was parsed from */
+  SwfdecScript *	script;		/* the parsed script */
+} SwfdecAsInitScript;
+
+G_LOCK_DEFINE_STATIC (init_scripts);
+static GSList *init_scripts = NULL;
+
+static SwfdecScript *
+swfdec_as_context_get_init_script (const guint8 *data, gsize length, guint version)
+{
+  SwfdecAsInitScript *init;
+  SwfdecScript *script;
+  SwfdecBits bits;
+  GSList *walk;
+
+  G_LOCK (init_scripts);
+  for (walk = init_scripts; walk; walk = walk->next) {
+    init = walk->data;
+    if (init->data == data && swfdec_script_get_version (init->script) == version) {
+      script = swfdec_script_ref (init->script);
+      G_UNLOCK (init_scripts);
+      return script;
+    }
+  }
+  swfdec_bits_init_data (&bits, data, length);
+  script = swfdec_script_new_from_bits (&bits, "init", version);
+  if (script) {
+    init = g_slice_new (SwfdecAsInitScript);
+    init->data = data;
+    init->script = swfdec_script_ref (script);
+    init_scripts = g_slist_prepend (init_scripts, init);
+  }
+  G_UNLOCK (init_scripts);
+
+  return script;
+}
+
 void
 swfdec_as_context_run_init_script (SwfdecAsContext *context, const guint8 *data, 
     gsize length, guint version)
@@ -1259,10 +1504,8 @@ swfdec_as_context_run_init_script (SwfdecAsContext *context, const guint8 *data,
   g_return_if_fail (length > 0);
 
   if (version > 4) {
-    SwfdecBits bits;
     SwfdecScript *script;
-    swfdec_bits_init_data (&bits, data, length);
-    script = swfdec_script_new_from_bits (&bits, "init", version);
+    script = swfdec_as_context_get_init_script (data, length, version);
     if (script == NULL) {
       g_warning ("script passed to swfdec_as_context_run_init_script is invalid");
       return;
@@ -33,6 +33,7 @@ typedef enum {
 } SwfdecAsContextState;
 
 typedef struct _SwfdecAsContextClass SwfdecAsContextClass;
+typedef struct _SwfdecAsContextPrivate SwfdecAsContextPrivate;
 
 #define SWFDEC_TYPE_AS_CONTEXT                    (swfdec_as_context_get_type())
 #define SWFDEC_IS_AS_CONTEXT(obj)                 (G_TYPE_CHECK_INSTANCE_TYPE ((obj), SWFDEC_TYPE_AS_CONTEXT))
@@ -79,6 +80,10 @@ struct _SwfdecAsContext {
 
   /* debugging */
   SwfdecAsDebugger *	debugger;	/* debugger (or NULL if none) */
+  SwfdecAsProfiler *	profiler;	/* profiler (or NULL if none) */
+
+  /*< private >*/
+  SwfdecAsContextPrivate *priv;
 };
 
 struct _SwfdecAsContextClass {
@@ -122,6 +127,9 @@ void		swfdec_as_context_use_mem	(SwfdecAsContext *	context,
 						 gsize			bytes);
 void		swfdec_as_context_unuse_mem   	(SwfdecAsContext *	context,
 						 gsize			bytes);
+gsize		swfdec_as_context_get_max_memory(SwfdecAsContext *	context);
+void		swfdec_as_context_set_max_memory(SwfdecAsContext *	context,
+						 gsize			bytes);
 void		swfdec_as_value_mark		(SwfdecAsValue *	value);
 void		swfdec_as_string_mark		(const char *		string);
 void		swfdec_as_context_gc		(SwfdecAsContext *	context);
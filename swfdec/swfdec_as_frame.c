@@ -26,6 +26,7 @@
 #include "swfdec_as_array.h"
 #include "swfdec_as_context.h"
 #include "swfdec_as_internal.h"
+#include "swfdec_as_profiler_internal.h"
 #include "swfdec_as_stack.h"
 #include "swfdec_as_strings.h"
 #include "swfdec_as_super.h"
@@ -325,6 +326,8 @@ swfdec_as_frame_init_native (SwfdecAsFrame *frame, SwfdecAsContext *context)
   }
   context->frame = frame;
   context->call_depth++;
+  if (context->profiler)
+    frame->profile_start = swfdec_as_profiler_now ();
 }
 
 /**
@@ -499,6 +502,7 @@ swfdec_as_frame_preload (SwfdecAsContext *context, SwfdecAsFrame *frame)
   SwfdecAsValue val;
   const SwfdecAsValue *cur;
   SwfdecAsStackIterator iter;
+  guint uses;
 
   g_return_if_fail (SWFDEC_IS_AS_CONTEXT (context));
   g_return_if_fail (frame != NULL);
@@ -510,9 +514,12 @@ swfdec_as_frame_preload (SwfdecAsContext *context, SwfdecAsFrame *frame)
   frame->activation = swfdec_as_object_new_empty (context);
   object = frame->activation;
   frame->scope_chain = g_slist_prepend (frame->scope_chain, object);
+  /* don't set variables the script can't look up */
+  uses = script->uses;
 
   /* create arguments and super object if necessary */
-  if ((script->flags & (SWFDEC_SCRIPT_PRELOAD_ARGS | SWFDEC_SCRIPT_SUPPRESS_ARGS)) != SWFDEC_SCRIPT_SUPPRESS_ARGS) {
+  if ((script->flags & SWFDEC_SCRIPT_PRELOAD_ARGS) ||
+      (!(script->flags & SWFDEC_SCRIPT_SUPPRESS_ARGS) && (uses & SWFDEC_SCRIPT_USES_ARGS))) {
     SwfdecAsFrame *next;
     args = swfdec_as_array_new (context);
     for (cur = swfdec_as_stack_iterator_init_arguments (&iter, context, frame); cur != NULL;
@@ -545,15 +552,15 @@ swfdec_as_frame_preload (SwfdecAsContext *context, SwfdecAsFrame *frame)
     args = NULL;
   }
 
-  /* set the default variables (unless suppressed */
-  if (!(script->flags & SWFDEC_SCRIPT_SUPPRESS_THIS)) {
+  /* set the default variables (unless suppressed or unused) */
+  if (!(script->flags & SWFDEC_SCRIPT_SUPPRESS_THIS) && (uses & SWFDEC_SCRIPT_USES_THIS)) {
     swfdec_as_object_set_variable (object, SWFDEC_AS_STR_this, &frame->thisp);
   }
-  if (!(script->flags & SWFDEC_SCRIPT_SUPPRESS_ARGS)) {
+  if (!(script->flags & SWFDEC_SCRIPT_SUPPRESS_ARGS) && (uses & SWFDEC_SCRIPT_USES_ARGS)) {
     SWFDEC_AS_VALUE_SET_OBJECT (&val, args);
     swfdec_as_object_set_variable (object, SWFDEC_AS_STR_arguments, &val);
   }
-  if (!(script->flags & SWFDEC_SCRIPT_SUPPRESS_SUPER)) {
+  if (!(script->flags & SWFDEC_SCRIPT_SUPPRESS_SUPER) && (uses & SWFDEC_SCRIPT_USES_SUPER)) {
     if (frame->super) {
       SWFDEC_AS_VALUE_SET_OBJECT (&val, swfdec_as_relay_get_as_object (SWFDEC_AS_RELAY (frame->super)));
     } else {
@@ -53,6 +53,10 @@ struct _SwfdecAsFrame {
   SwfdecAsValue *	stack_begin;	/* beginning of stack */
   const guint8 *	pc;		/* program counter on stack */
   /* native function */
+  /* profiling */
+  guint64		profile_start;	/* time the frame was entered or 0 if not profiled */
+  guint64		profile_children;/* time spent in frames called from this one */
+  guint			profile_node;	/* id of the profiler's stack node for this frame or 0 */
 };
 
 void		swfdec_as_frame_init		(SwfdecAsFrame *	frame,
@@ -39,6 +39,10 @@ G_BEGIN_DECLS
 /* swfdec_as_types.h */
 #define SWFDEC_AS_TYPE_IS_GCABLE(type) ((type) & 4)
 
+/* only valid for garbage-collected strings */
+#define SWFDEC_AS_STRING_VALUE(str) ((SwfdecAsStringValue *) (gpointer) ((guint8 *) (str) - G_STRUCT_OFFSET (SwfdecAsStringValue, string)))
+#define SWFDEC_AS_STR_LENGTH(str) (SWFDEC_AS_STRING_VALUE (str)->length)
+
 #define SWFDEC_AS_VALUE_IS_COMPOSITE(val) (SWFDEC_AS_VALUE_GET_TYPE (val) >= SWFDEC_AS_TYPE_OBJECT)
 #define SWFDEC_AS_VALUE_IS_PRIMITIVE(val) (!SWFDEC_AS_VALUE_IS_COMPOSITE(val))
 /* FIXME: ugly macro */
@@ -66,6 +70,27 @@ G_BEGIN_DECLS
 } G_STMT_END
 
 /* swfdec_as_context.c */
+#define SWFDEC_AS_CONTEXT_STRING_CURSOR_BUCKETS 16
+#define SWFDEC_AS_CONTEXT_STRING_CURSOR_WAYS 4
+#define SWFDEC_AS_CONTEXT_INTEGER_STRINGS 256
+
+typedef struct {
+  const char *		string;		/* string this cursor is used for or NULL */
+  gsize			n_chars;	/* length of string in characters */
+  gsize			chars;		/* character offset last looked up in string */
+  gsize			bytes;		/* byte offset of that character */
+} SwfdecAsStringCursor;
+
+struct _SwfdecAsContextPrivate {
+  gsize			max_memory;	/* maximum amount of memory scripts may use or 0 for no limit */
+  SwfdecAsStringCursor	cursors[SWFDEC_AS_CONTEXT_STRING_CURSOR_BUCKETS][SWFDEC_AS_CONTEXT_STRING_CURSOR_WAYS]; /* strings recently indexed by characters, most recently used first per bucket */
+  int			integer_values[SWFDEC_AS_CONTEXT_INTEGER_STRINGS]; /* integers recently converted to strings */
+  const char *		integer_strings[SWFDEC_AS_CONTEXT_INTEGER_STRINGS]; /* string for integer_values or NULL */
+};
+
+#define SWFDEC_AS_CONTEXT_STRING_CURSOR_BUCKET(context,str) \
+  ((context)->priv->cursors[(GPOINTER_TO_SIZE (str) / 8) % SWFDEC_AS_CONTEXT_STRING_CURSOR_BUCKETS])
+
 gboolean	swfdec_as_context_check_continue (SwfdecAsContext *	context);
 void		swfdec_as_context_return	(SwfdecAsContext *	context,
 						 SwfdecAsValue *	return_value);
@@ -77,6 +102,12 @@ void		swfdec_as_context_run_init_script (SwfdecAsContext *	context,
 void		swfdec_as_context_gc_alloc	(SwfdecAsContext *	context,
 						 gsize			size);
 #define swfdec_as_context_gc_new(context,type) ((type *)swfdec_as_context_gc_alloc ((context), sizeof (type)))
+const char *	swfdec_as_context_join_strings	(SwfdecAsContext *	context,
+						 const char **		strings,
+						 guint			n_strings);
+const char *	swfdec_as_context_get_string_len(SwfdecAsContext *	context,
+						 const char *		string,
+						 gsize			len);
 
 /* swfdec_as_object.c */
 typedef SwfdecAsVariableForeach SwfdecAsVariableForeachRemove;
@@ -110,6 +141,11 @@ SwfdecAsFunction *
 						 const char *		name,
 						 SwfdecAsNative		native);
 
+/* swfdec_asbroadcaster.c */
+void		swfdec_as_broadcaster_broadcast	(SwfdecAsObject *	object,
+						 guint			argc,
+						 SwfdecAsValue *	argv);
+
 /* swfdec_as_array.h */
 void		swfdec_as_array_remove_range	(SwfdecAsObject *	object,
 						 gint32			start_index,
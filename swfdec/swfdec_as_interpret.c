@@ -74,10 +74,12 @@ static void
 swfdec_action_play (SwfdecAsContext *cx, guint action, const guint8 *data, guint len)
 {
   SwfdecMovie *target = swfdec_as_frame_get_target (cx->frame);
-  if (SWFDEC_IS_SPRITE_MOVIE(target))
+  if (SWFDEC_IS_SPRITE_MOVIE(target)) {
     SWFDEC_SPRITE_MOVIE (target)->playing = TRUE;
-  else
+    swfdec_actor_activate (SWFDEC_ACTOR (target));
+  } else {
     SWFDEC_ERROR ("no movie to play");
+  }
 }
 
 static void
@@ -217,6 +219,8 @@ swfdec_action_goto_frame2 (SwfdecAsContext *cx, guint action, const guint8 *data
       frame = CLAMP (frame, 1, movie->n_frames);
       swfdec_sprite_movie_goto (movie, frame);
       movie->playing = play;
+      if (play)
+	swfdec_actor_activate (SWFDEC_ACTOR (movie));
     }
   } else {
     SWFDEC_ERROR ("no movie to GotoFrame2 on");
@@ -988,10 +992,11 @@ swfdec_action_add2 (SwfdecAsContext *cx, guint action, const guint8 *data, guint
     lval = &ltmp;
 
   if (SWFDEC_AS_VALUE_IS_STRING (*lval) || SWFDEC_AS_VALUE_IS_STRING (*rval)) {
-    const char *lstr, *rstr;
-    lstr = swfdec_as_value_to_string (cx, *lval);
-    rstr = swfdec_as_value_to_string (cx, *rval);
-    lstr = swfdec_as_str_concat (cx, lstr, rstr);
+    const char *strings[2];
+    const char *lstr;
+    strings[0] = swfdec_as_value_to_string (cx, *lval);
+    strings[1] = swfdec_as_value_to_string (cx, *rval);
+    lstr = swfdec_as_context_join_strings (cx, strings, 2);
     swfdec_as_stack_pop (cx);
     SWFDEC_AS_VALUE_SET_STRING (swfdec_as_stack_peek (cx, 1), lstr);
   } else {
@@ -1281,11 +1286,12 @@ swfdec_action_get_url2 (SwfdecAsContext *cx, guint action, const guint8 *data, g
 static void
 swfdec_action_string_add (SwfdecAsContext *cx, guint action, const guint8 *data, guint len)
 {
-  const char *lval, *rval;
+  const char *strings[2];
+  const char *lval;
 
-  rval = swfdec_as_value_to_string (cx, *swfdec_as_stack_peek (cx, 1));
-  lval = swfdec_as_value_to_string (cx, *swfdec_as_stack_peek (cx, 2));
-  lval = swfdec_as_str_concat (cx, lval, rval);
+  strings[1] = swfdec_as_value_to_string (cx, *swfdec_as_stack_peek (cx, 1));
+  strings[0] = swfdec_as_value_to_string (cx, *swfdec_as_stack_peek (cx, 2));
+  lval = swfdec_as_context_join_strings (cx, strings, 2);
   SWFDEC_AS_VALUE_SET_STRING (swfdec_as_stack_peek (cx, 2), lval);
   swfdec_as_stack_pop (cx);
 }
@@ -1350,7 +1356,7 @@ swfdec_action_string_extract (SwfdecAsContext *cx, guint action, const guint8 *d
   start = swfdec_as_value_to_integer (cx, *swfdec_as_stack_peek (cx, 2));
   s = swfdec_as_value_to_string (cx, *swfdec_as_stack_peek (cx, 3));
   swfdec_as_stack_pop_n (cx, 2);
-  left = g_utf8_strlen (s, -1);
+  left = swfdec_as_str_length (cx, s);
   if (start > left) {
     SWFDEC_AS_VALUE_SET_STRING (swfdec_as_stack_peek (cx, 1), SWFDEC_AS_STR_EMPTY);
     return;
@@ -1375,7 +1381,7 @@ swfdec_action_string_length (SwfdecAsContext *cx, guint action, const guint8 *da
 
   v = swfdec_as_stack_peek (cx, 1);
   s = swfdec_as_value_to_string (cx, *v);
-  *v = swfdec_as_value_from_integer (cx, g_utf8_strlen (s, -1));  
+  *v = swfdec_as_value_from_integer (cx, swfdec_as_str_length (cx, s));  
 }
 
 static void
@@ -1822,11 +1828,11 @@ static void
 swfdec_action_define_function (SwfdecAsContext *cx, guint action,
     const guint8 *data, guint len)
 {
-  char *function_name;
+  char *function_name, *script_name;
   const char *name = NULL;
   guint i, n_args, size, n_registers;
   SwfdecBits bits;
-  SwfdecBuffer *buffer;
+  SwfdecBuffer *buffer, *pool;
   SwfdecAsFunction *fun;
   SwfdecAsFrame *frame;
   SwfdecScript *script;
@@ -1881,38 +1887,49 @@ swfdec_action_define_function (SwfdecAsContext *cx, guint action,
     g_free (function_name);
     return;
   }
+  pool = frame->constant_pool ? swfdec_constant_pool_get_buffer (frame->constant_pool) : NULL;
+  script = swfdec_script_lookup_function (frame->script, frame->pc, pool, cx->version);
+  if (script) {
+    /* this function was defined before, reuse its script */
+    for (i = 0; i < n_args; i++) {
+      g_free (args[i].name);
+    }
+    g_free (args);
+    goto create;
+  }
   /* create the script */
   buffer = swfdec_buffer_new_subbuffer (frame->script->buffer, 
       frame->pc + 3 + len - frame->script->buffer->data, size);
   swfdec_bits_init (&bits, buffer);
+  /* The script is shared by every later definition of this function, so 
+   * anonymous functions are named after their position in the defining script
+   * and not after what they happen to be assigned to the first time. */
   if (*function_name) {
-    name = function_name;
-  } else if (swfdec_as_stack_get_size (cx) > 0) {
-    /* This is kind of a hack that uses a feature of the Adobe compiler:
-     * foo = function () {} is compiled as these actions:
-     * Push "foo", DefineFunction, SetVariable/SetMember
-     * With this knowledge we can inspect the topmost stack member, since
-     * it will contain the name this function will soon be assigned to.
-     */
-    if (SWFDEC_AS_VALUE_IS_STRING (*swfdec_as_stack_peek (cx, 1)))
-      name = SWFDEC_AS_VALUE_GET_STRING (*swfdec_as_stack_peek (cx, 1));
-  }
-  if (name == NULL)
-    name = "unnamed_function";
-  script = swfdec_script_new_from_bits (&bits, name, cx->version);
+    script_name = g_strdup (function_name);
+  } else {
+    script_name = g_strdup_printf ("%s:%u", frame->script->name,
+	(guint) (frame->pc - frame->script->buffer->data));
+  }
+  script = swfdec_script_new_from_bits (&bits, script_name, cx->version);
   swfdec_buffer_unref (buffer);
+  g_free (script_name);
   if (script == NULL) {
     SWFDEC_ERROR ("failed to create script");
     g_free (args);
     g_free (function_name);
     return;
   }
-  if (frame->constant_pool)
-    script->constant_pool = swfdec_buffer_ref (swfdec_constant_pool_get_buffer (frame->constant_pool));
+  if (pool) {
+    script->constant_pool = swfdec_buffer_ref (pool);
+    swfdec_script_analyze (script);
+  }
   script->flags = flags;
   script->n_registers = n_registers;
   script->n_arguments = n_args;
   script->arguments = args;
+  swfdec_script_add_function (frame->script, frame->pc, script);
+
+create:
   /* see function-scope tests */
   if (cx->version > 5) {
     /* FIXME: or original target? */
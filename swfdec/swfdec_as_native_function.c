@@ -52,6 +52,41 @@
 
 G_DEFINE_TYPE (SwfdecAsNativeFunction, swfdec_as_native_function, SWFDEC_TYPE_AS_FUNCTION)
 
+/* number of arguments that fit into the buffer on the C stack */
+#define SWFDEC_AS_NATIVE_LOCAL_ARGS 32
+
+static void
+swfdec_as_native_function_reverse (SwfdecAsValue *values, guint n)
+{
+  SwfdecAsValue tmp, *end;
+
+  for (end = values + n - 1; values < end; values++, end--) {
+    tmp = *values;
+    *values = *end;
+    *end = tmp;
+  }
+}
+
+/* copies the n topmost values on the stack into argv in reverse order */
+static void
+swfdec_as_native_function_copy_args (SwfdecAsContext *cx, SwfdecAsValue *argv, guint n)
+{
+  SwfdecAsStack *stack;
+  SwfdecAsValue *cur;
+  guint i;
+
+  stack = cx->stack;
+  cur = cx->cur;
+  for (i = 0; i < n; i++) {
+    if (cur <= &stack->elements[0]) {
+      stack = stack->next;
+      cur = &stack->elements[stack->used_elements];
+    }
+    cur--;
+    argv[i] = *cur;
+  }
+}
+
 static void
 swfdec_as_native_function_call (SwfdecAsFunction *function, SwfdecAsObject *thisp, 
     gboolean construct, SwfdecAsObject *super_reference, guint n_args, 
@@ -61,7 +96,8 @@ swfdec_as_native_function_call (SwfdecAsFunction *function, SwfdecAsObject *this
   SwfdecAsContext *cx = swfdec_gc_object_get_context (function);
   SwfdecAsFrame frame = { NULL, };
   SwfdecAsValue rval = { 0, };
-  SwfdecAsValue *argv;
+  SwfdecAsValue *argv, *allocated = NULL;
+  SwfdecAsValue local[SWFDEC_AS_NATIVE_LOCAL_ARGS];
 
   g_assert (native->name);
 
@@ -89,30 +125,26 @@ swfdec_as_native_function_call (SwfdecAsFunction *function, SwfdecAsObject *this
   if (frame.argc == 0 || frame.argv != NULL) {
     /* FIXME FIXME FIXME: no casting here please! */
     argv = (SwfdecAsValue *) frame.argv;
+  } else if (frame.stack_begin - &cx->stack->elements[0] >= (gssize) frame.argc) {
+    /* The arguments are on the stack in reverse order, so reverse them in 
+     * place. They get popped when returning anyway. */
+    swfdec_as_native_function_reverse (frame.stack_begin - frame.argc, frame.argc);
+    argv = frame.stack_begin - frame.argc;
+    frame.argv = argv;
   } else {
-    SwfdecAsStack *stack;
-    SwfdecAsValue *cur;
-    guint i;
-    if (frame.argc > 128) {
-      SWFDEC_FIXME ("allow calling native functions with more than 128 args (this one has %u)",
-	  frame.argc);
-      frame.argc = 128;
-    }
-    argv = g_new (SwfdecAsValue, frame.argc);
-    stack = cx->stack;
-    cur = cx->cur;
-    for (i = 0; i < frame.argc; i++) {
-      if (cur <= &stack->elements[0]) {
-	stack = stack->next;
-	cur = &stack->elements[stack->used_elements];
-      }
-      cur--;
-      argv[i] = *cur;
-    }
+    /* The arguments straddle stack segments, which is rare. They stay on the
+     * stack until we return, so the copy doesn't need to be marked. */
+    if (frame.argc <= SWFDEC_AS_NATIVE_LOCAL_ARGS)
+      argv = local;
+    else
+      argv = allocated = g_new (SwfdecAsValue, frame.argc);
+    swfdec_as_native_function_copy_args (cx, argv, frame.argc);
+    frame.argv = argv;
   }
   native->native (cx, thisp, frame.argc, argv, &rval);
-  if (argv != frame.argv)
-    g_free (argv);
+  /* make swfdec_as_context_return() pop the arguments from the stack */
+  frame.argv = args;
+  g_free (allocated);
   swfdec_as_context_return (cx, &rval);
 }
 
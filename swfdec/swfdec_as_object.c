@@ -38,6 +38,7 @@
 #include "swfdec_as_super.h"
 #include "swfdec_debug.h"
 #include "swfdec_movie.h"
+#include "swfdec_player_internal.h"
 #include "swfdec_resource.h"
 #include "swfdec_utils.h"
 
@@ -278,6 +279,19 @@ swfdec_as_object_hash_lookup (SwfdecAsObject *object, const char *variable)
   return var;
 }
 
+/* checks if variable may be looked up when executing onEnterFrame events */
+static gboolean
+swfdec_as_object_is_enter_frame_name (SwfdecAsContext *context, const char *variable)
+{
+  if (variable == SWFDEC_AS_STR_onEnterFrame ||
+      variable == SWFDEC_AS_STR___resolve)
+    return TRUE;
+  if (context->version >= 7)
+    return FALSE;
+  return g_ascii_strcasecmp (variable, SWFDEC_AS_STR_onEnterFrame) == 0 ||
+    g_ascii_strcasecmp (variable, SWFDEC_AS_STR___resolve) == 0;
+}
+
 static SwfdecAsVariable *
 swfdec_as_object_hash_create (SwfdecAsObject *object, const char *variable, guint flags)
 {
@@ -289,6 +303,12 @@ swfdec_as_object_hash_create (SwfdecAsObject *object, const char *variable, guin
   var = g_slice_new0 (SwfdecAsVariable);
   var->flags = flags;
   g_hash_table_insert (object->properties, (gpointer) variable, var);
+  /* movies without onEnterFrame handlers don't need to be iterated, 
+   * once a player has them, names don't need to be compared anymore */
+  if (SWFDEC_IS_PLAYER (object->context) &&
+      !SWFDEC_PLAYER (object->context)->priv->enter_frame_handlers &&
+      swfdec_as_object_is_enter_frame_name (object->context, variable))
+    swfdec_player_use_enter_frame_handlers (SWFDEC_PLAYER (object->context));
 
   return var;
 }
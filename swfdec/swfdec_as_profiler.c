@@ -0,0 +1,402 @@
+/* Swfdec
+ * Copyright (C) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, 
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "swfdec_as_profiler_internal.h"
+#include "swfdec_as_frame_internal.h"
+#include "swfdec_as_interpret.h"
+#include "swfdec_as_native_function.h"
+
+G_DEFINE_TYPE (SwfdecAsProfiler, swfdec_as_profiler, G_TYPE_OBJECT)
+
+/**
+ * SECTION:SwfdecAsProfiler
+ * @title: SwfdecAsProfiler
+ * @short_description: measuring where script execution time goes
+ * @see also: SwfdecAsContext
+ *
+ * The profiler collects statistics about the scripts executed by a 
+ * #SwfdecAsContext. It counts how often every action, every script and every
+ * native function is executed and how much time is spent inside them. It is
+ * much cheaper than a #SwfdecAsDebugger and can therefore be used while 
+ * playing normally. Set it on a context using the #SwfdecAsContext:profiler 
+ * property.
+ *
+ * All times are in nanoseconds. The time for scripts and native functions 
+ * includes the time spent in functions called by them. The time for actions
+ * includes the time spent in native functions they call.
+ */
+
+/**
+ * SwfdecAsProfiler:
+ *
+ * This is the type of the profiler object.
+ */
+
+/**
+ * SwfdecAsProfilerFunc:
+ * @name: name of the action, script or native function
+ * @calls: number of times it was executed
+ * @time: time in nanoseconds spent executing it
+ * @data: the data passed to the foreach function
+ *
+ * Function called for every entry when iterating the profiler's statistics.
+ */
+
+typedef struct {
+  guint64		calls;		/* number of times this was executed */
+  guint64		time;		/* time spent in nanoseconds */
+} SwfdecAsProfilerEntry;
+
+/* Every distinct call stack gets a node. Frames remember the id of their node,
+ * so the node of a called frame is found with one lookup in its caller's 
+ * node and stacks never need to be compared or built while profiling. */
+typedef struct {
+  guint			parent;		/* id of the calling stack or 0 for the outermost frame */
+  char *		name;		/* name of the innermost frame, escaped for the folded format */
+  GHashTable *		children;	/* name => id of the stacks called from here or NULL */
+  guint64		calls;		/* number of times this stack was executed */
+  guint64		time;		/* time spent in the innermost frame in nanoseconds */
+} SwfdecAsProfilerNode;
+
+#define SWFDEC_AS_PROFILER_NODE(profiler,id) (&g_array_index ((profiler)->nodes, SwfdecAsProfilerNode, (id)))
+
+static void
+swfdec_as_profiler_dispose (GObject *object)
+{
+  SwfdecAsProfiler *profiler = SWFDEC_AS_PROFILER (object);
+
+  if (profiler->scripts) {
+    guint i;
+    g_hash_table_destroy (profiler->scripts);
+    g_hash_table_destroy (profiler->natives);
+    for (i = 0; i < profiler->nodes->len; i++) {
+      SwfdecAsProfilerNode *node = SWFDEC_AS_PROFILER_NODE (profiler, i);
+      g_free (node->name);
+      if (node->children)
+	g_hash_table_destroy (node->children);
+    }
+    g_array_free (profiler->nodes, TRUE);
+    profiler->scripts = NULL;
+  }
+
+  G_OBJECT_CLASS (swfdec_as_profiler_parent_class)->dispose (object);
+}
+
+static void
+swfdec_as_profiler_class_init (SwfdecAsProfilerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = swfdec_as_profiler_dispose;
+}
+
+static GHashTable *
+swfdec_as_profiler_table_new (void)
+{
+  return g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+}
+
+static void
+swfdec_as_profiler_init (SwfdecAsProfiler *profiler)
+{
+  profiler->scripts = swfdec_as_profiler_table_new ();
+  profiler->natives = swfdec_as_profiler_table_new ();
+  profiler->nodes = g_array_new (FALSE, TRUE, sizeof (SwfdecAsProfilerNode));
+  /* id 0 is the empty stack all outermost frames are called from */
+  g_array_set_size (profiler->nodes, 1);
+}
+
+/**
+ * swfdec_as_profiler_new:
+ *
+ * Creates a new profiler without any statistics.
+ *
+ * Returns: a new #SwfdecAsProfiler
+ **/
+SwfdecAsProfiler *
+swfdec_as_profiler_new (void)
+{
+  return g_object_new (SWFDEC_TYPE_AS_PROFILER, NULL);
+}
+
+/**
+ * swfdec_as_profiler_reset:
+ * @profiler: a #SwfdecAsProfiler
+ *
+ * Clears all statistics collected so far.
+ **/
+void
+swfdec_as_profiler_reset (SwfdecAsProfiler *profiler)
+{
+  guint i;
+
+  g_return_if_fail (SWFDEC_IS_AS_PROFILER (profiler));
+
+  memset (profiler->action_calls, 0, sizeof (profiler->action_calls));
+  memset (profiler->action_time, 0, sizeof (profiler->action_time));
+  g_hash_table_remove_all (profiler->scripts);
+  g_hash_table_remove_all (profiler->natives);
+  /* running frames still refer to the nodes, so keep them */
+  for (i = 0; i < profiler->nodes->len; i++) {
+    SwfdecAsProfilerNode *node = SWFDEC_AS_PROFILER_NODE (profiler, i);
+    node->calls = 0;
+    node->time = 0;
+  }
+}
+
+/*** COLLECTING ***/
+
+void
+swfdec_as_profiler_add_action (SwfdecAsProfiler *profiler, guint action, guint64 start)
+{
+  profiler->action_calls[action]++;
+  profiler->action_time[action] += swfdec_as_profiler_now () - start;
+}
+
+static void
+swfdec_as_profiler_add (GHashTable *table, const char *name, guint64 calls, guint64 time)
+{
+  SwfdecAsProfilerEntry *entry;
+  
+  entry = g_hash_table_lookup (table, name);
+  if (entry == NULL) {
+    entry = g_new0 (SwfdecAsProfilerEntry, 1);
+    g_hash_table_insert (table, g_strdup (name), entry);
+  }
+  entry->calls += calls;
+  entry->time += time;
+}
+
+static const char *
+swfdec_as_profiler_frame_name (SwfdecAsFrame *frame)
+{
+  if (frame->script) {
+    return frame->script->name;
+  } else if (SWFDEC_IS_AS_NATIVE_FUNCTION (frame->function)) {
+    return SWFDEC_AS_NATIVE_FUNCTION (frame->function)->name;
+  } else {
+    return "(unknown)";
+  }
+}
+
+/* returns the id of the stack node for frame, creating it if necessary */
+static guint
+swfdec_as_profiler_get_node (SwfdecAsProfiler *profiler, SwfdecAsFrame *frame)
+{
+  SwfdecAsProfilerNode *parent, *node;
+  const char *name;
+  gpointer id;
+  guint parent_id;
+  char *s;
+
+  if (frame->profile_node)
+    return frame->profile_node;
+
+  parent_id = frame->next ? swfdec_as_profiler_get_node (profiler, frame->next) : 0;
+  parent = SWFDEC_AS_PROFILER_NODE (profiler, parent_id);
+  name = swfdec_as_profiler_frame_name (frame);
+  if (parent->children == NULL)
+    parent->children = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  if (!g_hash_table_lookup_extended (parent->children, name, NULL, &id)) {
+    id = GUINT_TO_POINTER (profiler->nodes->len);
+    g_array_set_size (profiler->nodes, profiler->nodes->len + 1);
+    /* parent might have moved */
+    parent = SWFDEC_AS_PROFILER_NODE (profiler, parent_id);
+    node = SWFDEC_AS_PROFILER_NODE (profiler, GPOINTER_TO_UINT (id));
+    node->parent = parent_id;
+    node->name = g_strdup (name);
+    /* ';' separates frames and the last space separates the count */
+    for (s = node->name; *s; s++) {
+      if (*s == ';')
+	*s = ':';
+      else if (*s == '\n')
+	*s = ' ';
+    }
+    /* the node's name is escaped, so key the children on the original one */
+    g_hash_table_insert (parent->children, g_strdup (name), id);
+  }
+  frame->profile_node = GPOINTER_TO_UINT (id);
+  return frame->profile_node;
+}
+
+void
+swfdec_as_profiler_leave_frame (SwfdecAsProfiler *profiler, SwfdecAsFrame *frame)
+{
+  SwfdecAsProfilerNode *node;
+  guint64 total, self;
+
+  /* frame was entered before profiling started */
+  if (frame->profile_start == 0)
+    return;
+
+  total = swfdec_as_profiler_now () - frame->profile_start;
+  self = total > frame->profile_children ? total - frame->profile_children : 0;
+  if (frame->next)
+    frame->next->profile_children += total;
+
+  if (frame->script) {
+    swfdec_as_profiler_add (profiler->scripts, frame->script->name, 1, total);
+  } else if (SWFDEC_IS_AS_NATIVE_FUNCTION (frame->function)) {
+    swfdec_as_profiler_add (profiler->natives, 
+	SWFDEC_AS_NATIVE_FUNCTION (frame->function)->name, 1, total);
+  }
+
+  node = SWFDEC_AS_PROFILER_NODE (profiler, 
+      swfdec_as_profiler_get_node (profiler, frame));
+  node->calls++;
+  node->time += self;
+}
+
+/*** QUERYING ***/
+
+/**
+ * swfdec_as_profiler_foreach_action:
+ * @profiler: a #SwfdecAsProfiler
+ * @func: function to call for every action
+ * @data: data to pass to @func
+ *
+ * Calls @func for every action that was executed at least once.
+ **/
+void
+swfdec_as_profiler_foreach_action (SwfdecAsProfiler *profiler,
+    SwfdecAsProfilerFunc func, gpointer data)
+{
+  guint i;
+
+  g_return_if_fail (SWFDEC_IS_AS_PROFILER (profiler));
+  g_return_if_fail (func != NULL);
+
+  for (i = 0; i < 256; i++) {
+    char name[8];
+
+    if (profiler->action_calls[i] == 0)
+      continue;
+    if (swfdec_as_actions[i].name == NULL)
+      g_snprintf (name, sizeof (name), "0x%02X", i);
+    func (swfdec_as_actions[i].name ? swfdec_as_actions[i].name : name,
+	profiler->action_calls[i], profiler->action_time[i], data);
+  }
+}
+
+typedef struct {
+  SwfdecAsProfilerFunc	func;
+  gpointer		data;
+} SwfdecAsProfilerForeach;
+
+static void
+swfdec_as_profiler_do_foreach (gpointer key, gpointer value, gpointer data)
+{
+  SwfdecAsProfilerForeach *fdata = data;
+  SwfdecAsProfilerEntry *entry = value;
+
+  fdata->func (key, entry->calls, entry->time, fdata->data);
+}
+
+/**
+ * swfdec_as_profiler_foreach_script:
+ * @profiler: a #SwfdecAsProfiler
+ * @func: function to call for every script
+ * @data: data to pass to @func
+ *
+ * Calls @func for every script that was executed. Scripts with the same name
+ * are accumulated.
+ **/
+void
+swfdec_as_profiler_foreach_script (SwfdecAsProfiler *profiler,
+    SwfdecAsProfilerFunc func, gpointer data)
+{
+  SwfdecAsProfilerForeach fdata = { func, data };
+
+  g_return_if_fail (SWFDEC_IS_AS_PROFILER (profiler));
+  g_return_if_fail (func != NULL);
+
+  g_hash_table_foreach (profiler->scripts, swfdec_as_profiler_do_foreach, &fdata);
+}
+
+/**
+ * swfdec_as_profiler_foreach_native:
+ * @profiler: a #SwfdecAsProfiler
+ * @func: function to call for every native function
+ * @data: data to pass to @func
+ *
+ * Calls @func for every native function that was called. Native functions
+ * with the same name are accumulated.
+ **/
+void
+swfdec_as_profiler_foreach_native (SwfdecAsProfiler *profiler,
+    SwfdecAsProfilerFunc func, gpointer data)
+{
+  SwfdecAsProfilerForeach fdata = { func, data };
+
+  g_return_if_fail (SWFDEC_IS_AS_PROFILER (profiler));
+  g_return_if_fail (func != NULL);
+
+  g_hash_table_foreach (profiler->natives, swfdec_as_profiler_do_foreach, &fdata);
+}
+
+/* builds the stack from the outermost frame in the same format as Brendan 
+ * Gregg's stackcollapse scripts so it can be fed to flamegraph.pl */
+static void
+swfdec_as_profiler_append_stack (SwfdecAsProfiler *profiler, GString *string,
+    guint id)
+{
+  SwfdecAsProfilerNode *node = SWFDEC_AS_PROFILER_NODE (profiler, id);
+
+  if (node->parent) {
+    swfdec_as_profiler_append_stack (profiler, string, node->parent);
+    g_string_append_c (string, ';');
+  }
+  g_string_append (string, node->name);
+}
+
+/**
+ * swfdec_as_profiler_get_folded_stacks:
+ * @profiler: a #SwfdecAsProfiler
+ *
+ * Gets the time spent in every call stack in the "folded" format used by
+ * flame graph tools: One line per stack, with the frames separated by 
+ * semicolons, outermost frame first, followed by a space and the time in
+ * microseconds spent in the innermost frame.
+ *
+ * Returns: a newly allocated string. Use g_free() to free it.
+ **/
+char *
+swfdec_as_profiler_get_folded_stacks (SwfdecAsProfiler *profiler)
+{
+  GString *string;
+  guint i;
+
+  g_return_val_if_fail (SWFDEC_IS_AS_PROFILER (profiler), NULL);
+
+  string = g_string_new ("");
+  for (i = 1; i < profiler->nodes->len; i++) {
+    SwfdecAsProfilerNode *node = SWFDEC_AS_PROFILER_NODE (profiler, i);
+    if (node->calls == 0)
+      continue;
+    swfdec_as_profiler_append_stack (profiler, string, i);
+    g_string_append_printf (string, " %"G_GUINT64_FORMAT"\n", node->time / 1000);
+  }
+  return g_string_free (string, FALSE);
+}
@@ -0,0 +1,72 @@
+/* Swfdec
+ * Copyright (C) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, 
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifndef _SWFDEC_AS_PROFILER_H_
+#define _SWFDEC_AS_PROFILER_H_
+
+#include <swfdec/swfdec_as_types.h>
+
+G_BEGIN_DECLS
+
+typedef struct _SwfdecAsProfilerClass SwfdecAsProfilerClass;
+
+typedef void (* SwfdecAsProfilerFunc) (const char *name, guint64 calls, guint64 time, gpointer data);
+
+#define SWFDEC_TYPE_AS_PROFILER                    (swfdec_as_profiler_get_type())
+#define SWFDEC_IS_AS_PROFILER(obj)                 (G_TYPE_CHECK_INSTANCE_TYPE ((obj), SWFDEC_TYPE_AS_PROFILER))
+#define SWFDEC_IS_AS_PROFILER_CLASS(klass)         (G_TYPE_CHECK_CLASS_TYPE ((klass), SWFDEC_TYPE_AS_PROFILER))
+#define SWFDEC_AS_PROFILER(obj)                    (G_TYPE_CHECK_INSTANCE_CAST ((obj), SWFDEC_TYPE_AS_PROFILER, SwfdecAsProfiler))
+#define SWFDEC_AS_PROFILER_CLASS(klass)            (G_TYPE_CHECK_CLASS_CAST ((klass), SWFDEC_TYPE_AS_PROFILER, SwfdecAsProfilerClass))
+#define SWFDEC_AS_PROFILER_GET_CLASS(obj)          (G_TYPE_INSTANCE_GET_CLASS ((obj), SWFDEC_TYPE_AS_PROFILER, SwfdecAsProfilerClass))
+
+struct _SwfdecAsProfiler {
+  /*< private >*/
+  GObject		object;
+
+  guint64		action_calls[256];	/* number of times each action was executed */
+  guint64		action_time[256];	/* time spent executing each action */
+  GHashTable *		scripts;		/* script name => SwfdecAsProfilerEntry */
+  GHashTable *		natives;		/* native function name => SwfdecAsProfilerEntry */
+  GArray *		nodes;			/* stack node id => SwfdecAsProfilerNode */
+};
+struct _SwfdecAsProfilerClass {
+  /*< private >*/
+  GObjectClass		object_class;
+};
+
+GType		swfdec_as_profiler_get_type		(void);
+
+SwfdecAsProfiler *
+		swfdec_as_profiler_new			(void);
+void		swfdec_as_profiler_reset		(SwfdecAsProfiler *	profiler);
+
+void		swfdec_as_profiler_foreach_action	(SwfdecAsProfiler *	profiler,
+							 SwfdecAsProfilerFunc	func,
+							 gpointer		data);
+void		swfdec_as_profiler_foreach_script	(SwfdecAsProfiler *	profiler,
+							 SwfdecAsProfilerFunc	func,
+							 gpointer		data);
+void		swfdec_as_profiler_foreach_native	(SwfdecAsProfiler *	profiler,
+							 SwfdecAsProfilerFunc	func,
+							 gpointer		data);
+char *		swfdec_as_profiler_get_folded_stacks	(SwfdecAsProfiler *	profiler);
+
+
+G_END_DECLS
+#endif
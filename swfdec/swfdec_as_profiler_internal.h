@@ -0,0 +1,55 @@
+/* Swfdec
+ * Copyright (C) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, 
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifndef _SWFDEC_AS_PROFILER_INTERNAL_H_
+#define _SWFDEC_AS_PROFILER_INTERNAL_H_
+
+#ifdef HAVE_CLOCK_GETTIME
+#include <time.h>
+#endif
+#include <swfdec/swfdec_as_profiler.h>
+
+G_BEGIN_DECLS
+
+/* returns a timestamp in nanoseconds */
+static inline guint64
+swfdec_as_profiler_now (void)
+{
+#ifdef HAVE_CLOCK_GETTIME
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (guint64) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+  GTimeVal tv;
+
+  g_get_current_time (&tv);
+  return (guint64) tv.tv_sec * 1000000000 + (guint64) tv.tv_usec * 1000;
+#endif
+}
+
+void		swfdec_as_profiler_add_action		(SwfdecAsProfiler *	profiler,
+							 guint			action,
+							 guint64		start);
+void		swfdec_as_profiler_leave_frame		(SwfdecAsProfiler *	profiler,
+							 SwfdecAsFrame *	frame);
+
+
+G_END_DECLS
+#endif
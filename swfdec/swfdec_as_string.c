@@ -58,6 +58,109 @@ swfdec_as_string_init (SwfdecAsString *string)
   string->string = SWFDEC_AS_STR_EMPTY;
 }
 
+/*** CHARACTER OFFSETS ***/
+
+/* Strings are stored as UTF-8, so finding a character usually means walking 
+ * the string from the start. To avoid this, the context keeps cursors for
+ * strings that were recently indexed by characters. A cursor knows the 
+ * length of its string in characters, which makes offsets into ASCII strings
+ * trivial, and the last offset that was looked up, so scripts walking other
+ * strings character by character stay linear.
+ * Cursors are kept in buckets of a few cursors each, so scripts alternating
+ * between strings that end up in the same bucket don't need to count the 
+ * characters again every time. Each bucket evicts its least recently used 
+ * cursor.
+ * All functions here only work with garbage-collected strings.
+ */
+
+static SwfdecAsStringCursor *
+swfdec_as_str_get_cursor (SwfdecAsContext *cx, const char *str)
+{
+  SwfdecAsStringCursor *bucket, cursor;
+  guint i;
+
+  bucket = SWFDEC_AS_CONTEXT_STRING_CURSOR_BUCKET (cx, str);
+  if (bucket[0].string == str)
+    return &bucket[0];
+
+  for (i = 1; i < SWFDEC_AS_CONTEXT_STRING_CURSOR_WAYS; i++) {
+    if (bucket[i].string == str)
+      break;
+  }
+  if (i < SWFDEC_AS_CONTEXT_STRING_CURSOR_WAYS) {
+    cursor = bucket[i];
+  } else {
+    i = SWFDEC_AS_CONTEXT_STRING_CURSOR_WAYS - 1;
+    cursor.string = str;
+    cursor.n_chars = g_utf8_strlen (str, SWFDEC_AS_STR_LENGTH (str));
+    cursor.chars = 0;
+    cursor.bytes = 0;
+  }
+  /* move the cursor to the front of the bucket */
+  memmove (&bucket[1], &bucket[0], i * sizeof (SwfdecAsStringCursor));
+  bucket[0] = cursor;
+  return &bucket[0];
+}
+
+gsize
+swfdec_as_str_length (SwfdecAsContext *cx, const char *str)
+{
+  g_return_val_if_fail (SWFDEC_IS_AS_CONTEXT (cx), 0);
+  g_return_val_if_fail (str != NULL, 0);
+
+  return swfdec_as_str_get_cursor (cx, str)->n_chars;
+}
+
+const char *
+swfdec_as_str_offset_to_pointer (SwfdecAsContext *cx, const char *str, gsize offset)
+{
+  SwfdecAsStringCursor *cursor;
+  const char *s;
+
+  g_return_val_if_fail (SWFDEC_IS_AS_CONTEXT (cx), str);
+  g_return_val_if_fail (str != NULL, str);
+
+  cursor = swfdec_as_str_get_cursor (cx, str);
+  if (offset >= cursor->n_chars)
+    return str + SWFDEC_AS_STR_LENGTH (str);
+  if (cursor->n_chars == SWFDEC_AS_STR_LENGTH (str))
+    return str + offset;
+
+  if (cursor->chars <= offset || cursor->chars - offset < offset) {
+    s = g_utf8_offset_to_pointer (str + cursor->bytes, 
+	(glong) offset - (glong) cursor->chars);
+  } else {
+    s = g_utf8_offset_to_pointer (str, offset);
+  }
+  cursor->chars = offset;
+  cursor->bytes = s - str;
+  return s;
+}
+
+gsize
+swfdec_as_str_pointer_to_offset (SwfdecAsContext *cx, const char *str, const char *pos)
+{
+  SwfdecAsStringCursor *cursor;
+  gsize offset;
+
+  g_return_val_if_fail (SWFDEC_IS_AS_CONTEXT (cx), 0);
+  g_return_val_if_fail (str != NULL, 0);
+  g_return_val_if_fail (pos >= str && pos <= str + SWFDEC_AS_STR_LENGTH (str), 0);
+
+  cursor = swfdec_as_str_get_cursor (cx, str);
+  if (cursor->n_chars == SWFDEC_AS_STR_LENGTH (str))
+    return pos - str;
+
+  if (cursor->bytes <= (gsize) (pos - str)) {
+    offset = cursor->chars + g_utf8_pointer_to_offset (str + cursor->bytes, pos);
+  } else {
+    offset = g_utf8_pointer_to_offset (str, pos);
+  }
+  cursor->chars = offset;
+  cursor->bytes = pos - str;
+  return offset;
+}
+
 /*** AS CODE ***/
 
 #define SWFDEC_AS_STRING_CHECK(result,...) G_STMT_START {\
@@ -72,14 +175,6 @@ swfdec_as_string_init (SwfdecAsString *string)
     return; \
 }G_STMT_END
 
-static const char *
-swfdec_as_str_nth_char (const char *s, guint n)
-{
-  while (*s && n--)
-    s = g_utf8_next_char (s);
-  return s;
-}
-
 SWFDEC_AS_NATIVE (251, 9, swfdec_as_string_lastIndexOf)
 void
 swfdec_as_string_lastIndexOf (SwfdecAsContext *cx, SwfdecAsObject *object,
@@ -98,17 +193,15 @@ swfdec_as_string_lastIndexOf (SwfdecAsContext *cx, SwfdecAsObject *object,
       *ret = swfdec_as_value_from_integer (cx, -1);
       return;
     }
-    tmp = string;
-    offset++;
-    while (*tmp && offset-- != 0)
-      tmp = g_utf8_next_char (tmp);
+    tmp = swfdec_as_str_offset_to_pointer (cx, string, (gsize) offset + 1);
     len = tmp - string;
   } else {
     len = G_MAXSIZE;
   }
   s = g_strrstr_len (string, len, s);
   if (s) {
-    *ret = swfdec_as_value_from_integer (cx, g_utf8_pointer_to_offset (string, s));
+    *ret = swfdec_as_value_from_integer (cx, 
+	swfdec_as_str_pointer_to_offset (cx, string, s));
   } else {
     *ret = swfdec_as_value_from_integer (cx, -1);
   }
@@ -129,12 +222,12 @@ swfdec_as_string_indexOf (SwfdecAsContext *cx, SwfdecAsObject *object,
     offset = swfdec_as_value_to_integer (cx, argv[1]);
   if (offset < 0)
     offset = 0;
-  len = g_utf8_strlen (string, -1);
+  len = swfdec_as_str_length (cx, string);
   if (offset < len) {
-    t = strstr (g_utf8_offset_to_pointer (string, offset), s);
+    t = strstr (swfdec_as_str_offset_to_pointer (cx, string, offset), s);
   }
   if (t != NULL) {
-    i = g_utf8_pointer_to_offset (string, t);
+    i = swfdec_as_str_pointer_to_offset (cx, string, t);
   }
 
   *ret = swfdec_as_value_from_integer (cx, i);
@@ -155,7 +248,7 @@ swfdec_as_string_charAt (SwfdecAsContext *cx, SwfdecAsObject *object,
     SWFDEC_AS_VALUE_SET_STRING (ret, SWFDEC_AS_STR_EMPTY);
     return;
   }
-  s = swfdec_as_str_nth_char (string, i);
+  s = swfdec_as_str_offset_to_pointer (cx, string, i);
   if (*s == 0) {
     SWFDEC_AS_VALUE_SET_STRING (ret, SWFDEC_AS_STR_EMPTY);
     return;
@@ -181,7 +274,7 @@ swfdec_as_string_charCodeAt (SwfdecAsContext *cx, SwfdecAsObject *object,
     *ret = swfdec_as_value_from_number (cx, NAN);
     return;
   }
-  s = swfdec_as_str_nth_char (string, i);
+  s = swfdec_as_str_offset_to_pointer (cx, string, i);
   if (*s == 0) {
     if (cx->version > 5) {
       *ret = swfdec_as_value_from_number (cx, NAN);
@@ -294,7 +387,7 @@ swfdec_as_string_construct (SwfdecAsContext *cx, SwfdecAsObject *object,
     string->string = s;
     swfdec_as_object_set_relay (object, SWFDEC_AS_RELAY (string));
 
-    val = swfdec_as_value_from_integer (cx, g_utf8_strlen (string->string, -1));
+    val = swfdec_as_value_from_integer (cx, swfdec_as_str_length (cx, string->string));
     swfdec_as_object_set_variable_and_flags (object, SWFDEC_AS_STR_length,
 	&val, SWFDEC_AS_VARIABLE_HIDDEN | SWFDEC_AS_VARIABLE_PERMANENT);
 
@@ -457,7 +550,7 @@ swfdec_as_string_slice (SwfdecAsContext *cx, SwfdecAsObject *object,
 
   SWFDEC_AS_STRING_CHECK (&str, "i", &start);
 
-  length = g_utf8_strlen (str, -1);
+  length = swfdec_as_str_length (cx, str);
 
   if (start < 0)
     start += length;
@@ -482,29 +575,30 @@ swfdec_as_string_concat (SwfdecAsContext *cx, SwfdecAsObject *object,
     guint argc, SwfdecAsValue *argv, SwfdecAsValue *ret)
 {
   guint i;
-  GString *string;
+  const char **strings;
   const char *s;
 
   SWFDEC_AS_STRING_CHECK (&s, "");
 
-  string = g_string_new (s);
-
+  strings = g_new (const char *, argc + 1);
+  strings[0] = s;
   for (i = 0; i < argc; i++) {
-    string = g_string_append (string, swfdec_as_value_to_string (cx, argv[i]));
+    strings[i + 1] = swfdec_as_value_to_string (cx, argv[i]);
   }
 
   SWFDEC_AS_VALUE_SET_STRING (ret,
-      swfdec_as_context_give_string (cx, g_string_free (string, FALSE)));
+      swfdec_as_context_join_strings (cx, strings, argc + 1));
+  g_free (strings);
 }
 
 const char *
 swfdec_as_str_sub (SwfdecAsContext *cx, const char *str, guint offset, guint len)
 {
-  const char *end;
+  const char *start, *end;
 
-  str = g_utf8_offset_to_pointer (str, offset);
-  end = g_utf8_offset_to_pointer (str, len);
-  str = swfdec_as_context_give_string (cx, g_strndup (str, end - str));
+  start = swfdec_as_str_offset_to_pointer (cx, str, offset);
+  end = swfdec_as_str_offset_to_pointer (cx, str, (gsize) offset + len);
+  str = swfdec_as_context_give_string (cx, g_strndup (start, end - start));
   return str;
 }
 
@@ -518,7 +612,7 @@ swfdec_as_string_substr (SwfdecAsContext *cx, SwfdecAsObject *object,
 
   SWFDEC_AS_STRING_CHECK (&string, "i", &from);
 
-  len = g_utf8_strlen (string, -1);
+  len = swfdec_as_str_length (cx, string);
   
   if (argc > 1 && !SWFDEC_AS_VALUE_IS_UNDEFINED (argv[1])) {
     to = swfdec_as_value_to_integer (cx, argv[1]);
@@ -553,7 +647,7 @@ swfdec_as_string_substring (SwfdecAsContext *cx, SwfdecAsObject *object,
 
   SWFDEC_AS_STRING_CHECK (&string, "i", &from);
 
-  len = g_utf8_strlen (string, -1);
+  len = swfdec_as_str_length (cx, string);
   if (argc > 1 && !SWFDEC_AS_VALUE_IS_UNDEFINED (argv[1])) {
     to = swfdec_as_value_to_integer (cx, argv[1]);
   } else {
@@ -46,6 +46,14 @@ struct _SwfdecAsStringClass {
 
 GType		swfdec_as_string_get_type	(void);
 
+gsize		swfdec_as_str_length		(SwfdecAsContext *	cx,
+						 const char *		str);
+const char *	swfdec_as_str_offset_to_pointer	(SwfdecAsContext *	cx,
+						 const char *		str,
+						 gsize			offset);
+gsize		swfdec_as_str_pointer_to_offset	(SwfdecAsContext *	cx,
+						 const char *		str,
+						 const char *		pos);
 const char *	swfdec_as_str_sub		(SwfdecAsContext *	cx,
 						 const char *		str,
 						 guint			offset,
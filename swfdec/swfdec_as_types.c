@@ -310,7 +310,32 @@ swfdec_as_str_concat (SwfdecAsContext *cx, const char * s1, const char *s2)
 const char *
 swfdec_as_integer_to_string (SwfdecAsContext *context, int i)
 {
-  return swfdec_as_context_give_string (context, g_strdup_printf ("%d", i));
+  SwfdecAsContextPrivate *priv;
+  char tmp[16], *s;
+  guint u, slot;
+
+  g_return_val_if_fail (SWFDEC_IS_AS_CONTEXT (context), SWFDEC_AS_STR_EMPTY);
+
+  /* integers are converted all the time for array indexes, so remember the
+   * last ones */
+  priv = context->priv;
+  slot = (guint) i % SWFDEC_AS_CONTEXT_INTEGER_STRINGS;
+  if (priv->integer_strings[slot] && priv->integer_values[slot] == i)
+    return priv->integer_strings[slot];
+
+  s = &tmp[G_N_ELEMENTS (tmp) - 1];
+  *s = 0;
+  u = i < 0 ? -(guint) i : (guint) i;
+  do {
+    *--s = '0' + u % 10;
+    u /= 10;
+  } while (u);
+  if (i < 0)
+    *--s = '-';
+
+  priv->integer_values[slot] = i;
+  priv->integer_strings[slot] = swfdec_as_context_get_string (context, s);
+  return priv->integer_strings[slot];
 }
 
 /**
@@ -345,6 +370,9 @@ swfdec_as_double_to_string (SwfdecAsContext *context, double d)
   /* stupid -0.0 */
   if (fabs (d) == 0.0)
     return SWFDEC_AS_STR_0;
+  /* integers always print all their digits */
+  if (d >= G_MININT && d <= G_MAXINT && d == (int) d)
+    return swfdec_as_integer_to_string (context, (int) d);
 
   tmp[0] = ' ';
   s = &tmp[1];
@@ -498,6 +526,33 @@ swfdec_as_value_to_string (SwfdecAsContext *context, SwfdecAsValue value)
   }
 }
 
+/* parses short decimal integers like array indexes without going through
+ * strtod. Returns FALSE if @s needs the generic code */
+static gboolean
+swfdec_as_str_to_integer (SwfdecAsContext *context, const char *s, double *d)
+{
+  const char *start;
+  int i;
+
+  start = s;
+  if (*s == '-')
+    s++;
+  /* leading 0s mean octal in newer versions */
+  if (*s == '0' && s[1] != 0 && context->version > 5)
+    return FALSE;
+  for (i = 0; *s >= '0' && *s <= '9'; s++) {
+    /* 9 digits always fit */
+    if (s - start >= 9 + (*start == '-'))
+      return FALSE;
+    i = i * 10 + *s - '0';
+  }
+  if (*s != 0 || s == start || (*start == '-' && s == start + 1))
+    return FALSE;
+
+  *d = *start == '-' ? -i : i;
+  return TRUE;
+}
+
 /**
  * swfdec_as_value_to_number:
  * @context: a #SwfdecAsContext
@@ -535,6 +590,8 @@ swfdec_as_value_to_number (SwfdecAsContext *context, SwfdecAsValue value)
 	s = SWFDEC_AS_VALUE_GET_STRING (value);
 	if (s == SWFDEC_AS_STR_EMPTY)
 	  return (context->version >= 5) ? NAN : 0.0;
+	if (swfdec_as_str_to_integer (context, s, &d))
+	  return d;
 	if (context->version > 5 && s[0] == '0' &&
 	    (s[1] == 'x' || s[1] == 'X')) {
 	  d = g_ascii_strtoll (s + 2, &end, 16);
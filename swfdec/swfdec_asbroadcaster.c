@@ -26,33 +26,31 @@
 #include "swfdec_as_strings.h"
 #include "swfdec_as_context.h"
 #include "swfdec_as_frame_internal.h"
+#include "swfdec_as_native_function.h"
 #include "swfdec_debug.h"
 
 /*** AS CODE ***/
 
-SWFDEC_AS_NATIVE (101, 12, broadcastMessage)
-void
-broadcastMessage (SwfdecAsContext *cx, SwfdecAsObject *object,
-    guint argc, SwfdecAsValue *argv, SwfdecAsValue *ret)
+static gboolean
+swfdec_as_broadcaster_do_broadcast (SwfdecAsObject *object, guint argc, 
+    SwfdecAsValue *argv)
 {
+  SwfdecAsContext *cx = object->context;
   SwfdecAsValue val;
   SwfdecAsObject *listeners, *o;
   gint i, length;
   const char *name;
   GSList *list = NULL, *walk;
 
-  if (object == NULL)
-    return;
-
   if (argc < 1)
-    return;
+    return FALSE;
   name = swfdec_as_value_to_string (cx, argv[0]);
   argv += 1;
   argc--;
 
   swfdec_as_object_get_variable (object, SWFDEC_AS_STR__listeners, &val);
   if (!SWFDEC_AS_VALUE_IS_COMPOSITE (val))
-    return;
+    return FALSE;
 
   listeners = SWFDEC_AS_VALUE_GET_COMPOSITE (val);
   swfdec_as_object_get_variable (listeners, SWFDEC_AS_STR_length, &val);
@@ -60,7 +58,7 @@ broadcastMessage (SwfdecAsContext *cx, SwfdecAsObject *object,
 
   /* return undefined if we won't try to call anything */
   if (length <= 0)
-    return;
+    return FALSE;
 
   /* FIXME: solve this wth foreach, so it gets faster for weird cases */
   for (i = 0; i < length; i++) {
@@ -71,7 +69,7 @@ broadcastMessage (SwfdecAsContext *cx, SwfdecAsObject *object,
     list = g_slist_prepend (list, o);
   }
   if (list == NULL)
-    return;
+    return FALSE;
 
   list = g_slist_reverse (list);
   for (walk = list; walk; walk = walk->next) {
@@ -79,6 +77,51 @@ broadcastMessage (SwfdecAsContext *cx, SwfdecAsObject *object,
   }
   g_slist_free (list);
 
-  SWFDEC_AS_VALUE_SET_BOOLEAN (ret, TRUE);
+  return TRUE;
+}
+
+SWFDEC_AS_NATIVE (101, 12, broadcastMessage)
+void
+broadcastMessage (SwfdecAsContext *cx, SwfdecAsObject *object,
+    guint argc, SwfdecAsValue *argv, SwfdecAsValue *ret)
+{
+  if (object == NULL)
+    return;
+
+  if (swfdec_as_broadcaster_do_broadcast (object, argc, argv))
+    SWFDEC_AS_VALUE_SET_BOOLEAN (ret, TRUE);
 }
 
+/**
+ * swfdec_as_broadcaster_broadcast:
+ * @object: the object to broadcast from
+ * @argc: number of arguments
+ * @argv: arguments, the first one being the name of the message
+ *
+ * Calls @object.broadcastMessage() with the given arguments. If 
+ * broadcastMessage is the native function, no function call is done, which
+ * makes broadcasts very cheap when there are no listeners. This is used for 
+ * broadcasting events like mouse moves from the player.
+ **/
+void
+swfdec_as_broadcaster_broadcast (SwfdecAsObject *object, guint argc, 
+    SwfdecAsValue *argv)
+{
+  SwfdecAsFunction *fun;
+  SwfdecAsValue val;
+
+  g_return_if_fail (object != NULL);
+  g_return_if_fail (argc > 0);
+  g_return_if_fail (argv != NULL);
+
+  swfdec_as_object_get_variable (object, SWFDEC_AS_STR_broadcastMessage, &val);
+  if (!SWFDEC_AS_VALUE_IS_OBJECT (val))
+    return;
+  fun = (SwfdecAsFunction *) SWFDEC_AS_VALUE_GET_OBJECT (val)->relay;
+  if (SWFDEC_IS_AS_NATIVE_FUNCTION (fun) &&
+      SWFDEC_AS_NATIVE_FUNCTION (fun)->native == broadcastMessage) {
+    swfdec_as_broadcaster_do_broadcast (object, argc, argv);
+  } else if (SWFDEC_IS_AS_FUNCTION (fun)) {
+    swfdec_as_function_call (fun, object, argc, argv, &val);
+  }
+}
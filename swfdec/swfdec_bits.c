@@ -681,6 +681,8 @@ swfdec_bits_decompress (SwfdecBits *bits, int compressed, int decompressed)
 {
   z_stream z = { 0, };
   SwfdecBuffer *buffer;
+  guchar *data;
+  gsize length;
   int result;
 
   g_return_val_if_fail (bits != NULL, NULL);
@@ -708,9 +710,12 @@ swfdec_bits_decompress (SwfdecBits *bits, int compressed, int decompressed)
     SWFDEC_ERROR ("Error initialising zlib: %d %s", result, z.msg ? z.msg : "");
     goto fail;
   }
-  buffer = swfdec_buffer_new (decompressed > 0 ? decompressed : compressed * 2);
-  z.next_out = buffer->data;
-  z.avail_out = buffer->length;
+  /* buffers may keep their data inline, so grow the data before creating the
+   * buffer when the size is unknown */
+  length = decompressed > 0 ? (gsize) decompressed : (gsize) compressed * 2;
+  data = g_malloc (length);
+  z.next_out = data;
+  z.avail_out = length;
   while (TRUE) {
     result = inflate (&z, decompressed > 0 ? Z_FINISH : 0);
     switch (result) {
@@ -718,21 +723,22 @@ swfdec_bits_decompress (SwfdecBits *bits, int compressed, int decompressed)
 	goto out;
       case Z_OK:
 	if (decompressed < 0) {
-	  buffer->data = g_realloc (buffer->data, buffer->length + compressed);
-	  buffer->length += compressed;
-	  z.next_out = buffer->data + z.total_out;
-	  z.avail_out = buffer->length - z.total_out;
+	  length += compressed;
+	  data = g_realloc (data, length);
+	  z.next_out = data + z.total_out;
+	  z.avail_out = length - z.total_out;
           break;
 	}
 	/* else fall through */
       default:
 	SWFDEC_ERROR ("error decompressing data: inflate returned %d %s",
 	    result, z.msg ? z.msg : "");
-	swfdec_buffer_unref (buffer);
+	g_free (data);
 	goto fail;
     }
   }
 out:
+  buffer = swfdec_buffer_new_for_data (data, length);
   if (decompressed < 0) {
     buffer->length = z.total_out;
   } else {
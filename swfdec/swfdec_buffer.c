@@ -83,6 +83,35 @@ swfdec_buffer_get_type (void)
   return type_swfdec_buffer;
 }
 
+/* Buffers up to this size keep their data in the same memory block as the
+ * buffer itself, so they only need one (slice) allocation. This helps with the
+ * huge amount of small buffers created when decoding. */
+#define SWFDEC_BUFFER_INLINE_SIZE 256
+
+/* frees the whole block, so the buffer must not be freed afterwards */
+static void
+swfdec_buffer_free_inline (gpointer *priv, unsigned char *data)
+{
+  g_slice_free1 (GPOINTER_TO_SIZE (priv), data - sizeof (SwfdecBuffer));
+}
+
+static SwfdecBuffer *
+swfdec_buffer_new_inline (gsize size)
+{
+  SwfdecBuffer *buffer;
+  gsize alloc;
+
+  alloc = sizeof (SwfdecBuffer) + size;
+  buffer = g_slice_alloc (alloc);
+  buffer->ref_count = 1;
+  buffer->data = (unsigned char *) (buffer + 1);
+  buffer->length = size;
+  buffer->free = swfdec_buffer_free_inline;
+  buffer->priv = GSIZE_TO_POINTER (alloc);
+
+  return buffer;
+}
+
 /**
  * swfdec_buffer_new:
  * @size: amount of bytes to allocate
@@ -95,7 +124,12 @@ swfdec_buffer_get_type (void)
 SwfdecBuffer *
 swfdec_buffer_new (gsize size)
 {
-  unsigned char *data = g_malloc (size);
+  unsigned char *data;
+
+  if (size <= SWFDEC_BUFFER_INLINE_SIZE)
+    return swfdec_buffer_new_inline (size);
+
+  data = g_malloc (size);
   return swfdec_buffer_new_full (data, size, (SwfdecBufferFreeFunc) g_free, data);
 }
 
@@ -111,7 +145,15 @@ swfdec_buffer_new (gsize size)
 SwfdecBuffer *
 swfdec_buffer_new0 (gsize size)
 {
-  unsigned char *data = g_malloc0 (size);
+  unsigned char *data;
+
+  if (size <= SWFDEC_BUFFER_INLINE_SIZE) {
+    SwfdecBuffer *buffer = swfdec_buffer_new_inline (size);
+    memset (buffer->data, 0, size);
+    return buffer;
+  }
+
+  data = g_malloc0 (size);
   return swfdec_buffer_new_full (data, size, (SwfdecBufferFreeFunc) g_free, data);
 }
 
@@ -258,7 +300,8 @@ swfdec_buffer_new_from_file (const char *filename, GError **error)
  * swfdec_buffer_ref:
  * @buffer: a #SwfdecBuffer
  *
- * increases the reference count of @buffer by one.
+ * increases the reference count of @buffer by one. Buffers may be shared 
+ * between threads, so this function is thread-safe.
  *
  * Returns: The passed in @buffer.
  **/
@@ -268,7 +311,7 @@ swfdec_buffer_ref (SwfdecBuffer * buffer)
   g_return_val_if_fail (buffer != NULL, NULL);
   g_return_val_if_fail (buffer->ref_count > 0, NULL);
 
-  buffer->ref_count++;
+  g_atomic_int_inc (&buffer->ref_count);
   return buffer;
 }
 
@@ -277,7 +320,8 @@ swfdec_buffer_ref (SwfdecBuffer * buffer)
  * @buffer: a #SwfdecBuffer
  *
  * Decreases the reference count of @buffer by one. If no reference to this
- * buffer exists anymore, the buffer and the memory it manages are freed.
+ * buffer exists anymore, the buffer and the memory it manages are freed. This
+ * function is thread-safe.
  **/
 void
 swfdec_buffer_unref (SwfdecBuffer * buffer)
@@ -285,8 +329,11 @@ swfdec_buffer_unref (SwfdecBuffer * buffer)
   g_return_if_fail (buffer != NULL);
   g_return_if_fail (buffer->ref_count > 0);
 
-  buffer->ref_count--;
-  if (buffer->ref_count == 0) {
+  if (g_atomic_int_dec_and_test (&buffer->ref_count)) {
+    if (buffer->free == swfdec_buffer_free_inline) {
+      swfdec_buffer_free_inline (buffer->priv, buffer->data);
+      return;
+    }
     if (buffer->free)
       buffer->free (buffer->priv, buffer->data);
     g_slice_free (SwfdecBuffer, buffer);
@@ -630,12 +677,95 @@ static ByteOrderMark boms[] = {
   { "UTF-8", 0, {0, 0, 0, 0} }
 };
 
+/* returns the data in @queue starting @offset bytes into it up to the end of
+ * the buffer containing that byte or %NULL if @queue isn't that big.
+ * If @iter is given, it remembers where that buffer is, so walking the queue
+ * with increasing offsets doesn't need to start at the beginning every time.
+ * Initialize it with zeros. It stays valid while data is only appended to the
+ * queue; pulling data makes the next call start at the beginning again. Reset
+ * it when clearing the queue. */
+SwfdecBuffer *
+swfdec_buffer_queue_peek_buffer_at (SwfdecBufferQueue *queue, gsize offset,
+    SwfdecBufferQueueIter *iter)
+{
+  GSList *walk;
+  gsize start;
+
+  g_return_val_if_fail (queue != NULL, NULL);
+
+  if (iter && iter->link && iter->flushed == queue->offset && 
+      iter->start <= offset) {
+    walk = iter->link;
+    start = iter->start;
+  } else {
+    walk = queue->first_buffer;
+    start = 0;
+  }
+  for (; walk; walk = walk->next) {
+    SwfdecBuffer *buffer = walk->data;
+    if (offset < start + buffer->length) {
+      if (iter) {
+	iter->link = walk;
+	iter->start = start;
+	iter->flushed = queue->offset;
+      }
+      offset -= start;
+      return swfdec_buffer_new_subbuffer (buffer, offset, buffer->length - offset);
+    }
+    start += buffer->length;
+  }
+
+  return NULL;
+}
+
+/* returns the encoding swfdec_buffer_queue_pull_text() would use and the size
+ * of the byte order mark it would skip */
+const char *
+swfdec_buffer_queue_peek_encoding (SwfdecBufferQueue *queue, guint version,
+    guint *bom_length)
+{
+  SwfdecBuffer *buffer;
+  gsize size;
+  guint i, j;
+
+  g_return_val_if_fail (queue != NULL, NULL);
+
+  if (version <= 5) {
+    if (bom_length)
+      *bom_length = 0;
+    return "LATIN1";
+  }
+
+  size = MIN (swfdec_buffer_queue_get_depth (queue), 4);
+  buffer = swfdec_buffer_queue_peek (queue, size);
+  g_assert (buffer);
+
+  for (i = 0; boms[i].length > 0; i++) {
+    // FIXME: test what happens if we have BOM and nothing else
+    if (size < boms[i].length)
+      continue;
+
+    for (j = 0; j < boms[i].length; j++) {
+      if (buffer->data[j] != boms[i].data[j])
+	break;
+    }
+    if (j == boms[i].length)
+      break;
+  }
+  swfdec_buffer_unref (buffer);
+
+  if (bom_length)
+    *bom_length = boms[i].length;
+  return boms[i].name;
+}
+
 char *
 swfdec_buffer_queue_pull_text (SwfdecBufferQueue *queue, guint version)
 {
   SwfdecBuffer *buffer;
+  const char *encoding;
   char *text;
-  guint size, i, j;
+  guint size, skip;
 
   size = swfdec_buffer_queue_get_depth (queue);
   if (size == 0) {
@@ -643,44 +773,22 @@ swfdec_buffer_queue_pull_text (SwfdecBufferQueue *queue, guint version)
     return g_strdup ("");
   }
 
+  encoding = swfdec_buffer_queue_peek_encoding (queue, version, &skip);
   buffer = swfdec_buffer_queue_pull (queue, size);
   g_assert (buffer);
 
-  if (version > 5) {
-    for (i = 0; boms[i].length > 0; i++) {
-      // FIXME: test what happens if we have BOM and nothing else
-      if (size < boms[i].length)
-	continue;
-
-      for (j = 0; j < boms[i].length; j++) {
-	if (buffer->data[j] != boms[i].data[j])
-	  break;
-      }
-      if (j == boms[i].length)
-	break;
-    }
-
-    if (!strcmp (boms[i].name, "UTF-8")) {
-      if (!g_utf8_validate ((char *)buffer->data + boms[i].length,
-	    size - boms[i].length, NULL)) {
-	SWFDEC_ERROR ("downloaded data is not valid UTF-8");
-	text = NULL;
-      } else {
-	text =
-	  g_strndup ((char *)buffer->data + boms[i].length,
-	      size - boms[i].length);
-      }
+  if (!strcmp (encoding, "UTF-8")) {
+    if (!g_utf8_validate ((char *)buffer->data + skip, size - skip, NULL)) {
+      SWFDEC_ERROR ("downloaded data is not valid UTF-8");
+      text = NULL;
     } else {
-      text = g_convert ((char *)buffer->data + boms[i].length,
-	  size - boms[i].length, "UTF-8", boms[i].name, NULL, NULL, NULL);
-      if (text == NULL)
-	SWFDEC_ERROR ("downloaded data is not valid %s", boms[i].name);
+      text = g_strndup ((char *)buffer->data + skip, size - skip);
     }
   } else {
-    text = g_convert ((char *)buffer->data, size, "UTF-8", "LATIN1", NULL,
-	NULL, NULL);
+    text = g_convert ((char *)buffer->data + skip, size - skip, "UTF-8",
+	encoding, NULL, NULL, NULL);
     if (text == NULL)
-      SWFDEC_ERROR ("downloaded data is not valid LATIN1");
+      SWFDEC_ERROR ("downloaded data is not valid %s", encoding);
   }
 
   swfdec_buffer_unref (buffer);
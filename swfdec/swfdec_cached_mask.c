@@ -0,0 +1,98 @@
+/* Swfdec
+ * Copyright (C) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, 
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "swfdec_cached_mask.h"
+#include "swfdec_debug.h"
+
+G_DEFINE_TYPE (SwfdecCachedMask, swfdec_cached_mask, SWFDEC_TYPE_CACHED)
+
+static void
+swfdec_cached_mask_dispose (GObject *object)
+{
+  SwfdecCachedMask *mask = SWFDEC_CACHED_MASK (object);
+
+  if (mask->object) {
+    g_object_unref (mask->object);
+    mask->object = NULL;
+  }
+  if (mask->surface) {
+    cairo_surface_destroy (mask->surface);
+    mask->surface = NULL;
+  }
+
+  G_OBJECT_CLASS (swfdec_cached_mask_parent_class)->dispose (object);
+}
+
+static void
+swfdec_cached_mask_class_init (SwfdecCachedMaskClass * g_class)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (g_class);
+
+  object_class->dispose = swfdec_cached_mask_dispose;
+}
+
+static void
+swfdec_cached_mask_init (SwfdecCachedMask *cached)
+{
+}
+
+SwfdecCachedMask *
+swfdec_cached_mask_new (GObject *object, guint serial, const cairo_matrix_t *matrix,
+    cairo_surface_t *surface, int x, int y, gsize size)
+{
+  SwfdecCachedMask *mask;
+
+  g_return_val_if_fail (G_IS_OBJECT (object), NULL);
+  g_return_val_if_fail (matrix != NULL, NULL);
+
+  size += sizeof (SwfdecCachedMask);
+  mask = g_object_new (SWFDEC_TYPE_CACHED_MASK, "size", size, NULL);
+  /* Keep a reference, so the address can't be reused by a different object.
+   * With a weak reference, the object's last unref - possibly in another 
+   * thread - would have to modify our renderer's cache. */
+  mask->object = g_object_ref (object);
+  mask->serial = serial;
+  mask->matrix = *matrix;
+  if (surface)
+    mask->surface = cairo_surface_reference (surface);
+  mask->x = x;
+  mask->y = y;
+
+  return mask;
+}
+
+gboolean
+swfdec_cached_mask_matches (SwfdecCachedMask *mask, guint serial, 
+    const cairo_matrix_t *matrix)
+{
+  g_return_val_if_fail (SWFDEC_IS_CACHED_MASK (mask), FALSE);
+  g_return_val_if_fail (matrix != NULL, FALSE);
+
+  return mask->serial == serial &&
+      mask->matrix.xx == matrix->xx &&
+      mask->matrix.yx == matrix->yx &&
+      mask->matrix.xy == matrix->xy &&
+      mask->matrix.yy == matrix->yy &&
+      mask->matrix.x0 == matrix->x0 &&
+      mask->matrix.y0 == matrix->y0;
+}
@@ -0,0 +1,71 @@
+/* Swfdec
+ * Copyright (c) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, 
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifndef _SWFDEC_CACHED_MASK_H_
+#define _SWFDEC_CACHED_MASK_H_
+
+#include <cairo.h>
+#include <swfdec/swfdec_cached.h>
+
+G_BEGIN_DECLS
+
+typedef struct _SwfdecCachedMask SwfdecCachedMask;
+typedef struct _SwfdecCachedMaskClass SwfdecCachedMaskClass;
+
+#define SWFDEC_TYPE_CACHED_MASK                    (swfdec_cached_mask_get_type())
+#define SWFDEC_IS_CACHED_MASK(obj)                 (G_TYPE_CHECK_INSTANCE_TYPE ((obj), SWFDEC_TYPE_CACHED_MASK))
+#define SWFDEC_IS_CACHED_MASK_CLASS(klass)         (G_TYPE_CHECK_CLASS_TYPE ((klass), SWFDEC_TYPE_CACHED_MASK))
+#define SWFDEC_CACHED_MASK(obj)                    (G_TYPE_CHECK_INSTANCE_CAST ((obj), SWFDEC_TYPE_CACHED_MASK, SwfdecCachedMask))
+#define SWFDEC_CACHED_MASK_CLASS(klass)            (G_TYPE_CHECK_CLASS_CAST ((klass), SWFDEC_TYPE_CACHED_MASK, SwfdecCachedMaskClass))
+#define SWFDEC_CACHED_MASK_GET_CLASS(obj)          (G_TYPE_INSTANCE_GET_CLASS ((obj), SWFDEC_TYPE_CACHED_MASK, SwfdecCachedMaskClass))
+
+
+struct _SwfdecCachedMask {
+  SwfdecCached		cached;
+
+  GObject *		object;		/* reference to the object the mask was rendered from */
+  guint			serial;		/* serial of the object when rendering */
+  cairo_matrix_t	matrix;		/* matrix used for rendering, translation is below one pixel */
+  int			x;		/* offset of the mask relative to the integer translation */
+  int			y;
+  cairo_surface_t *	surface;	/* A8 surface containing the coverage or NULL if not rendered yet */
+};
+
+struct _SwfdecCachedMaskClass
+{
+  SwfdecCachedClass	cached_class;
+};
+
+GType			swfdec_cached_mask_get_type	(void);
+
+SwfdecCachedMask *	swfdec_cached_mask_new		(GObject *		object,
+							 guint			serial,
+							 const cairo_matrix_t *	matrix,
+							 cairo_surface_t *	surface,
+							 int			x,
+							 int			y,
+							 gsize			size);
+
+gboolean		swfdec_cached_mask_matches	(SwfdecCachedMask *	mask,
+							 guint			serial,
+							 const cairo_matrix_t *	matrix);
+
+
+G_END_DECLS
+#endif
@@ -40,9 +40,25 @@ enum {
 G_DEFINE_ABSTRACT_TYPE (SwfdecDecoder, swfdec_decoder, G_TYPE_OBJECT)
 static guint signals[LAST_SIGNAL] = { 0, };
 
+static void
+swfdec_decoder_dispose (GObject *object)
+{
+  SwfdecDecoder *decoder = SWFDEC_DECODER (object);
+
+  g_slist_foreach (decoder->missing_plugins, (GFunc) g_free, NULL);
+  g_slist_free (decoder->missing_plugins);
+  decoder->missing_plugins = NULL;
+
+  G_OBJECT_CLASS (swfdec_decoder_parent_class)->dispose (object);
+}
+
 static void
 swfdec_decoder_class_init (SwfdecDecoderClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = swfdec_decoder_dispose;
+
   /**
    * SwfdecDecoder::missing-plugin:
    * @player: the #SwfdecPlayer missing plugins
@@ -124,8 +140,8 @@ swfdec_decoder_use_audio_codec (SwfdecDecoder *decoder, guint codec,
     return;
 
   SWFDEC_INFO ("missing audio plugin: %s\n", detail);
+  decoder->missing_plugins = g_slist_prepend (decoder->missing_plugins, detail);
   g_signal_emit (decoder, signals[MISSING_PLUGINS], 0, detail);
-  g_free (detail);
 }
 
 void
@@ -141,7 +157,7 @@ swfdec_decoder_use_video_codec (SwfdecDecoder *decoder, guint codec)
     return;
 
   SWFDEC_INFO ("missing video plugin: %s\n", detail);
+  decoder->missing_plugins = g_slist_prepend (decoder->missing_plugins, detail);
   g_signal_emit (decoder, signals[MISSING_PLUGINS], 0, detail);
-  g_free (detail);
 }
 
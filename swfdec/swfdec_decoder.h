@@ -67,6 +67,7 @@ struct _SwfdecDecoder
   guint			bytes_total;	/* total bytes in the file or 0 if not known */
   guint			frames_loaded;	/* frames already loaded */
   guint			frames_total;	/* total frames */
+  GSList *		missing_plugins;/* detail strings of all missing plugins */
 };
 
 struct _SwfdecDecoderClass
@@ -207,4 +207,5 @@ swfdec_draw_recompute (SwfdecDraw *draw)
   klass = SWFDEC_DRAW_GET_CLASS (draw);
   g_assert (klass->compute_extents);
   klass->compute_extents (draw);
+  draw->serial++;
 }
@@ -43,7 +43,9 @@ struct _SwfdecDraw
 
   /*< protected >*/
   gboolean		snap;		/* this drawing op does pixel snapping on the device grid */
+  gboolean		glyph;		/* this drawing op is a font glyph, so it's painted a lot */
   SwfdecRect		extents;	/* extents of path */
+  guint			serial;		/* increased every time the path changes */
   cairo_path_t		path;		/* path to draw with this operation - in twips */
   cairo_path_t		end_path;     	/* end path to draw with this operation if morph operation */
 };
@@ -35,7 +35,7 @@ struct _SwfdecEvent {
 };
 
 struct _SwfdecEventList {
-  guint			refcount;
+  volatile gint		refcount;
   GArray *		events;
 };
 
@@ -119,7 +119,7 @@ swfdec_event_list_copy (SwfdecEventList *list)
   g_return_val_if_fail (list != NULL, NULL);
   g_return_val_if_fail (list->refcount > 0, NULL);
 
-  list->refcount++;
+  g_atomic_int_inc (&list->refcount);
 
   return list;
 }
@@ -132,8 +132,7 @@ swfdec_event_list_free (SwfdecEventList *list)
   g_return_if_fail (list != NULL);
   g_return_if_fail (list->refcount > 0);
 
-  list->refcount--;
-  if (list->refcount > 0)
+  if (!g_atomic_int_dec_and_test (&list->refcount))
     return;
 
   for (i = 0; i < list->events->len; i++) {
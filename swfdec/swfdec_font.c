@@ -193,6 +193,7 @@ swfdec_font_parse_shape (SwfdecSwfDecoder *s, SwfdecFontEntry *entry, guint size
   list = swfdec_shape_parser_free (parser);
   if (list) {
     entry->draw = g_object_ref (list->data);
+    entry->draw->glyph = TRUE;
     g_slist_foreach (list, (GFunc) g_object_unref, NULL);
     g_slist_free (list);
   } else {
@@ -189,7 +189,8 @@ swfdec_image_create_surface_for_data (SwfdecRenderer *renderer, guint8 *data,
 }
 
 static cairo_surface_t * 
-swfdec_image_jpeg_load (SwfdecImage *image, SwfdecRenderer *renderer)
+swfdec_image_jpeg_load (SwfdecImage *image, SwfdecRenderer *renderer,
+    guint *width, guint *height)
 {
   gboolean ret;
   guint8 *data;
@@ -198,22 +199,22 @@ swfdec_image_jpeg_load (SwfdecImage *image, SwfdecRenderer *renderer)
     ret = swfdec_jpeg_decode_argb (renderer,
         image->jpegtables->data, image->jpegtables->length,
         image->raw_data->data, image->raw_data->length,
-        (void *) &data, &image->width, &image->height);
+        (void *) &data, width, height);
   } else {
     ret = swfdec_jpeg_decode_argb (renderer,
         image->raw_data->data, image->raw_data->length,
         NULL, 0,
-        (void *)&data, &image->width, &image->height);
+        (void *)&data, width, height);
   }
 
   if (!ret)
     return NULL;
 
-  SWFDEC_LOG ("  width = %d", image->width);
-  SWFDEC_LOG ("  height = %d", image->height);
+  SWFDEC_LOG ("  width = %d", *width);
+  SWFDEC_LOG ("  height = %d", *height);
 
   return swfdec_image_create_surface_for_data (renderer, data, 
-      CAIRO_FORMAT_RGB24, image->width, image->height, 4 * image->width);
+      CAIRO_FORMAT_RGB24, *width, *height, 4 * *width);
 }
 
 int
@@ -237,22 +238,23 @@ tag_func_define_bits_jpeg_2 (SwfdecSwfDecoder * s, guint tag)
 }
 
 static cairo_surface_t *
-swfdec_image_jpeg2_load (SwfdecImage *image, SwfdecRenderer *renderer)
+swfdec_image_jpeg2_load (SwfdecImage *image, SwfdecRenderer *renderer,
+    guint *width, guint *height)
 {
   gboolean ret;
   guint8 *data;
 
   ret = swfdec_jpeg_decode_argb (renderer, image->raw_data->data, image->raw_data->length,
       NULL, 0,
-      (void *)&data, &image->width, &image->height);
+      (void *)&data, width, height);
   if (!ret)
     return NULL;
 
-  SWFDEC_LOG ("  width = %d", image->width);
-  SWFDEC_LOG ("  height = %d", image->height);
+  SWFDEC_LOG ("  width = %d", *width);
+  SWFDEC_LOG ("  height = %d", *height);
 
   return swfdec_image_create_surface_for_data (renderer, data, 
-      CAIRO_FORMAT_RGB24, image->width, image->height, 4 * image->width);
+      CAIRO_FORMAT_RGB24, *width, *height, 4 * *width);
 }
 
 int
@@ -276,15 +278,15 @@ tag_func_define_bits_jpeg_3 (SwfdecSwfDecoder * s, guint tag)
 }
 
 static void
-merge_alpha (SwfdecImage * image, unsigned char *image_data,
+merge_alpha (guint width, guint height, unsigned char *image_data,
     unsigned char *alpha)
 {
   unsigned int x, y;
   unsigned char *p;
 
-  for (y = 0; y < image->height; y++) {
-    p = image_data + y * image->width * 4;
-    for (x = 0; x < image->width; x++) {
+  for (y = 0; y < height; y++) {
+    p = image_data + y * width * 4;
+    for (x = 0; x < width; x++) {
       p[SWFDEC_COLOR_INDEX_ALPHA] = *alpha;
       p[SWFDEC_COLOR_INDEX_RED] = MIN (*alpha, p[SWFDEC_COLOR_INDEX_RED]);
       p[SWFDEC_COLOR_INDEX_GREEN] = MIN (*alpha, p[SWFDEC_COLOR_INDEX_GREEN]);
@@ -296,7 +298,8 @@ merge_alpha (SwfdecImage * image, unsigned char *image_data,
 }
 
 static cairo_surface_t *
-swfdec_image_jpeg3_load (SwfdecImage *image, SwfdecRenderer *renderer)
+swfdec_image_jpeg3_load (SwfdecImage *image, SwfdecRenderer *renderer,
+    guint *width, guint *height)
 {
   SwfdecBits bits;
   SwfdecBuffer *buffer;
@@ -313,29 +316,30 @@ swfdec_image_jpeg3_load (SwfdecImage *image, SwfdecRenderer *renderer)
 
   ret = swfdec_jpeg_decode_argb (renderer,
       buffer->data, buffer->length, NULL, 0,
-      (void *)&data, &image->width, &image->height);
+      (void *)&data, width, height);
   swfdec_buffer_unref (buffer);
 
   if (!ret)
     return NULL;
 
-  buffer = swfdec_bits_decompress (&bits, -1, image->width * image->height);
+  buffer = swfdec_bits_decompress (&bits, -1, *width * *height);
   if (buffer) {
-    merge_alpha (image, data, buffer->data);
+    merge_alpha (*width, *height, data, buffer->data);
     swfdec_buffer_unref (buffer);
   } else {
     SWFDEC_WARNING ("cannot set alpha channel information, decompression failed");
   }
 
-  SWFDEC_LOG ("  width = %d", image->width);
-  SWFDEC_LOG ("  height = %d", image->height);
+  SWFDEC_LOG ("  width = %d", *width);
+  SWFDEC_LOG ("  height = %d", *height);
 
   return swfdec_image_create_surface_for_data (renderer, data, 
-      CAIRO_FORMAT_ARGB32, image->width, image->height, 4 * image->width);
+      CAIRO_FORMAT_ARGB32, *width, *height, 4 * *width);
 }
 
 static cairo_surface_t *
-swfdec_image_lossless_load (SwfdecImage *image, SwfdecRenderer *renderer)
+swfdec_image_lossless_load (SwfdecImage *image, SwfdecRenderer *renderer,
+    guint *width, guint *height)
 {
   int format;
   unsigned char *ptr;
@@ -347,16 +351,16 @@ swfdec_image_lossless_load (SwfdecImage *image, SwfdecRenderer *renderer)
 
   format = swfdec_bits_get_u8 (&bits);
   SWFDEC_LOG ("  format = %d", format);
-  image->width = swfdec_bits_get_u16 (&bits);
-  SWFDEC_LOG ("  width = %d", image->width);
-  image->height = swfdec_bits_get_u16 (&bits);
-  SWFDEC_LOG ("  height = %d", image->height);
+  *width = swfdec_bits_get_u16 (&bits);
+  SWFDEC_LOG ("  width = %d", *width);
+  *height = swfdec_bits_get_u16 (&bits);
+  SWFDEC_LOG ("  height = %d", *height);
 
   SWFDEC_LOG ("format = %d", format);
-  SWFDEC_LOG ("width = %d", image->width);
-  SWFDEC_LOG ("height = %d", image->height);
+  SWFDEC_LOG ("width = %d", *width);
+  SWFDEC_LOG ("height = %d", *height);
 
-  if (!swfdec_image_validate_size (renderer, image->width, image->height))
+  if (!swfdec_image_validate_size (renderer, *width, *height))
     return NULL;
 
   if (format == 3) {
@@ -365,18 +369,18 @@ swfdec_image_lossless_load (SwfdecImage *image, SwfdecRenderer *renderer)
     guint32 palette[256], *pixels;
     guint i, j;
     guint palette_size;
-    guint rowstride = (image->width + 3) & ~3;
+    guint rowstride = (*width + 3) & ~3;
 
     palette_size = swfdec_bits_get_u8 (&bits) + 1;
     SWFDEC_LOG ("palette_size = %d", palette_size);
 
-    data = g_malloc (4 * image->width * image->height);
+    data = g_malloc (4 * *width * *height);
 
     if (have_alpha) {
-      buffer = swfdec_bits_decompress (&bits, -1, palette_size * 4 + rowstride * image->height);
+      buffer = swfdec_bits_decompress (&bits, -1, palette_size * 4 + rowstride * *height);
       if (buffer == NULL) {
 	SWFDEC_ERROR ("failed to decompress data");
-	memset (data, 0, 4 * image->width * image->height);
+	memset (data, 0, 4 * *width * *height);
 	goto out;
       }
       ptr = buffer->data;
@@ -386,10 +390,10 @@ swfdec_image_lossless_load (SwfdecImage *image, SwfdecRenderer *renderer)
       }
       indexed_data = ptr + palette_size * 4;
     } else {
-      buffer = swfdec_bits_decompress (&bits, -1, palette_size * 3 + rowstride * image->height);
+      buffer = swfdec_bits_decompress (&bits, -1, palette_size * 3 + rowstride * *height);
       if (buffer == NULL) {
 	SWFDEC_ERROR ("failed to decompress data");
-	memset (data, 0, 4 * image->width * image->height);
+	memset (data, 0, 4 * *width * *height);
 	goto out;
       }
       ptr = buffer->data;
@@ -404,8 +408,8 @@ swfdec_image_lossless_load (SwfdecImage *image, SwfdecRenderer *renderer)
 
     /* cast is safe, we malloc'd the memory above */
     pixels = (guint32 *) (gpointer) data;
-    for (j = 0; j < (guint) image->height; j++) {
-      for (i = 0; i < (guint) image->width; i++) {
+    for (j = 0; j < *height; j++) {
+      for (i = 0; i < *width; i++) {
 	*pixels = palette[indexed_data[i]];
 	pixels++;
       }
@@ -424,19 +428,19 @@ swfdec_image_lossless_load (SwfdecImage *image, SwfdecRenderer *renderer)
       have_alpha = FALSE;
     }
 
-    buffer = swfdec_bits_decompress (&bits, -1, 2 * ((image->width + 1) & ~1) * image->height);
-    data = g_malloc (4 * image->width * image->height);
+    buffer = swfdec_bits_decompress (&bits, -1, 2 * ((*width + 1) & ~1) * *height);
+    data = g_malloc (4 * *width * *height);
     idata = data;
     if (buffer == NULL) {
       SWFDEC_ERROR ("failed to decompress data");
-      memset (data, 0, 4 * image->width * image->height);
+      memset (data, 0, 4 * *width * *height);
       goto out;
     }
     ptr = buffer->data;
 
     /* 15 bit packed */
-    for (j = 0; j < image->height; j++) {
-      for (i = 0; i < image->width; i++) {
+    for (j = 0; j < *height; j++) {
+      for (i = 0; i < *width; i++) {
         c = ptr[1] | (ptr[0] << 8);
         idata[SWFDEC_COLOR_INDEX_BLUE] = (c << 3) | ((c >> 2) & 0x7);
         idata[SWFDEC_COLOR_INDEX_GREEN] = ((c >> 2) & 0xf8) | ((c >> 7) & 0x7);
@@ -445,7 +449,7 @@ swfdec_image_lossless_load (SwfdecImage *image, SwfdecRenderer *renderer)
         ptr += 2;
         idata += 4;
       }
-      if (image->width & 1)
+      if (*width & 1)
 	ptr += 2;
     }
     swfdec_buffer_unref (buffer);
@@ -454,17 +458,17 @@ swfdec_image_lossless_load (SwfdecImage *image, SwfdecRenderer *renderer)
     guint i, j;
     guint32 *p;
 
-    buffer = swfdec_bits_decompress (&bits, -1, 4 * image->width * image->height);
+    buffer = swfdec_bits_decompress (&bits, -1, 4 * *width * *height);
     if (buffer == NULL) {
       SWFDEC_ERROR ("failed to decompress data");
-      data = g_malloc0 (4 * image->width * image->height);
+      data = g_malloc0 (4 * *width * *height);
       goto out;
     }
     data = buffer->data;
     p = (void *) data;
     /* image is stored in 0RGB format.  We use ARGB/BGRA. */
-    for (j = 0; j < image->height; j++) {
-      for (i = 0; i < image->width; i++) {
+    for (j = 0; j < *height; j++) {
+      for (i = 0; i < *width; i++) {
 	*p = GUINT32_FROM_BE (*p);
 	p++;
       }
@@ -479,7 +483,7 @@ swfdec_image_lossless_load (SwfdecImage *image, SwfdecRenderer *renderer)
 out:
   return swfdec_image_create_surface_for_data (renderer, data,
       have_alpha ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_RGB24, 
-      image->width, image->height, image->width * 4);
+      *width, *height, *width * 4);
 }
 
 int
@@ -537,7 +541,8 @@ swfdec_image_png_read (void *bitsp, unsigned char *data, unsigned int length)
 }
 
 static cairo_surface_t *
-swfdec_image_png_load (SwfdecImage *image, SwfdecRenderer *renderer)
+swfdec_image_png_load (SwfdecImage *image, SwfdecRenderer *renderer,
+    guint *width, guint *height)
 {
   SwfdecBits bits;
   cairo_surface_t *surface;
@@ -552,9 +557,9 @@ swfdec_image_png_load (SwfdecImage *image, SwfdecRenderer *renderer)
     return NULL;
   }
 
-  image->width = cairo_image_surface_get_width (surface);
-  image->height = cairo_image_surface_get_height (surface);
-  if (!swfdec_image_validate_size (renderer, image->width, image->height)) {
+  *width = cairo_image_surface_get_width (surface);
+  *height = cairo_image_surface_get_height (surface);
+  if (!swfdec_image_validate_size (renderer, *width, *height)) {
     cairo_surface_destroy (surface);
     return NULL;
   }
@@ -600,12 +605,17 @@ swfdec_image_lookup_surface (SwfdecImage *image, SwfdecRenderer *renderer,
   return NULL;
 }
 
+/* images may be shared between players running in different threads, this
+ * lock protects setting their size after decoding */
+G_LOCK_DEFINE_STATIC (decode);
+
 cairo_surface_t *
 swfdec_image_create_surface (SwfdecImage *image, SwfdecRenderer *renderer)
 {
   SwfdecColorTransform trans;
   SwfdecCachedImage *cached;
   cairo_surface_t *surface;
+  guint width = 0, height = 0;
 
   g_return_val_if_fail (SWFDEC_IS_IMAGE (image), NULL);
   g_return_val_if_fail (renderer == NULL || SWFDEC_IS_RENDERER (renderer), NULL);
@@ -618,24 +628,25 @@ swfdec_image_create_surface (SwfdecImage *image, SwfdecRenderer *renderer)
   if (surface)
     return surface;
 
+  /* decode without holding the lock, so players don't wait for each other */
   switch (image->type) {
     case SWFDEC_IMAGE_TYPE_JPEG:
-      surface = swfdec_image_jpeg_load (image, renderer);
+      surface = swfdec_image_jpeg_load (image, renderer, &width, &height);
       break;
     case SWFDEC_IMAGE_TYPE_JPEG2:
-      surface = swfdec_image_jpeg2_load (image, renderer);
+      surface = swfdec_image_jpeg2_load (image, renderer, &width, &height);
       break;
     case SWFDEC_IMAGE_TYPE_JPEG3:
-      surface = swfdec_image_jpeg3_load (image, renderer);
+      surface = swfdec_image_jpeg3_load (image, renderer, &width, &height);
       break;
     case SWFDEC_IMAGE_TYPE_LOSSLESS:
-      surface = swfdec_image_lossless_load (image, renderer);
+      surface = swfdec_image_lossless_load (image, renderer, &width, &height);
       break;
     case SWFDEC_IMAGE_TYPE_LOSSLESS2:
-      surface = swfdec_image_lossless_load (image, renderer);
+      surface = swfdec_image_lossless_load (image, renderer, &width, &height);
       break;
     case SWFDEC_IMAGE_TYPE_PNG:
-      surface = swfdec_image_png_load (image, renderer);
+      surface = swfdec_image_png_load (image, renderer, &width, &height);
       break;
     case SWFDEC_IMAGE_TYPE_UNKNOWN:
     default:
@@ -646,9 +657,17 @@ swfdec_image_create_surface (SwfdecImage *image, SwfdecRenderer *renderer)
     SWFDEC_WARNING ("failed to decode image");
     return NULL;
   }
+  /* If another thread decoded the image in the meantime, it got the same 
+   * size. Our surface is still fine, it's only cached in our renderer. */
+  G_LOCK (decode);
+  if (image->width == 0) {
+    image->width = width;
+    image->height = height;
+  }
+  G_UNLOCK (decode);
   if (renderer) {
     /* FIXME: The size is just an educated guess */
-    cached = swfdec_cached_image_new (surface, image->width * image->height * 4);
+    cached = swfdec_cached_image_new (surface, width * height * 4);
     swfdec_renderer_add_cache (renderer, FALSE, image, SWFDEC_CACHED (cached));
     g_object_unref (cached);
   }
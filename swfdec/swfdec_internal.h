@@ -38,6 +38,17 @@ void			swfdec_net_stream_init_context		(SwfdecPlayer *		player);
 
 char *			swfdec_buffer_queue_pull_text		(SwfdecBufferQueue *	queue,
 								 guint			version);
+const char *		swfdec_buffer_queue_peek_encoding	(SwfdecBufferQueue *	queue,
+								 guint			version,
+								 guint *		bom_length);
+typedef struct {
+  GSList *		link;		/* link of the buffer last peeked or NULL */
+  gsize			start;		/* offset of that buffer in the queue */
+  gsize			flushed;	/* data flushed from the queue at that time */
+} SwfdecBufferQueueIter;
+SwfdecBuffer *		swfdec_buffer_queue_peek_buffer_at	(SwfdecBufferQueue *	queue,
+								 gsize			offset,
+								 SwfdecBufferQueueIter *iter);
 
 gboolean		swfdec_as_value_to_twips		(SwfdecAsContext *	context,
 								 const SwfdecAsValue *	val,
@@ -0,0 +1,627 @@
+/* Swfdec
+ * Copyright (c) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, 
+ * Boston, MA  02110-1301  USA
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include "swfdec_load_cache.h"
+#include "swfdec_debug.h"
+#include "swfdec_loader_internal.h"
+
+/*** GTK-DOC ***/
+
+/**
+ * SECTION:SwfdecLoadCache
+ * @title: SwfdecLoadCache
+ * @short_description: keep loaded resources in memory
+ *
+ * A #SwfdecLoadCache keeps the contents of files loaded by a #SwfdecPlayer 
+ * in memory, so that a repeated request for the same resource can be answered
+ * without asking the #SwfdecLoader of the player again. Flash content often
+ * reloads the same configuration files, skins or images every time it changes
+ * scenes, so this can save a lot of network traffic.
+ *
+ * Requests are identified by their absolute URL. Only completely loaded files
+ * are cached. Only GET requests are cached, requests that post data or set 
+ * custom HTTP headers always bypass the cache. When the size of all cached 
+ * files exceeds the maximum size of the cache, the least recently used files
+ * are dropped. Files do not expire on their own, use 
+ * swfdec_load_cache_invalidate() when a file is known to have changed.
+ *
+ * A #SwfdecLoadCache is not used by default. Use 
+ * swfdec_player_set_load_cache() to enable it. A single cache may be shared by
+ * multiple players, even if they run in different threads. All functions of
+ * a #SwfdecLoadCache are thread-safe, provided g_thread_init() was called 
+ * before the cache was created. Change notifications for its properties
+ * are emitted in the thread that caused the change.
+ */
+
+/**
+ * SwfdecLoadCache:
+ *
+ * The object used to cache loaded files. All its members are private.
+ */
+
+/*** LOADER ***/
+
+/* the loader we use to replay cached data */
+
+typedef struct _SwfdecLoadCacheLoader SwfdecLoadCacheLoader;
+typedef struct _SwfdecLoadCacheLoaderClass SwfdecLoadCacheLoaderClass;
+
+#define SWFDEC_TYPE_LOAD_CACHE_LOADER                    (swfdec_load_cache_loader_get_type())
+
+struct _SwfdecLoadCacheLoader
+{
+  SwfdecLoader		loader;
+};
+
+struct _SwfdecLoadCacheLoaderClass
+{
+  SwfdecLoaderClass   	loader_class;
+};
+
+static GType swfdec_load_cache_loader_get_type (void);
+
+G_DEFINE_TYPE (SwfdecLoadCacheLoader, swfdec_load_cache_loader, SWFDEC_TYPE_LOADER)
+
+static void
+swfdec_load_cache_loader_class_init (SwfdecLoadCacheLoaderClass *klass)
+{
+}
+
+static void
+swfdec_load_cache_loader_init (SwfdecLoadCacheLoader *loader)
+{
+}
+
+/*** SWFDEC_LOAD_CACHE ***/
+
+typedef struct {
+  char *		key;		/* requested URL */
+  char *		url;		/* URL that was reported by the loader */
+  SwfdecBuffer *	data;		/* data that was loaded */
+  gsize			size;		/* memory accounted to this entry */
+} SwfdecLoadCacheEntry;
+
+typedef struct {
+  SwfdecLoadCache *	cache;		/* the cache we belong to */
+  SwfdecLoader *	loader;		/* the loader we watch */
+  char *		key;		/* requested URL */
+  gboolean		invalid;	/* URL was invalidated while loading */
+} SwfdecLoadCachePending;
+
+struct _SwfdecLoadCachePrivate {
+  GMutex *		mutex;		/* mutex protecting the members below */
+  GQueue *		queue;		/* SwfdecLoadCacheEntry, most recently used first */
+  GHashTable *		lookup;		/* key => GList link in queue */
+  GSList *		pending;	/* SwfdecLoadCachePending for loaders still loading */
+  gsize			size;		/* size of all entries */
+  gsize			max_size;	/* maximum size of all entries */
+  guint			hits;		/* requests answered from the cache */
+  guint			misses;		/* requests that needed loading */
+};
+
+enum {
+  PROP_0,
+  PROP_SIZE,
+  PROP_MAX_SIZE
+};
+
+G_DEFINE_TYPE (SwfdecLoadCache, swfdec_load_cache, G_TYPE_OBJECT)
+
+static void
+swfdec_load_cache_entry_free (SwfdecLoadCacheEntry *entry)
+{
+  g_free (entry->key);
+  g_free (entry->url);
+  if (entry->data)
+    swfdec_buffer_unref (entry->data);
+  g_slice_free (SwfdecLoadCacheEntry, entry);
+}
+
+/* NB: assumes that the entry was already removed from priv->queue and the 
+ * mutex is held */
+static void
+swfdec_load_cache_remove (SwfdecLoadCache *cache, SwfdecLoadCacheEntry *entry)
+{
+  SwfdecLoadCachePrivate *priv = cache->priv;
+
+  g_hash_table_remove (priv->lookup, entry->key);
+  priv->size -= entry->size;
+  swfdec_load_cache_entry_free (entry);
+}
+
+/* must be called with the mutex held, returns TRUE if entries were removed */
+static gboolean
+swfdec_load_cache_shrink (SwfdecLoadCache *cache, gsize size)
+{
+  SwfdecLoadCachePrivate *priv = cache->priv;
+  SwfdecLoadCacheEntry *entry;
+
+  if (size >= priv->size)
+    return FALSE;
+
+  do {
+    entry = g_queue_pop_tail (priv->queue);
+    g_assert (entry);
+    swfdec_load_cache_remove (cache, entry);
+  } while (size < priv->size);
+  return TRUE;
+}
+
+static void swfdec_load_cache_loader_gone (gpointer pendingp, GObject *loader);
+static void swfdec_load_cache_loader_complete (SwfdecLoader *loader, 
+    GParamSpec *pspec, SwfdecLoadCachePending *pending);
+
+/* must be called with the mutex held */
+static void
+swfdec_load_cache_pending_free (SwfdecLoadCachePending *pending)
+{
+  SwfdecLoadCachePrivate *priv = pending->cache->priv;
+
+  priv->pending = g_slist_remove (priv->pending, pending);
+  g_free (pending->key);
+  g_slice_free (SwfdecLoadCachePending, pending);
+}
+
+/* must be called with the mutex held */
+static void
+swfdec_load_cache_pending_detach (SwfdecLoadCachePending *pending)
+{
+  g_signal_handlers_disconnect_by_func (pending->loader, 
+      swfdec_load_cache_loader_complete, pending);
+  g_object_weak_unref (G_OBJECT (pending->loader), 
+      swfdec_load_cache_loader_gone, pending);
+  swfdec_load_cache_pending_free (pending);
+}
+
+static void
+swfdec_load_cache_loader_gone (gpointer pendingp, GObject *loader)
+{
+  SwfdecLoadCachePending *pending = pendingp;
+  GMutex *mutex = pending->cache->priv->mutex;
+
+  g_mutex_lock (mutex);
+  swfdec_load_cache_pending_free (pending);
+  g_mutex_unlock (mutex);
+}
+
+static void
+swfdec_load_cache_loader_complete (SwfdecLoader *loader, GParamSpec *pspec,
+    SwfdecLoadCachePending *pending)
+{
+  SwfdecLoadCache *cache = pending->cache;
+  SwfdecLoadCachePrivate *priv = cache->priv;
+  SwfdecLoadCacheEntry *entry;
+  SwfdecBufferQueue *recording;
+  GList *link;
+  gsize depth;
+
+  if (!swfdec_stream_is_complete (SWFDEC_STREAM (loader)))
+    return;
+
+  g_mutex_lock (priv->mutex);
+  recording = swfdec_stream_get_recording (SWFDEC_STREAM (loader));
+  depth = recording ? swfdec_buffer_queue_get_depth (recording) : 0;
+  if (pending->invalid || swfdec_loader_get_url (loader) == NULL ||
+      depth + strlen (pending->key) > priv->max_size) {
+    swfdec_load_cache_pending_detach (pending);
+    g_mutex_unlock (priv->mutex);
+    return;
+  }
+
+  link = g_hash_table_lookup (priv->lookup, pending->key);
+  if (link) {
+    entry = link->data;
+    g_queue_delete_link (priv->queue, link);
+    swfdec_load_cache_remove (cache, entry);
+  }
+
+  entry = g_slice_new0 (SwfdecLoadCacheEntry);
+  entry->key = pending->key;
+  pending->key = NULL;
+  entry->url = g_strdup (swfdec_url_get_url (swfdec_loader_get_url (loader)));
+  if (depth > 0)
+    entry->data = swfdec_buffer_queue_pull (recording, depth);
+  entry->size = depth + strlen (entry->key);
+  SWFDEC_LOG ("caching %zu bytes for %s", depth, entry->key);
+
+  swfdec_load_cache_pending_detach (pending);
+  swfdec_load_cache_shrink (cache, priv->max_size - entry->size);
+  g_queue_push_head (priv->queue, entry);
+  g_hash_table_insert (priv->lookup, entry->key, priv->queue->head);
+  priv->size += entry->size;
+  g_mutex_unlock (priv->mutex);
+  g_object_notify (G_OBJECT (cache), "size");
+}
+
+static void
+swfdec_load_cache_dispose (GObject *object)
+{
+  SwfdecLoadCache *cache = SWFDEC_LOAD_CACHE (object);
+  SwfdecLoadCachePrivate *priv = cache->priv;
+
+  g_mutex_lock (priv->mutex);
+  while (priv->pending)
+    swfdec_load_cache_pending_detach (priv->pending->data);
+  if (priv->queue) {
+    swfdec_load_cache_shrink (cache, 0);
+    g_queue_free (priv->queue);
+    priv->queue = NULL;
+  }
+  if (priv->lookup) {
+    g_hash_table_destroy (priv->lookup);
+    priv->lookup = NULL;
+  }
+  g_mutex_unlock (priv->mutex);
+
+  G_OBJECT_CLASS (swfdec_load_cache_parent_class)->dispose (object);
+}
+
+static void
+swfdec_load_cache_finalize (GObject *object)
+{
+  SwfdecLoadCache *cache = SWFDEC_LOAD_CACHE (object);
+
+  g_mutex_free (cache->priv->mutex);
+
+  G_OBJECT_CLASS (swfdec_load_cache_parent_class)->finalize (object);
+}
+
+static void
+swfdec_load_cache_get_property (GObject *object, guint param_id, GValue *value,
+    GParamSpec *pspec)
+{
+  SwfdecLoadCache *cache = SWFDEC_LOAD_CACHE (object);
+
+  switch (param_id) {
+    case PROP_SIZE:
+      g_value_set_ulong (value, swfdec_load_cache_get_size (cache));
+      break;
+    case PROP_MAX_SIZE:
+      g_value_set_ulong (value, swfdec_load_cache_get_max_size (cache));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
+      break;
+  }
+}
+
+static void
+swfdec_load_cache_set_property (GObject *object, guint param_id, const GValue *value,
+    GParamSpec *pspec)
+{
+  SwfdecLoadCache *cache = SWFDEC_LOAD_CACHE (object);
+
+  switch (param_id) {
+    case PROP_MAX_SIZE:
+      swfdec_load_cache_set_max_size (cache, g_value_get_ulong (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
+      break;
+  }
+}
+
+static void
+swfdec_load_cache_class_init (SwfdecLoadCacheClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (SwfdecLoadCachePrivate));
+
+  object_class->dispose = swfdec_load_cache_dispose;
+  object_class->finalize = swfdec_load_cache_finalize;
+  object_class->get_property = swfdec_load_cache_get_property;
+  object_class->set_property = swfdec_load_cache_set_property;
+
+  /* FIXME: should be g_param_spec_size(), but no such thing exists */
+  g_object_class_install_property (object_class, PROP_SIZE,
+      g_param_spec_ulong ("size", "size", "current size of all cached files",
+	  0, G_MAXULONG, 0, G_PARAM_READABLE));
+  g_object_class_install_property (object_class, PROP_MAX_SIZE,
+      g_param_spec_ulong ("max-size", "max-size", "maximum allowed size of all cached files",
+	  0, G_MAXULONG, 4 * 1024 * 1024, G_PARAM_READWRITE | G_PARAM_CONSTRUCT));
+}
+
+static void
+swfdec_load_cache_init (SwfdecLoadCache *cache)
+{
+  SwfdecLoadCachePrivate *priv;
+
+  cache->priv = priv = G_TYPE_INSTANCE_GET_PRIVATE (cache, SWFDEC_TYPE_LOAD_CACHE, SwfdecLoadCachePrivate);
+
+  priv->mutex = g_mutex_new ();
+  priv->queue = g_queue_new ();
+  priv->lookup = g_hash_table_new (g_str_hash, g_str_equal);
+}
+
+/*** INTERNAL API ***/
+
+/**
+ * swfdec_load_cache_lookup:
+ * @cache: a #SwfdecLoadCache
+ * @url: the absolute URL that is requested with a GET request
+ *
+ * Checks if the given request was cached. If so, a new loader is created that
+ * provides the cached data.
+ *
+ * Returns: a new loader providing the cached data or %NULL if the request
+ *          was not cached.
+ **/
+SwfdecLoader *
+swfdec_load_cache_lookup (SwfdecLoadCache *cache, const SwfdecURL *url)
+{
+  SwfdecLoadCachePrivate *priv;
+  SwfdecLoadCacheEntry *entry;
+  SwfdecLoader *loader;
+  SwfdecBuffer *data;
+  GList *link;
+  char *real_url;
+
+  g_return_val_if_fail (SWFDEC_IS_LOAD_CACHE (cache), NULL);
+  g_return_val_if_fail (url != NULL, NULL);
+
+  priv = cache->priv;
+  g_mutex_lock (priv->mutex);
+  link = g_hash_table_lookup (priv->lookup, swfdec_url_get_url (url));
+  if (link == NULL) {
+    priv->misses++;
+    g_mutex_unlock (priv->mutex);
+    return NULL;
+  }
+  priv->hits++;
+
+  /* move entry to the front of the queue */
+  entry = link->data;
+  g_queue_unlink (priv->queue, link);
+  g_queue_push_head_link (priv->queue, link);
+  /* the entry may be evicted by another thread once we release the mutex */
+  SWFDEC_LOG ("replaying cached data for %s", entry->key);
+  real_url = g_strdup (entry->url);
+  data = entry->data ? swfdec_buffer_ref (entry->data) : NULL;
+  g_mutex_unlock (priv->mutex);
+
+  loader = g_object_new (SWFDEC_TYPE_LOAD_CACHE_LOADER, NULL);
+  swfdec_loader_set_url (loader, real_url);
+  g_free (real_url);
+  swfdec_loader_set_size (loader, data ? data->length : 0);
+  swfdec_stream_open (SWFDEC_STREAM (loader));
+  if (data)
+    swfdec_stream_push (SWFDEC_STREAM (loader), data);
+  swfdec_stream_close (SWFDEC_STREAM (loader));
+
+  return loader;
+}
+
+/**
+ * swfdec_load_cache_watch:
+ * @cache: a #SwfdecLoadCache
+ * @loader: a new loader that has not started loading yet
+ * @url: the absolute URL that is requested with a GET request
+ *
+ * Makes @cache record all data provided by @loader, so it can be cached when
+ * @loader completes successfully.
+ **/
+void
+swfdec_load_cache_watch (SwfdecLoadCache *cache, SwfdecLoader *loader,
+    const SwfdecURL *url)
+{
+  SwfdecLoadCachePending *pending;
+
+  g_return_if_fail (SWFDEC_IS_LOAD_CACHE (cache));
+  g_return_if_fail (SWFDEC_IS_LOADER (loader));
+  g_return_if_fail (url != NULL);
+
+  pending = g_slice_new (SwfdecLoadCachePending);
+  pending->cache = cache;
+  pending->loader = loader;
+  pending->key = g_strdup (swfdec_url_get_url (url));
+  pending->invalid = FALSE;
+  g_mutex_lock (cache->priv->mutex);
+  cache->priv->pending = g_slist_prepend (cache->priv->pending, pending);
+  g_mutex_unlock (cache->priv->mutex);
+
+  swfdec_stream_record (SWFDEC_STREAM (loader));
+  g_signal_connect (loader, "notify::complete", 
+      G_CALLBACK (swfdec_load_cache_loader_complete), pending);
+  g_object_weak_ref (G_OBJECT (loader), swfdec_load_cache_loader_gone, pending);
+}
+
+/*** PUBLIC API ***/
+
+/**
+ * swfdec_load_cache_new:
+ * @max_size: maximum amount of bytes to keep in the cache
+ *
+ * Creates a new cache for loaded files.
+ *
+ * Returns: a new #SwfdecLoadCache
+ **/
+SwfdecLoadCache *
+swfdec_load_cache_new (gsize max_size)
+{
+  return g_object_new (SWFDEC_TYPE_LOAD_CACHE, "max-size", (gulong) max_size, NULL);
+}
+
+/**
+ * swfdec_load_cache_get_max_size:
+ * @cache: a #SwfdecLoadCache
+ *
+ * Queries the maximum amount of data @cache will keep.
+ *
+ * Returns: the maximum size of the cache in bytes
+ **/
+gsize
+swfdec_load_cache_get_max_size (SwfdecLoadCache *cache)
+{
+  gsize max_size;
+
+  g_return_val_if_fail (SWFDEC_IS_LOAD_CACHE (cache), 0);
+
+  g_mutex_lock (cache->priv->mutex);
+  max_size = cache->priv->max_size;
+  g_mutex_unlock (cache->priv->mutex);
+  return max_size;
+}
+
+/**
+ * swfdec_load_cache_set_max_size:
+ * @cache: a #SwfdecLoadCache
+ * @max_size: maximum amount of bytes to keep in the cache
+ *
+ * Sets the maximum amount of data @cache will keep. If more data is currently
+ * cached, the least recently used files will be dropped from the cache.
+ **/
+void
+swfdec_load_cache_set_max_size (SwfdecLoadCache *cache, gsize max_size)
+{
+  gboolean shrunk;
+
+  g_return_if_fail (SWFDEC_IS_LOAD_CACHE (cache));
+
+  g_mutex_lock (cache->priv->mutex);
+  cache->priv->max_size = max_size;
+  shrunk = swfdec_load_cache_shrink (cache, max_size);
+  g_mutex_unlock (cache->priv->mutex);
+  if (shrunk)
+    g_object_notify (G_OBJECT (cache), "size");
+  g_object_notify (G_OBJECT (cache), "max-size");
+}
+
+/**
+ * swfdec_load_cache_get_size:
+ * @cache: a #SwfdecLoadCache
+ *
+ * Queries the amount of data currently kept in @cache.
+ *
+ * Returns: the current size of the cache in bytes
+ **/
+gsize
+swfdec_load_cache_get_size (SwfdecLoadCache *cache)
+{
+  gsize size;
+
+  g_return_val_if_fail (SWFDEC_IS_LOAD_CACHE (cache), 0);
+
+  g_mutex_lock (cache->priv->mutex);
+  size = cache->priv->size;
+  g_mutex_unlock (cache->priv->mutex);
+  return size;
+}
+
+/**
+ * swfdec_load_cache_clear:
+ * @cache: a #SwfdecLoadCache
+ *
+ * Drops all cached files from @cache. Files that are currently loading will
+ * still be added to the cache once they complete. The statistics returned by
+ * swfdec_load_cache_get_stats() are not reset.
+ **/
+void
+swfdec_load_cache_clear (SwfdecLoadCache *cache)
+{
+  gboolean shrunk;
+
+  g_return_if_fail (SWFDEC_IS_LOAD_CACHE (cache));
+
+  g_mutex_lock (cache->priv->mutex);
+  shrunk = swfdec_load_cache_shrink (cache, 0);
+  g_mutex_unlock (cache->priv->mutex);
+  if (shrunk)
+    g_object_notify (G_OBJECT (cache), "size");
+}
+
+/**
+ * swfdec_load_cache_invalidate:
+ * @cache: a #SwfdecLoadCache
+ * @url: absolute URL of the file that changed
+ *
+ * Drops the file loaded from @url from @cache, so the next request for it 
+ * loads it again. Use this when you know that the file changed. If @url is
+ * currently loading, the result will not be cached.
+ *
+ * Returns: %TRUE if the file was cached or loading
+ **/
+gboolean
+swfdec_load_cache_invalidate (SwfdecLoadCache *cache, const char *url)
+{
+  SwfdecLoadCachePrivate *priv;
+  SwfdecURL *parsed;
+  gboolean removed = FALSE;
+  GSList *walk;
+  GList *link;
+
+  g_return_val_if_fail (SWFDEC_IS_LOAD_CACHE (cache), FALSE);
+  g_return_val_if_fail (url != NULL, FALSE);
+
+  parsed = swfdec_url_new (url);
+  if (parsed == NULL)
+    return FALSE;
+
+  priv = cache->priv;
+  g_mutex_lock (priv->mutex);
+  for (walk = priv->pending; walk; walk = walk->next) {
+    SwfdecLoadCachePending *pending = walk->data;
+    if (g_str_equal (pending->key, swfdec_url_get_url (parsed))) {
+      pending->invalid = TRUE;
+      removed = TRUE;
+    }
+  }
+  link = g_hash_table_lookup (priv->lookup, swfdec_url_get_url (parsed));
+  if (link) {
+    SwfdecLoadCacheEntry *entry = link->data;
+    g_queue_delete_link (priv->queue, link);
+    swfdec_load_cache_remove (cache, entry);
+  }
+  g_mutex_unlock (priv->mutex);
+  swfdec_url_free (parsed);
+
+  if (link)
+    g_object_notify (G_OBJECT (cache), "size");
+  return removed || link != NULL;
+}
+
+/**
+ * swfdec_load_cache_get_stats:
+ * @cache: a #SwfdecLoadCache
+ * @hits: %NULL or pointer to take the number of requests answered from the 
+ *        cache
+ * @misses: %NULL or pointer to take the number of requests that were not 
+ *          cached
+ *
+ * Queries how effective @cache is. The numbers are counted from the creation 
+ * of @cache on.
+ **/
+void
+swfdec_load_cache_get_stats (SwfdecLoadCache *cache, guint *hits, guint *misses)
+{
+  g_return_if_fail (SWFDEC_IS_LOAD_CACHE (cache));
+
+  g_mutex_lock (cache->priv->mutex);
+  if (hits)
+    *hits = cache->priv->hits;
+  if (misses)
+    *misses = cache->priv->misses;
+  g_mutex_unlock (cache->priv->mutex);
+}
@@ -0,0 +1,69 @@
+/* Swfdec
+ * Copyright (c) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, 
+ * Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef _SWFDEC_LOAD_CACHE_H_
+#define _SWFDEC_LOAD_CACHE_H_
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+typedef struct _SwfdecLoadCache SwfdecLoadCache;
+typedef struct _SwfdecLoadCachePrivate SwfdecLoadCachePrivate;
+typedef struct _SwfdecLoadCacheClass SwfdecLoadCacheClass;
+
+#define SWFDEC_TYPE_LOAD_CACHE                    (swfdec_load_cache_get_type())
+#define SWFDEC_IS_LOAD_CACHE(obj)                 (G_TYPE_CHECK_INSTANCE_TYPE ((obj), SWFDEC_TYPE_LOAD_CACHE))
+#define SWFDEC_IS_LOAD_CACHE_CLASS(klass)         (G_TYPE_CHECK_CLASS_TYPE ((klass), SWFDEC_TYPE_LOAD_CACHE))
+#define SWFDEC_LOAD_CACHE(obj)                    (G_TYPE_CHECK_INSTANCE_CAST ((obj), SWFDEC_TYPE_LOAD_CACHE, SwfdecLoadCache))
+#define SWFDEC_LOAD_CACHE_CLASS(klass)            (G_TYPE_CHECK_CLASS_CAST ((klass), SWFDEC_TYPE_LOAD_CACHE, SwfdecLoadCacheClass))
+#define SWFDEC_LOAD_CACHE_GET_CLASS(obj)          (G_TYPE_INSTANCE_GET_CLASS ((obj), SWFDEC_TYPE_LOAD_CACHE, SwfdecLoadCacheClass))
+
+struct _SwfdecLoadCache {
+  GObject		object;
+
+  /*< private >*/
+  SwfdecLoadCachePrivate *priv;
+};
+
+struct _SwfdecLoadCacheClass
+{
+  /*< private >*/
+  GObjectClass		object_class;
+};
+
+GType			swfdec_load_cache_get_type	(void);
+
+SwfdecLoadCache *	swfdec_load_cache_new		(gsize			max_size);
+
+gsize			swfdec_load_cache_get_max_size	(SwfdecLoadCache *	cache);
+void			swfdec_load_cache_set_max_size	(SwfdecLoadCache *	cache,
+							 gsize			max_size);
+gsize			swfdec_load_cache_get_size	(SwfdecLoadCache *	cache);
+void			swfdec_load_cache_clear		(SwfdecLoadCache *	cache);
+gboolean		swfdec_load_cache_invalidate	(SwfdecLoadCache *	cache,
+							 const char *		url);
+void			swfdec_load_cache_get_stats	(SwfdecLoadCache *	cache,
+							 guint *		hits,
+							 guint *		misses);
+
+
+G_END_DECLS
+#endif
@@ -32,6 +32,53 @@
 #include "swfdec_loader_internal.h"
 #include "swfdec_stream_target.h"
 #include "swfdec_player_internal.h"
+#include "swfdec_xml.h"
+
+/*** XML PARSING ***/
+
+/* push newly arrived data into the parser, decoded the same way
+ * swfdec_buffer_queue_pull_text() will decode it */
+static void
+swfdec_load_object_feed_parser (SwfdecLoadObject *load, SwfdecBufferQueue *queue,
+    gboolean complete)
+{
+  SwfdecBuffer *buffer;
+
+  if (load->encoding == NULL) {
+    guint skip;
+
+    /* wait until byte order marks can be detected */
+    if (!complete && swfdec_buffer_queue_get_depth (queue) < 3)
+      return;
+    load->encoding = swfdec_buffer_queue_peek_encoding (queue, load->version,
+	&skip);
+    load->parsed = skip;
+    if (strcmp (load->encoding, "UTF-8") != 0 &&
+	strcmp (load->encoding, "LATIN1") != 0) {
+      SWFDEC_INFO ("not parsing %s encoded XML while loading", load->encoding);
+      swfdec_xml_parser_free (load->parser);
+      load->parser = NULL;
+      return;
+    }
+  }
+
+  while ((buffer = swfdec_buffer_queue_peek_buffer_at (queue, load->parsed,
+	  &load->parsed_iter))) {
+    if (strcmp (load->encoding, "UTF-8") == 0) {
+      swfdec_xml_parser_push (load->parser, (char *) buffer->data,
+	  buffer->length);
+    } else {
+      gsize length;
+      char *text = g_convert ((char *) buffer->data, buffer->length, "UTF-8",
+	  load->encoding, NULL, &length, NULL);
+      if (text != NULL)
+	swfdec_xml_parser_push (load->parser, text, length);
+      g_free (text);
+    }
+    load->parsed += buffer->length;
+    swfdec_buffer_unref (buffer);
+  }
+}
 
 /*** SWFDEC_STREAM_TARGET ***/
 
@@ -48,6 +95,7 @@ swfdec_load_object_stream_target_parse (SwfdecStreamTarget *target,
   SwfdecLoader *loader = SWFDEC_LOADER (stream);
   SwfdecLoadObject *load_object = SWFDEC_LOAD_OBJECT (target);
   SwfdecPlayer *player = SWFDEC_PLAYER (swfdec_gc_object_get_context (target));
+  gboolean more = FALSE;
 
   if (load_object->progress != NULL) {
     swfdec_sandbox_use (load_object->sandbox);
@@ -55,7 +103,23 @@ swfdec_load_object_stream_target_parse (SwfdecStreamTarget *target,
 	swfdec_loader_get_loaded (loader), swfdec_loader_get_size (loader));
     swfdec_sandbox_unuse (load_object->sandbox);
   }
-  return FALSE;
+
+  /* the close handler parses what's left, don't delay it */
+  if (swfdec_stream_is_complete (stream))
+    return FALSE;
+
+  if (load_object->parser) {
+    swfdec_load_object_feed_parser (load_object, swfdec_stream_get_queue (stream),
+	FALSE);
+  }
+  /* parse what we have, but don't block for too long */
+  if (load_object->parser) {
+    guint budget = player->priv->xml_parse_budget;
+    swfdec_sandbox_use (load_object->sandbox);
+    more = swfdec_xml_parser_parse (load_object->parser, &budget);
+    swfdec_sandbox_unuse (load_object->sandbox);
+  }
+  return more;
 }
 
 static void
@@ -70,6 +134,10 @@ swfdec_load_object_stream_target_error (SwfdecStreamTarget *target,
   swfdec_stream_set_target (SWFDEC_STREAM (loader), NULL);
   load_object->loader = NULL;
   g_object_unref (loader);
+  if (load_object->parser) {
+    swfdec_xml_parser_free (load_object->parser);
+    load_object->parser = NULL;
+  }
 
   /* call finish */
   swfdec_sandbox_use (load_object->sandbox);
@@ -86,8 +154,14 @@ swfdec_load_object_stream_target_close (SwfdecStreamTarget *target,
 {
   SwfdecPlayer *player = SWFDEC_PLAYER (swfdec_gc_object_get_context (target));
   SwfdecLoadObject *load_object = SWFDEC_LOAD_OBJECT (target);
+  SwfdecXmlParser *parser;
   char *text;
 
+  if (load_object->parser)
+    swfdec_load_object_feed_parser (load_object, swfdec_stream_get_queue (stream), TRUE);
+  parser = load_object->parser;
+  load_object->parser = NULL;
+
   // get text
   text = swfdec_buffer_queue_pull_text (swfdec_stream_get_queue (stream), load_object->version);
 
@@ -98,12 +172,24 @@ swfdec_load_object_stream_target_close (SwfdecStreamTarget *target,
   /* call finish */
   swfdec_sandbox_use (load_object->sandbox);
   if (text != NULL) {
-    load_object->finish (player, &load_object->target, 
-	swfdec_as_context_give_string (SWFDEC_AS_CONTEXT (player), text));
+    const char *s = swfdec_as_context_give_string (SWFDEC_AS_CONTEXT (player), text);
+    if (parser) {
+      SwfdecXmlParser *old = player->priv->xml_parser;
+
+      /* let the default onData use what we parsed already */
+      swfdec_xml_parser_finish (parser, s);
+      player->priv->xml_parser = parser;
+      load_object->finish (player, &load_object->target, s);
+      player->priv->xml_parser = old;
+    } else {
+      load_object->finish (player, &load_object->target, s);
+    }
   } else {
     load_object->finish (player, &load_object->target, SWFDEC_AS_STR_EMPTY);
   }
   swfdec_sandbox_unuse (load_object->sandbox);
+  if (parser)
+    swfdec_xml_parser_free (parser);
 
   /* unroot */
   swfdec_player_unroot (player, load_object);
@@ -137,6 +223,10 @@ swfdec_load_object_dispose (GObject *object)
     swfdec_buffer_unref (load->buffer);
     load->buffer = NULL;
   }
+  if (load->parser) {
+    swfdec_xml_parser_free (load->parser);
+    load->parser = NULL;
+  }
   g_strfreev (load->header_names);
   g_strfreev (load->header_values);
 
@@ -179,6 +269,15 @@ swfdec_load_object_load (SwfdecPlayer *player, gboolean allow, gpointer obj)
       load->buffer, load->header_count, (const char **)load->header_names,
       (const char **)load->header_values);
 
+  /* XML gets parsed while loading */
+  if (SWFDEC_AS_VALUE_IS_OBJECT (load->target)) {
+    SwfdecAsObject *object = SWFDEC_AS_VALUE_GET_OBJECT (load->target);
+    if (SWFDEC_IS_XML (object->relay)) {
+      load->parser = swfdec_xml_parser_new (SWFDEC_AS_CONTEXT (player),
+	  SWFDEC_XML (object->relay)->ignore_white);
+    }
+  }
+
   swfdec_stream_set_target (SWFDEC_STREAM (load->loader), SWFDEC_STREAM_TARGET (load));
   swfdec_loader_set_data_type (load->loader, SWFDEC_LOADER_DATA_TEXT);
 }
@@ -212,6 +311,8 @@ swfdec_load_object_mark (gpointer object, gpointer player)
   swfdec_gc_object_mark (load->sandbox);
   if (load->url)
     swfdec_as_string_mark (load->url);
+  if (load->parser)
+    swfdec_xml_parser_mark (load->parser);
   swfdec_as_value_mark (&load->target);
 }
 
@@ -23,6 +23,7 @@
 
 #include <swfdec/swfdec.h>
 #include <swfdec/swfdec_as_object.h>
+#include <swfdec/swfdec_internal.h>
 #include <swfdec/swfdec_resource.h>
 
 G_BEGIN_DECLS
@@ -52,6 +53,10 @@ struct _SwfdecLoadObject {
   char **			header_names;	/* names of headers */
   char **			header_values;	/* values of headers */
   SwfdecLoader *		loader;		/* loader when loading or NULL */
+  SwfdecXmlParser *		parser;		/* parser for XML targets or NULL */
+  const char *			encoding;	/* encoding of the loaded text or NULL if unknown yet */
+  gsize				parsed;		/* bytes of the loaded data pushed into parser */
+  SwfdecBufferQueueIter		parsed_iter;	/* position of parsed in the loaded data */
 
   SwfdecSandbox *		sandbox;	/* sandbox that inited the loading */
   guint				version;	/* version used when initiating the load - for parsing the data */
@@ -21,6 +21,7 @@
 #define _SWFDEC_LOADER_INTERNAL_H_
 
 #include "swfdec_loader.h"
+#include "swfdec_load_cache.h"
 #include "swfdec_stream_target.h"
 
 G_BEGIN_DECLS
@@ -31,11 +32,20 @@ const char *		swfdec_stream_describe		(SwfdecStream *		stream);
 void			swfdec_stream_ensure_closed	(SwfdecStream *		stream);
 void			swfdec_stream_set_target	(SwfdecStream *		stream,
 							 SwfdecStreamTarget *	target);
+void			swfdec_stream_record		(SwfdecStream *		stream);
+SwfdecBufferQueue *	swfdec_stream_get_recording	(SwfdecStream *		stream);
 
 /* swfdec_loader.c */
 void			swfdec_loader_set_data_type	(SwfdecLoader *		loader,
 							 SwfdecLoaderDataType	type);
 
+/* swfdec_load_cache.c */
+SwfdecLoader *		swfdec_load_cache_lookup	(SwfdecLoadCache *	cache,
+							 const SwfdecURL *	url);
+void			swfdec_load_cache_watch		(SwfdecLoadCache *	cache,
+							 SwfdecLoader *		loader,
+							 const SwfdecURL *	url);
+
 /* swfdec_socket.c */
 gsize			swfdec_socket_send		(SwfdecSocket *		sock,
 							 SwfdecBuffer *		buffer);
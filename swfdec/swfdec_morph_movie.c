@@ -54,19 +54,6 @@ swfdec_morph_movie_set_ratio (SwfdecMovie *movie)
   swfdec_movie_queue_update (movie, SWFDEC_MOVIE_INVALID_EXTENTS);
 }
 
-static void
-swfdec_morph_movie_create_morphs (SwfdecMorphMovie *mmovie)
-{
-  SwfdecShape *shape = SWFDEC_SHAPE (SWFDEC_MOVIE (mmovie)->graphic);
-  guint ratio = SWFDEC_MOVIE (mmovie)->original_ratio;
-  GSList *walk;
-
-  for (walk = shape->draws; walk; walk = walk->next) {
-    mmovie->draws = g_slist_prepend (mmovie->draws, swfdec_draw_morph (walk->data, ratio));
-  }
-  mmovie->draws = g_slist_reverse (mmovie->draws);
-}
-
 static void
 swfdec_morph_movie_render (SwfdecMovie *movie, cairo_t *cr, 
     const SwfdecColorTransform *trans)
@@ -75,8 +62,10 @@ swfdec_morph_movie_render (SwfdecMovie *movie, cairo_t *cr,
   SwfdecRect inval;
   GSList *walk;
 
-  if (morph->draws == NULL)
-    swfdec_morph_movie_create_morphs (morph);
+  if (morph->draws == NULL) {
+    morph->draws = swfdec_morph_shape_get_draws (
+	SWFDEC_MORPH_SHAPE (movie->graphic), movie->original_ratio);
+  }
 
   cairo_clip_extents (cr, &inval.x0, &inval.y0, &inval.x1, &inval.y1);
 
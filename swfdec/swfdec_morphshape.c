@@ -25,23 +25,179 @@
 
 #include "swfdec_morphshape.h"
 #include "swfdec_debug.h"
+#include "swfdec_draw.h"
 #include "swfdec_image.h"
 #include "swfdec_morph_movie.h"
 #include "swfdec_shape_parser.h"
 
 G_DEFINE_TYPE (SwfdecMorphShape, swfdec_morph_shape, SWFDEC_TYPE_SHAPE)
 
+/* morph shapes may be shared between players running in different threads,
+ * so this lock protects the ratios of all morph shapes and the list below */
+G_LOCK_DEFINE_STATIC (ratios);
+/* all cached ratios of all morph shapes, most recently used first */
+static GQueue all_ratios = G_QUEUE_INIT;
+/* sum of the sizes of all_ratios */
+static gsize all_ratios_size = 0;
+
+static void
+swfdec_morph_shape_ratio_free (SwfdecMorphShapeRatio *ratio)
+{
+  g_slist_foreach (ratio->draws, (GFunc) g_object_unref, NULL);
+  g_slist_free (ratio->draws);
+  g_slice_free (SwfdecMorphShapeRatio, ratio);
+}
+
+/* must be called with the lock held */
+static void
+swfdec_morph_shape_ratio_remove (SwfdecMorphShapeRatio *ratio)
+{
+  g_hash_table_remove (ratio->morph->ratios, GUINT_TO_POINTER (ratio->ratio));
+  ratio->morph->ratios_size -= ratio->size;
+  g_queue_delete_link (&all_ratios, ratio->link);
+  all_ratios_size -= ratio->size;
+}
+
+static gboolean
+swfdec_morph_shape_ratio_collect (gpointer key, gpointer value, gpointer listp)
+{
+  GSList **list = listp;
+  SwfdecMorphShapeRatio *ratio = value;
+
+  g_queue_delete_link (&all_ratios, ratio->link);
+  all_ratios_size -= ratio->size;
+  *list = g_slist_prepend (*list, ratio);
+  return TRUE;
+}
+
+static void
+swfdec_morph_shape_dispose (GObject *object)
+{
+  SwfdecMorphShape *morph = SWFDEC_MORPH_SHAPE (object);
+  GSList *removed = NULL;
+
+  if (morph->ratios) {
+    G_LOCK (ratios);
+    g_hash_table_foreach_remove (morph->ratios, 
+	swfdec_morph_shape_ratio_collect, &removed);
+    G_UNLOCK (ratios);
+    g_slist_foreach (removed, (GFunc) swfdec_morph_shape_ratio_free, NULL);
+    g_slist_free (removed);
+    g_hash_table_destroy (morph->ratios);
+    morph->ratios = NULL;
+    morph->ratios_size = 0;
+  }
+
+  G_OBJECT_CLASS (swfdec_morph_shape_parent_class)->dispose (object);
+}
+
 static void
 swfdec_morph_shape_class_init (SwfdecMorphShapeClass * g_class)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (g_class);
   SwfdecGraphicClass *graphic_class = SWFDEC_GRAPHIC_CLASS (g_class);
   
+  object_class->dispose = swfdec_morph_shape_dispose;
+
   graphic_class->movie_type = SWFDEC_TYPE_MORPH_MOVIE;
 }
 
 static void
 swfdec_morph_shape_init (SwfdecMorphShape * morph)
 {
+  morph->ratios = g_hash_table_new (g_direct_hash, g_direct_equal);
+}
+
+/**
+ * swfdec_morph_shape_get_draws:
+ * @morph: a morph shape
+ * @ratio: ratio of the morph from 0 to 65535
+ *
+ * Gets the drawing operations of @morph morphed to @ratio. The morphs of 
+ * ratios are kept around, so tweens that loop or morph movies that share a 
+ * shape don't need to morph again. A morph shape keeps the ratios it morphs
+ * first until they use %SWFDEC_MORPH_SHAPE_MAX_SIZE bytes, so tweens with
+ * more ratios than that don't evict the ratios they'll need again. The 
+ * memory used by all morph shapes of the process is limited to 
+ * %SWFDEC_MORPH_SHAPE_CACHE_SIZE by evicting the ratios of the morph shapes
+ * that were used least recently.
+ *
+ * Returns: a new list of references to the morphed drawing operations. Free
+ *          it with g_slist_free() after unreffing all elements.
+ **/
+GSList *
+swfdec_morph_shape_get_draws (SwfdecMorphShape *morph, guint ratio)
+{
+  SwfdecMorphShapeRatio *cache;
+  GSList *walk, *ret, *removed;
+  GList *list, *prev;
+
+  g_return_val_if_fail (SWFDEC_IS_MORPH_SHAPE (morph), NULL);
+  g_return_val_if_fail (ratio < 65536, NULL);
+
+  G_LOCK (ratios);
+  cache = g_hash_table_lookup (morph->ratios, GUINT_TO_POINTER (ratio));
+  if (cache) {
+    if (cache->link != all_ratios.head) {
+      g_queue_unlink (&all_ratios, cache->link);
+      g_queue_push_head_link (&all_ratios, cache->link);
+    }
+    ret = g_slist_copy (cache->draws);
+    g_slist_foreach (ret, (GFunc) g_object_ref, NULL);
+    G_UNLOCK (ratios);
+    return ret;
+  }
+  G_UNLOCK (ratios);
+
+  /* morph without holding the lock, other threads may want other ratios */
+  cache = g_slice_new (SwfdecMorphShapeRatio);
+  cache->morph = morph;
+  cache->ratio = ratio;
+  cache->draws = NULL;
+  cache->size = sizeof (SwfdecMorphShapeRatio);
+  for (walk = SWFDEC_SHAPE (morph)->draws; walk; walk = walk->next) {
+    SwfdecDraw *draw = swfdec_draw_morph (walk->data, ratio);
+    cache->draws = g_slist_prepend (cache->draws, draw);
+    cache->size += sizeof (SwfdecDraw) + draw->path.num_data * sizeof (cairo_path_data_t);
+  }
+  cache->draws = g_slist_reverse (cache->draws);
+  ret = g_slist_copy (cache->draws);
+  g_slist_foreach (ret, (GFunc) g_object_ref, NULL);
+
+  removed = NULL;
+  G_LOCK (ratios);
+  /* Don't evict our own ratios for new ones. Tweens loop, so evicting the 
+   * least recently used ratio would evict the one that's needed next. */
+  if (g_hash_table_lookup (morph->ratios, GUINT_TO_POINTER (ratio)) ||
+      morph->ratios_size + cache->size > SWFDEC_MORPH_SHAPE_MAX_SIZE) {
+    removed = g_slist_prepend (removed, cache);
+  } else {
+    /* make room by evicting ratios of other morph shapes */
+    for (list = all_ratios.tail; list && 
+	all_ratios_size + cache->size > SWFDEC_MORPH_SHAPE_CACHE_SIZE; list = prev) {
+      SwfdecMorphShapeRatio *old = list->data;
+      prev = list->prev;
+      if (old->morph == morph)
+	continue;
+      swfdec_morph_shape_ratio_remove (old);
+      removed = g_slist_prepend (removed, old);
+    }
+    if (all_ratios_size + cache->size > SWFDEC_MORPH_SHAPE_CACHE_SIZE) {
+      removed = g_slist_prepend (removed, cache);
+    } else {
+      g_hash_table_insert (morph->ratios, GUINT_TO_POINTER (ratio), cache);
+      morph->ratios_size += cache->size;
+      g_queue_push_head (&all_ratios, cache);
+      cache->link = all_ratios.head;
+      all_ratios_size += cache->size;
+    }
+  }
+  G_UNLOCK (ratios);
+  /* freeing disposes objects, don't do that while holding the lock */
+  g_slist_foreach (removed, (GFunc) swfdec_morph_shape_ratio_free, NULL);
+  g_slist_free (removed);
+
+  return ret;
 }
 
 
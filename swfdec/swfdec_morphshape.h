@@ -26,6 +26,7 @@ G_BEGIN_DECLS
 
 typedef struct _SwfdecMorphShape SwfdecMorphShape;
 typedef struct _SwfdecMorphShapeClass SwfdecMorphShapeClass;
+typedef struct _SwfdecMorphShapeRatio SwfdecMorphShapeRatio;
 
 #define SWFDEC_TYPE_MORPH_SHAPE                    (swfdec_morph_shape_get_type())
 #define SWFDEC_IS_MORPH_SHAPE(obj)                 (G_TYPE_CHECK_INSTANCE_TYPE ((obj), SWFDEC_TYPE_MORPH_SHAPE))
@@ -33,10 +34,25 @@ typedef struct _SwfdecMorphShapeClass SwfdecMorphShapeClass;
 #define SWFDEC_MORPH_SHAPE(obj)                    (G_TYPE_CHECK_INSTANCE_CAST ((obj), SWFDEC_TYPE_MORPH_SHAPE, SwfdecMorphShape))
 #define SWFDEC_MORPH_SHAPE_CLASS(klass)            (G_TYPE_CHECK_CLASS_CAST ((klass), SWFDEC_TYPE_MORPH_SHAPE, SwfdecMorphShapeClass))
 
+/* bytes of morphed drawing operations kept for all morph shapes together */
+#define SWFDEC_MORPH_SHAPE_CACHE_SIZE (4 * 1024 * 1024)
+/* bytes of morphed drawing operations kept for one morph shape */
+#define SWFDEC_MORPH_SHAPE_MAX_SIZE (SWFDEC_MORPH_SHAPE_CACHE_SIZE / 4)
+
+struct _SwfdecMorphShapeRatio {
+  SwfdecMorphShape *	morph;		/* the morph shape this ratio belongs to */
+  guint			ratio;		/* the ratio */
+  GSList *		draws;		/* the drawing operations morphed to ratio */
+  gsize			size;		/* approximate memory used by draws */
+  GList *		link;		/* link in the list of all cached ratios */
+};
+
 struct _SwfdecMorphShape {
   SwfdecShape		shape;
 
   SwfdecRect		end_extents;	/* extents at end of morph (compare with graphic->extents for start) */
+  GHashTable *		ratios;		/* ratio => SwfdecMorphShapeRatio */
+  gsize			ratios_size;	/* sum of the sizes of ratios */
 };
 
 struct _SwfdecMorphShapeClass {
@@ -45,6 +61,9 @@ struct _SwfdecMorphShapeClass {
 
 GType	swfdec_morph_shape_get_type	(void);
 
+GSList *swfdec_morph_shape_get_draws	(SwfdecMorphShape *	morph,
+					 guint			ratio);
+
 int	tag_define_morph_shape		(SwfdecSwfDecoder *	s,
 					 guint			tag);
 
@@ -255,11 +255,65 @@ swfdec_movie_end_update_matrix (SwfdecMovie *movie)
     d = movie->rotation - swfdec_matrix_get_rotation (&movie->original_transform);
     cairo_matrix_rotate (&movie->matrix, d * G_PI / 180);
   }
+  swfdec_movie_matrix_changed (movie);
+}
+
+/**
+ * swfdec_movie_matrix_changed:
+ * @movie: a #SwfdecMovie
+ *
+ * Updates everything that depends on @movie's matrix after it has been 
+ * modified. This includes the inverse matrix and the cached global matrices
+ * of @movie and all its children.
+ **/
+void
+swfdec_movie_matrix_changed (SwfdecMovie *movie)
+{
+  SwfdecPlayerPrivate *priv;
+
+  g_return_if_fail (SWFDEC_IS_MOVIE (movie));
+
+  priv = SWFDEC_PLAYER (swfdec_gc_object_get_context (movie))->priv;
   swfdec_matrix_ensure_invertible (&movie->matrix, &movie->inverse_matrix);
+  movie->matrix_generation = ++priv->matrix_generation;
 
   g_signal_emit (movie, signals[MATRIX_CHANGED], 0);
 }
 
+/* Computing global matrices requires multiplying the matrices of all parents,
+ * which gets expensive for deep hierarchies. So they are cached. Whenever a
+ * matrix changes, the player's generation is incremented. Cached matrices 
+ * that were verified in the current generation are up to date. Otherwise they
+ * are only recomputed if the movie's matrix or the parent's global matrix 
+ * changed since they were last verified. */
+static void
+swfdec_movie_update_global_matrix (SwfdecMovie *movie)
+{
+  guint64 generation = SWFDEC_PLAYER (swfdec_gc_object_get_context (movie))->priv->matrix_generation;
+
+  if (movie->global_generation == generation)
+    return;
+
+  if (movie->parent) {
+    swfdec_movie_update_global_matrix (movie->parent);
+    if (movie->global_generation == 0 ||
+	movie->matrix_generation > movie->global_generation ||
+	movie->parent->global_changed > movie->global_generation) {
+      cairo_matrix_multiply (&movie->global_matrix, &movie->matrix, 
+	  &movie->parent->global_matrix);
+      cairo_matrix_multiply (&movie->global_inverse_matrix, 
+	  &movie->parent->global_inverse_matrix, &movie->inverse_matrix);
+      movie->global_changed = generation;
+    }
+  } else if (movie->global_generation == 0 ||
+      movie->matrix_generation > movie->global_generation) {
+    movie->global_matrix = movie->matrix;
+    movie->global_inverse_matrix = movie->inverse_matrix;
+    movie->global_changed = generation;
+  }
+  movie->global_generation = generation;
+}
+
 static void
 swfdec_movie_do_update (SwfdecMovie *movie)
 {
@@ -308,13 +362,132 @@ swfdec_movie_update (SwfdecMovie *movie)
   }
 }
 
+/*** CHILD INDEX ***/
+
+/* Movies can contain thousands of children and scanning the list of children
+ * on every path lookup is too slow. So every movie keeps hash tables that map
+ * depths and names to the children using them. As multiple children can share
+ * a depth or a name, the tables contain lists of children. The key of an entry
+ * is always taken from the first child in the list, so it stays valid even when
+ * the string is not otherwise referenced anymore.
+ * Names are indexed case-insensitively, lookups then filter the candidates 
+ * depending on the version. */
+
+typedef gpointer (* SwfdecMovieIndexKeyFunc) (SwfdecMovie *movie);
+
+static gpointer
+swfdec_movie_index_depth_key (SwfdecMovie *movie)
+{
+  return GINT_TO_POINTER (movie->depth);
+}
+
+static gpointer
+swfdec_movie_index_name_key (SwfdecMovie *movie)
+{
+  if (movie->name != SWFDEC_AS_STR_EMPTY)
+    return (gpointer) movie->name;
+  /* unnamed movies can be found by their generated name */
+  if (movie->as_value)
+    return (gpointer) movie->as_value->names[movie->as_value->n_names - 1];
+  return NULL;
+}
+
+static void
+swfdec_movie_index_add (GHashTable *table, SwfdecMovieIndexKeyFunc func, 
+    SwfdecMovie *child)
+{
+  gpointer key = func (child);
+  GSList *list;
+
+  list = g_hash_table_lookup (table, key);
+  g_hash_table_replace (table, key, g_slist_prepend (list, child));
+}
+
+static gboolean
+swfdec_movie_index_remove (GHashTable *table, SwfdecMovieIndexKeyFunc func,
+    SwfdecMovie *child)
+{
+  gpointer key = func (child);
+  GSList *list, *found;
+
+  list = g_hash_table_lookup (table, key);
+  found = g_slist_find (list, child);
+  if (found == NULL)
+    return FALSE;
+  list = g_slist_delete_link (list, found);
+  if (list) {
+    g_hash_table_replace (table, func (list->data), list);
+  } else {
+    g_hash_table_remove (table, key);
+  }
+  return TRUE;
+}
+
+/**
+ * swfdec_movie_index_child:
+ * @movie: a #SwfdecMovie
+ * @child: a child movie contained in @movie's list of children
+ *
+ * Adds @child to the indexes used for looking up children of @movie. This 
+ * needs to be done whenever a child is added to the list of children.
+ **/
+void
+swfdec_movie_index_child (SwfdecMovie *movie, SwfdecMovie *child)
+{
+  g_return_if_fail (SWFDEC_IS_MOVIE (movie));
+  g_return_if_fail (SWFDEC_IS_MOVIE (child));
+
+  if (movie->depths == NULL) {
+    movie->depths = g_hash_table_new (g_direct_hash, g_direct_equal);
+    movie->names = g_hash_table_new (swfdec_str_case_hash, swfdec_str_case_equal);
+  }
+  swfdec_movie_index_add (movie->depths, swfdec_movie_index_depth_key, child);
+  if (swfdec_movie_index_name_key (child))
+    swfdec_movie_index_add (movie->names, swfdec_movie_index_name_key, child);
+}
+
+/**
+ * swfdec_movie_unindex_child:
+ * @movie: a #SwfdecMovie
+ * @child: a child movie of @movie
+ *
+ * Removes @child from the indexes used for looking up children of @movie. 
+ * This must be done before the child is removed from the list of children or
+ * its depth or name are changed.
+ *
+ * Returns: %TRUE if the child was indexed
+ **/
+gboolean
+swfdec_movie_unindex_child (SwfdecMovie *movie, SwfdecMovie *child)
+{
+  g_return_val_if_fail (SWFDEC_IS_MOVIE (movie), FALSE);
+  g_return_val_if_fail (SWFDEC_IS_MOVIE (child), FALSE);
+
+  if (movie->depths == NULL ||
+      !swfdec_movie_index_remove (movie->depths, swfdec_movie_index_depth_key, child))
+    return FALSE;
+  if (swfdec_movie_index_name_key (child))
+    swfdec_movie_index_remove (movie->names, swfdec_movie_index_name_key, child);
+  return TRUE;
+}
+
 SwfdecMovie *
 swfdec_movie_find (SwfdecMovie *movie, int depth)
 {
   GList *walk;
+  GSList *found;
 
   g_return_val_if_fail (SWFDEC_IS_MOVIE (movie), NULL);
 
+  if (movie->depths == NULL)
+    return NULL;
+  found = g_hash_table_lookup (movie->depths, GINT_TO_POINTER (depth));
+  if (found == NULL)
+    return NULL;
+  if (found->next == NULL)
+    return found->data;
+
+  /* multiple movies at the same depth, return the first one in the list */
   for (walk = movie->list; walk; walk = walk->next) {
     SwfdecMovie *cur= walk->data;
 
@@ -370,6 +543,8 @@ swfdec_movie_do_remove (SwfdecMovie *movie, gboolean destroy)
   if (SWFDEC_IS_ACTOR (movie)) {
     SwfdecActor *actor = SWFDEC_ACTOR (movie);
     swfdec_movie_unset_actor (player, actor);
+    /* removed movies get destroyed by iterating */
+    swfdec_actor_activate (actor);
     if ((actor->events && 
 	  swfdec_event_list_has_conditions (actor->events, SWFDEC_EVENT_UNLOAD, 0)) ||
 	swfdec_as_object_has_variable (swfdec_as_relay_get_as_object (SWFDEC_AS_RELAY (movie)), SWFDEC_AS_STR_onUnload)) {
@@ -423,6 +598,7 @@ swfdec_movie_destroy (SwfdecMovie *movie)
     swfdec_movie_destroy (movie->list->data);
   }
   if (movie->parent) {
+    swfdec_movie_unindex_child (movie->parent, movie);
     movie->parent->list = g_list_remove (movie->parent->list, movie);
   } else {
     player->priv->roots = g_list_remove (player->priv->roots, movie);
@@ -441,6 +617,8 @@ swfdec_movie_destroy (SwfdecMovie *movie)
   if (klass->finish_movie)
     klass->finish_movie (movie);
   player->priv->actors = g_list_remove (player->priv->actors, movie);
+  if (SWFDEC_IS_ACTOR (movie))
+    swfdec_actor_deactivate (SWFDEC_ACTOR (movie));
   if (movie->invalidate_last)
     player->priv->invalid_pending = g_slist_remove (player->priv->invalid_pending, movie);
   movie->state = SWFDEC_MOVIE_STATE_DESTROYED;
@@ -458,6 +636,10 @@ swfdec_movie_get_version (SwfdecMovie *movie)
   return movie->resource->version;
 }
 
+/* The point and rectangle conversions are used by scripts (localToGlobal, 
+ * globalToLocal, hitTest, getBounds, the mouse position) which truncate the 
+ * result to twips. So they transform level by level like Flash does instead
+ * of using the cached global matrices, which round differently. */
 void
 swfdec_movie_local_to_global (SwfdecMovie *movie, double *x, double *y)
 {
@@ -478,7 +660,10 @@ swfdec_movie_rect_local_to_global (SwfdecMovie *movie, SwfdecRect *rect)
   g_return_if_fail (SWFDEC_IS_MOVIE (movie));
   g_return_if_fail (rect != NULL);
 
-  swfdec_movie_local_to_global_matrix (movie, &matrix);
+  cairo_matrix_init_identity (&matrix);
+  do {
+    cairo_matrix_multiply (&matrix, &matrix, &movie->matrix);
+  } while ((movie = movie->parent));
   swfdec_rect_transform (rect, rect, &matrix);
 }
 
@@ -488,11 +673,8 @@ swfdec_movie_global_to_local_matrix (SwfdecMovie *movie, cairo_matrix_t *matrix)
   g_return_if_fail (SWFDEC_IS_MOVIE (movie));
   g_return_if_fail (matrix != NULL);
 
-  cairo_matrix_init_identity (matrix);
-  while (movie) {
-    cairo_matrix_multiply (matrix, &movie->inverse_matrix, matrix);
-    movie = movie->parent;
-  }
+  swfdec_movie_update_global_matrix (movie);
+  *matrix = movie->global_inverse_matrix;
 }
 
 void
@@ -501,11 +683,8 @@ swfdec_movie_local_to_global_matrix (SwfdecMovie *movie, cairo_matrix_t *matrix)
   g_return_if_fail (SWFDEC_IS_MOVIE (movie));
   g_return_if_fail (matrix != NULL);
 
-  cairo_matrix_init_identity (matrix);
-  while (movie) {
-    cairo_matrix_multiply (matrix, matrix, &movie->matrix);
-    movie = movie->parent;
-  }
+  swfdec_movie_update_global_matrix (movie);
+  *matrix = movie->global_matrix;
 }
 
 void
@@ -994,6 +1173,13 @@ swfdec_movie_dispose (GObject *object)
   g_assert (movie->list == NULL);
 
   SWFDEC_LOG ("disposing movie %s (depth %d)", movie->name, movie->depth);
+  if (movie->depths) {
+    g_assert (g_hash_table_size (movie->depths) == 0);
+    g_hash_table_destroy (movie->depths);
+    movie->depths = NULL;
+    g_hash_table_destroy (movie->names);
+    movie->names = NULL;
+  }
   if (movie->graphic) {
     g_object_unref (movie->graphic);
     movie->graphic = NULL;
@@ -1058,11 +1244,25 @@ swfdec_movie_is_scriptable (SwfdecMovie *movie)
    (swfdec_movie_get_version (movie) > 5 || !SWFDEC_IS_TEXT_FIELD_MOVIE (movie));
 }
 
-/* FIXME: This function can definitely be implemented easier */
+/* checks if @cur is the child that swfdec_movie_get_by_name() is looking for */
+static gboolean
+swfdec_movie_matches_name (SwfdecMovie *cur, const char *name, 
+    gboolean unnamed, guint version)
+{
+  if (swfdec_strcmp (version, cur->name, name) == 0)
+    return TRUE;
+  if (unnamed && cur->name == SWFDEC_AS_STR_EMPTY && cur->as_value &&
+      swfdec_strcmp (version, cur->as_value->names[cur->as_value->n_names - 1], name) == 0)
+    return TRUE;
+  return FALSE;
+}
+
 SwfdecMovie *
 swfdec_movie_get_by_name (SwfdecMovie *movie, const char *name, gboolean unnamed)
 {
   GList *walk;
+  GSList *candidates, *iter;
+  SwfdecMovie *found;
   int i;
   guint version = swfdec_gc_object_get_context (movie)->version;
   SwfdecPlayer *player = SWFDEC_PLAYER (swfdec_gc_object_get_context (movie));
@@ -1074,22 +1274,32 @@ swfdec_movie_get_by_name (SwfdecMovie *movie, const char *name, gboolean unnamed
   if (i >= 0)
     return SWFDEC_MOVIE (swfdec_player_get_movie_at_level (player, i));
 
-  for (walk = movie->list; walk; walk = walk->next) {
-    SwfdecMovie *cur = walk->data;
-    if (swfdec_strcmp (version, cur->name, name) == 0) {
-      if (swfdec_movie_is_scriptable (cur))
-	return cur;
-      else
-	return movie;
-    }
-    if (unnamed && cur->name == SWFDEC_AS_STR_EMPTY && cur->as_value) {
-      if (swfdec_strcmp (version, cur->as_value->names[cur->as_value->n_names - 1], name) == 0) {
-	/* unnamed movies are always scriptable */
-	return cur;
+  if (movie->names == NULL)
+    return NULL;
+  candidates = g_hash_table_lookup (movie->names, name);
+  found = NULL;
+  for (iter = candidates; iter; iter = iter->next) {
+    if (!swfdec_movie_matches_name (iter->data, name, unnamed, version))
+      continue;
+    if (found) {
+      /* multiple matches, the first one in the list wins */
+      found = NULL;
+      for (walk = movie->list; walk; walk = walk->next) {
+	if (swfdec_movie_matches_name (walk->data, name, unnamed, version)) {
+	  found = walk->data;
+	  break;
+	}
       }
+      break;
     }
+    found = iter->data;
   }
-  return NULL;
+  if (found == NULL)
+    return NULL;
+  /* unnamed movies are always scriptable */
+  if (found->name != SWFDEC_AS_STR_EMPTY && !swfdec_movie_is_scriptable (found))
+    return movie;
+  return found;
 }
 
 SwfdecMovie *
@@ -1337,6 +1547,9 @@ swfdec_movie_constructor (GType type, guint n_construct_properties,
   }
   if (name != SWFDEC_AS_STR_EMPTY)
     movie->as_value = swfdec_as_movie_value_new (movie, name);
+  /* now that the name is known, make the movie findable */
+  if (movie->parent)
+    swfdec_movie_index_child (movie->parent, movie);
 
   /* make the resource ours if it doesn't belong to anyone yet */
   if (SWFDEC_AS_VALUE_IS_UNDEFINED (movie->resource->movie)) {
@@ -1419,16 +1632,44 @@ swfdec_movie_set_depth (SwfdecMovie *movie, int depth)
     return;
 
   swfdec_movie_invalidate_last (movie);
-  movie->depth = depth;
   if (movie->parent) {
+    gboolean indexed = swfdec_movie_unindex_child (movie->parent, movie);
+    movie->depth = depth;
+    if (indexed)
+      swfdec_movie_index_child (movie->parent, movie);
     movie->parent->list = g_list_sort (movie->parent->list, swfdec_movie_compare_depths);
   } else {
     SwfdecPlayerPrivate *player = SWFDEC_PLAYER (swfdec_gc_object_get_context (movie))->priv;
+    movie->depth = depth;
     player->roots = g_list_sort (player->roots, swfdec_movie_compare_depths);
   }
   g_object_notify (G_OBJECT (movie), "depth");
 }
 
+/**
+ * swfdec_movie_set_name:
+ * @movie: a #SwfdecMovie
+ * @name: the new garbage-collected name of the movie
+ *
+ * Renames @movie, keeping the parent able to find it by its new name.
+ **/
+void
+swfdec_movie_set_name (SwfdecMovie *movie, const char *name)
+{
+  gboolean indexed;
+
+  g_return_if_fail (SWFDEC_IS_MOVIE (movie));
+  g_return_if_fail (name != NULL);
+
+  if (movie->name == name)
+    return;
+
+  indexed = movie->parent && swfdec_movie_unindex_child (movie->parent, movie);
+  movie->name = name;
+  if (indexed)
+    swfdec_movie_index_child (movie->parent, movie);
+}
+
 /**
  * swfdec_movie_new:
  * @player: a #SwfdecPlayer
@@ -1529,6 +1770,7 @@ swfdec_movie_set_static_properties (SwfdecMovie *movie, const cairo_matrix_t *tr
       if (actor->events)
 	swfdec_event_list_free (actor->events);
       actor->events = swfdec_event_list_copy (events);
+      swfdec_actor_activate (actor);
     } else {
       SWFDEC_WARNING ("trying to set events on a %s, not allowed", G_OBJECT_TYPE_NAME (movie));
     }
@@ -124,6 +124,8 @@ struct _SwfdecMovie {
   SwfdecGraphic *	graphic;		/* graphic represented by this movie or NULL if script-created */
   const char *		name;		/* name of movie - GC'd */
   GList *		list;			/* our contained movie clips (ordered by depth) */
+  GHashTable *		depths;			/* depth => GSList of children in list at that depth */
+  GHashTable *		names;			/* name => GSList of children in list using that name (case-insensitive) */
   int			depth;			/* depth of movie (equals content->depth unless explicitly set) */
   SwfdecMovieCacheState	cache_state;		/* whether we are up to date */
   SwfdecMovieState	state;			/* state the movie is in */
@@ -151,6 +153,11 @@ struct _SwfdecMovie {
   double		rotation;		/* rotation in degrees [-180, 180] */
   cairo_matrix_t	matrix;			/* cairo matrix computed from above and content->transform */
   cairo_matrix_t	inverse_matrix;		/* the inverse of the cairo matrix */
+  guint64		matrix_generation;	/* generation the matrix was last changed in */
+  cairo_matrix_t	global_matrix;		/* cached movie => global matrix */
+  cairo_matrix_t	global_inverse_matrix;	/* cached global => movie matrix */
+  guint64		global_generation;	/* generation the cached matrices were last verified in or 0 */
+  guint64		global_changed;		/* generation the cached matrices were last computed in */
   SwfdecColorTransform	color_transform;	/* scripted color transformation */
   guint			blend_mode;		/* blend mode to use - see to-cairo conversion code for what they mean */
 
@@ -257,6 +264,7 @@ void		swfdec_movie_queue_update	(SwfdecMovie *		movie,
 void		swfdec_movie_update		(SwfdecMovie *		movie);
 void		swfdec_movie_begin_update_matrix(SwfdecMovie *		movie);
 void		swfdec_movie_end_update_matrix	(SwfdecMovie *		movie);
+void		swfdec_movie_matrix_changed	(SwfdecMovie *		movie);
 void		swfdec_movie_local_to_global	(SwfdecMovie *		movie,
 						 double *		x,
 						 double *		y);
@@ -275,6 +283,12 @@ void		swfdec_movie_rect_global_to_local (SwfdecMovie *	movie,
 						 SwfdecRect *		rect);
 void		swfdec_movie_set_depth		(SwfdecMovie *		movie,
 						 int			depth);
+void		swfdec_movie_set_name		(SwfdecMovie *		movie,
+						 const char *		name);
+void		swfdec_movie_index_child	(SwfdecMovie *		movie,
+						 SwfdecMovie *		child);
+gboolean	swfdec_movie_unindex_child	(SwfdecMovie *		movie,
+						 SwfdecMovie *		child);
 
 void		swfdec_movie_get_mouse		(SwfdecMovie *		movie,
 						 double *		x,
@@ -146,7 +146,8 @@ mc_name_get (SwfdecMovie *movie)
 static void
 mc_name_set (SwfdecMovie *movie, SwfdecAsValue val)
 {
-  movie->name = swfdec_as_value_to_string (swfdec_gc_object_get_context (movie), val);
+  swfdec_movie_set_name (movie,
+      swfdec_as_value_to_string (swfdec_gc_object_get_context (movie), val));
 }
 
 static SwfdecAsValue
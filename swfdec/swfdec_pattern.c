@@ -25,6 +25,7 @@
 
 #include "swfdec_pattern.h"
 #include "swfdec_bits.h"
+#include "swfdec_cached_mask.h"
 #include "swfdec_color.h"
 #include "swfdec_debug.h"
 #include "swfdec_decoder.h"
@@ -44,6 +45,128 @@ swfdec_pattern_compute_extents (SwfdecDraw *draw)
   swfdec_path_get_extents (&draw->path, &draw->extents);
 }
 
+/* fills bigger than this many pixels are not cached */
+#define SWFDEC_PATTERN_MAX_CACHED_AREA (256 * 256)
+
+typedef struct {
+  guint			serial;
+  cairo_matrix_t	matrix;
+} SwfdecPatternMaskKey;
+
+static gboolean
+swfdec_pattern_find_mask (SwfdecCached *cached, gpointer data)
+{
+  SwfdecPatternMaskKey *key = data;
+
+  return swfdec_cached_mask_matches (SWFDEC_CACHED_MASK (cached), 
+      key->serial, &key->matrix);
+}
+
+static SwfdecCachedMask *
+swfdec_pattern_create_mask (SwfdecDraw *draw, SwfdecRenderer *renderer,
+    const cairo_matrix_t *matrix, gboolean seen)
+{
+  SwfdecCachedMask *mask;
+  cairo_surface_t *surface;
+  SwfdecRect rect;
+  int x, y, w, h;
+  gsize size;
+  cairo_t *cr;
+
+  /* add a pixel on each side for antialiasing */
+  swfdec_rect_transform (&rect, &draw->extents, matrix);
+  x = floor (rect.x0) - 1;
+  y = floor (rect.y0) - 1;
+  w = ceil (rect.x1) + 1 - x;
+  h = ceil (rect.y1) + 1 - y;
+  if ((gsize) w * h > SWFDEC_PATTERN_MAX_CACHED_AREA)
+    return NULL;
+  /* the mask keeps the draw alive */
+  size = sizeof (SwfdecDraw) + draw->path.num_data * sizeof (cairo_path_data_t);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_A8, w, h);
+  cr = cairo_create (surface);
+  cairo_translate (cr, -x, -y);
+  cairo_transform (cr, matrix);
+  cairo_set_fill_rule (cr, CAIRO_FILL_RULE_EVEN_ODD);
+  cairo_append_path (cr, &draw->path);
+  cairo_fill (cr);
+  cairo_destroy (cr);
+
+  /* Most fills are only painted once with the same transformation, so only
+   * remember we've seen it and keep the mask when it is painted again. 
+   * The fill is still painted through the mask, so the output doesn't 
+   * depend on what is cached. */
+  if (!seen) {
+    mask = swfdec_cached_mask_new (G_OBJECT (draw), draw->serial, matrix,
+	NULL, x, y, size);
+    swfdec_renderer_add_cache (renderer, FALSE, draw, SWFDEC_CACHED (mask));
+    g_object_unref (mask);
+    mask = swfdec_cached_mask_new (G_OBJECT (draw), draw->serial, matrix,
+	surface, x, y, size + w * h);
+    cairo_surface_destroy (surface);
+    return mask;
+  }
+
+  surface = swfdec_renderer_create_similar (renderer, surface);
+  mask = swfdec_cached_mask_new (G_OBJECT (draw), draw->serial, matrix,
+      surface, x, y, size + w * h);
+  cairo_surface_destroy (surface);
+  swfdec_renderer_add_cache (renderer, FALSE, draw, SWFDEC_CACHED (mask));
+  return mask;
+}
+
+/* Fills using a cached coverage mask of the path, so fills that are drawn 
+ * again with the same scale, rotation and subpixel offset don't need to be 
+ * rasterized again. The mask is rasterized at the exact subpixel part of the 
+ * translation and composited at the whole pixel part. */
+static gboolean
+swfdec_pattern_paint_cached (SwfdecDraw *draw, cairo_t *cr, cairo_pattern_t *pattern)
+{
+  SwfdecRenderer *renderer;
+  SwfdecCachedMask *mask;
+  SwfdecPatternMaskKey key;
+  cairo_matrix_t matrix;
+  int x, y;
+
+  renderer = swfdec_renderer_get (cr);
+  if (renderer == NULL)
+    return FALSE;
+
+  cairo_get_matrix (cr, &matrix);
+  key.serial = draw->serial;
+  key.matrix = matrix;
+  x = floor (matrix.x0);
+  y = floor (matrix.y0);
+  key.matrix.x0 = matrix.x0 - x;
+  key.matrix.y0 = matrix.y0 - y;
+  mask = (SwfdecCachedMask *) swfdec_renderer_get_cache (renderer, draw,
+      swfdec_pattern_find_mask, &key);
+  if (mask && mask->surface) {
+    swfdec_cached_use (SWFDEC_CACHED (mask));
+    g_object_ref (mask);
+  } else {
+    if (mask) {
+      /* seen before, replace the placeholder with the real mask */
+      swfdec_cached_unuse (SWFDEC_CACHED (mask));
+      mask = swfdec_pattern_create_mask (draw, renderer, &key.matrix, TRUE);
+    } else {
+      /* static text paints the same glyphs in the same places every frame */
+      mask = swfdec_pattern_create_mask (draw, renderer, &key.matrix, draw->glyph);
+    }
+    if (mask == NULL)
+      return FALSE;
+  }
+
+  /* the pattern's space is locked when setting the source */
+  cairo_set_source (cr, pattern);
+  cairo_identity_matrix (cr);
+  cairo_mask_surface (cr, mask->surface, x + mask->x, y + mask->y);
+  cairo_set_matrix (cr, &matrix);
+  g_object_unref (mask);
+  return TRUE;
+}
+
 static void
 swfdec_pattern_paint (SwfdecDraw *draw, cairo_t *cr, const SwfdecColorTransform *trans)
 {
@@ -54,6 +177,10 @@ swfdec_pattern_paint (SwfdecDraw *draw, cairo_t *cr, const SwfdecColorTransform
   if (pattern == NULL)
     return;
   cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
+  if (swfdec_pattern_paint_cached (draw, cr, pattern)) {
+    cairo_pattern_destroy (pattern);
+    return;
+  }
   cairo_set_fill_rule (cr, CAIRO_FILL_RULE_EVEN_ODD);
   cairo_append_path (cr, &draw->path);
   cairo_set_source (cr, pattern);
@@ -271,15 +271,120 @@ swfdec_time_val_get_type (void)
   return type;
 }
 
+/**
+ * swfdec_player_use_enter_frame_handlers:
+ * @player: a #SwfdecPlayer
+ *
+ * Called when a variable that might cause an onEnterFrame handler to be
+ * found for a movie is created. Until this happens, movies are known to not
+ * have onEnterFrame handlers and need not be iterated unless they play.
+ **/
+void
+swfdec_player_use_enter_frame_handlers (SwfdecPlayer *player)
+{
+  SwfdecPlayerPrivate *priv;
+  GList *walk;
+
+  g_return_if_fail (SWFDEC_IS_PLAYER (player));
+
+  priv = player->priv;
+  if (priv->enter_frame_handlers)
+    return;
+
+  SWFDEC_LOG ("enter frame handlers in use, activating all actors");
+  priv->enter_frame_handlers = TRUE;
+  for (walk = priv->actors; walk; walk = walk->next) {
+    swfdec_actor_activate (walk->data);
+  }
+}
+
 /*** Timeouts ***/
 
+/* The timeouts are kept in a binary heap with the next timeout at index 0.
+ * Timeouts with the same timestamp trigger in the order they were added in.
+ * Every timeout knows its position in the heap, so removing it doesn't 
+ * require a search. */
+
+static inline gboolean
+swfdec_player_timeout_before (const SwfdecTimeout *a, const SwfdecTimeout *b)
+{
+  if (a->timestamp != b->timestamp)
+    return a->timestamp < b->timestamp;
+  return a->serial < b->serial;
+}
+
+static inline void
+swfdec_player_timeouts_set (GPtrArray *heap, guint i, SwfdecTimeout *timeout)
+{
+  g_ptr_array_index (heap, i) = timeout;
+  timeout->index = i + 1;
+}
+
+static void
+swfdec_player_timeouts_sift_up (GPtrArray *heap, guint i)
+{
+  SwfdecTimeout *timeout = g_ptr_array_index (heap, i);
+
+  while (i > 0) {
+    guint parent = (i - 1) / 2;
+    SwfdecTimeout *cur = g_ptr_array_index (heap, parent);
+    if (!swfdec_player_timeout_before (timeout, cur))
+      break;
+    swfdec_player_timeouts_set (heap, i, cur);
+    i = parent;
+  }
+  swfdec_player_timeouts_set (heap, i, timeout);
+}
+
+static void
+swfdec_player_timeouts_sift_down (GPtrArray *heap, guint i)
+{
+  SwfdecTimeout *timeout = g_ptr_array_index (heap, i);
+
+  for (;;) {
+    guint child = 2 * i + 1;
+    SwfdecTimeout *cur;
+    if (child >= heap->len)
+      break;
+    if (child + 1 < heap->len &&
+	swfdec_player_timeout_before (g_ptr_array_index (heap, child + 1), 
+	  g_ptr_array_index (heap, child)))
+      child++;
+    cur = g_ptr_array_index (heap, child);
+    if (!swfdec_player_timeout_before (cur, timeout))
+      break;
+    swfdec_player_timeouts_set (heap, i, cur);
+    i = child;
+  }
+  swfdec_player_timeouts_set (heap, i, timeout);
+}
+
+static void
+swfdec_player_timeouts_remove (GPtrArray *heap, SwfdecTimeout *timeout)
+{
+  SwfdecTimeout *last;
+  guint i;
+
+  g_assert (timeout->index > 0 && timeout->index <= heap->len);
+  g_assert (g_ptr_array_index (heap, timeout->index - 1) == timeout);
+
+  i = timeout->index - 1;
+  timeout->index = 0;
+  last = g_ptr_array_remove_index (heap, heap->len - 1);
+  if (last == timeout)
+    return;
+  swfdec_player_timeouts_set (heap, i, last);
+  swfdec_player_timeouts_sift_up (heap, i);
+  swfdec_player_timeouts_sift_down (heap, last->index - 1);
+}
+
 static SwfdecTick
 swfdec_player_get_next_event_time (SwfdecPlayer *player)
 {
   SwfdecPlayerPrivate *priv = player->priv;
 
-  if (priv->timeouts) {
-    SwfdecTick next = ((SwfdecTimeout *) priv->timeouts->data)->timestamp;
+  if (priv->timeouts->len > 0) {
+    SwfdecTick next = ((SwfdecTimeout *) g_ptr_array_index (priv->timeouts, 0))->timestamp;
     /* This can happen because advancing only uses millisecond granularity */
     if (next < priv->time)
       return 0;
@@ -297,6 +402,8 @@ swfdec_player_get_next_event_time (SwfdecPlayer *player)
  *
  * Adds a timeout to @player. The timeout will be removed automatically when 
  * triggered, so you need to use swfdec_player_add_timeout() to add it again. 
+ * If the timeout has already been added, it is rescheduled. Timeouts with 
+ * the same timestamp are triggered in the order they were added in. 
  * The #SwfdecTimeout struct and callback does not use a data callback pointer. 
  * It's suggested that you use the struct as part of your own bigger struct 
  * and get it back like this:
@@ -319,7 +426,6 @@ void
 swfdec_player_add_timeout (SwfdecPlayer *player, SwfdecTimeout *timeout)
 {
   SwfdecPlayerPrivate *priv;
-  GList *walk;
   SwfdecTick next_tick;
 
   g_return_if_fail (SWFDEC_IS_PLAYER (player));
@@ -331,13 +437,12 @@ swfdec_player_add_timeout (SwfdecPlayer *player, SwfdecTimeout *timeout)
   SWFDEC_LOG ("adding timeout %p in %"G_GUINT64_FORMAT" msecs", timeout, 
       SWFDEC_TICKS_TO_MSECS (timeout->timestamp - priv->time));
   next_tick = swfdec_player_get_next_event_time (player);
+  if (timeout->index)
+    swfdec_player_timeouts_remove (priv->timeouts, timeout);
   /* the order is important, on events with the same time, we make sure the new one is last */
-  for (walk = priv->timeouts; walk; walk = walk->next) {
-    SwfdecTimeout *cur = walk->data;
-    if (cur->timestamp > timeout->timestamp)
-      break;
-  }
-  priv->timeouts = g_list_insert_before (priv->timeouts, walk, timeout);
+  timeout->serial = priv->timeout_serial++;
+  g_ptr_array_add (priv->timeouts, timeout);
+  swfdec_player_timeouts_sift_up (priv->timeouts, priv->timeouts->len - 1);
   if (next_tick != swfdec_player_get_next_event_time (player))
     g_object_notify (G_OBJECT (player), "next-event");
 }
@@ -347,8 +452,8 @@ swfdec_player_add_timeout (SwfdecPlayer *player, SwfdecTimeout *timeout)
  * @player: a #SwfdecPlayer
  * @timeout: a timeout that should be removed
  *
- * Removes the @timeout from the list of scheduled timeouts. The timeout must 
- * have been added with swfdec_player_add_timeout() before.
+ * Removes the @timeout from the list of scheduled timeouts. If the timeout is
+ * not scheduled, this function does nothing.
  **/
 void
 swfdec_player_remove_timeout (SwfdecPlayer *player, SwfdecTimeout *timeout)
@@ -362,21 +467,30 @@ swfdec_player_remove_timeout (SwfdecPlayer *player, SwfdecTimeout *timeout)
   //g_return_if_fail (timeout->timestamp >= player->priv->time);
   g_return_if_fail (timeout->callback != NULL);
 
+  if (timeout->index == 0)
+    return;
+
   SWFDEC_LOG ("removing timeout %p", timeout);
   priv = player->priv;
   next_tick = swfdec_player_get_next_event_time (player);
-  priv->timeouts = g_list_remove (priv->timeouts, timeout);
+  swfdec_player_timeouts_remove (priv->timeouts, timeout);
   if (next_tick != swfdec_player_get_next_event_time (player))
     g_object_notify (G_OBJECT (player), "next-event");
 }
 
 /*** Actions ***/
 
+/* Actions are kept in one queue per importance and additionally in a queue 
+ * per actor, so that removing all actions of an actor doesn't need to look 
+ * at the actions of other actors. */
 typedef struct {
   SwfdecActor *		actor;		/* the actor to trigger the action on */
   SwfdecScript *	script;		/* script to execute or NULL to trigger action */
   SwfdecEventType	event;		/* the action to trigger */
   guint8		key;
+  guint8		importance;	/* queue this action is in */
+  GList			player_link;	/* link in the player's queue */
+  GList			actor_link;	/* link in the actor's queue */
 } SwfdecPlayerAction;
 
 typedef struct {
@@ -386,48 +500,28 @@ typedef struct {
 } SwfdecPlayerExternalAction;
 
 static void
-swfdec_player_compress_actions (SwfdecRingBuffer *buffer)
+swfdec_player_do_add_action (SwfdecPlayer *player, SwfdecActor *actor,
+    SwfdecScript *script, SwfdecEventType event, guint8 key, guint importance)
 {
-  SwfdecPlayerAction *action, tmp;
-  guint i = 0;
-
-  for (i = swfdec_ring_buffer_get_n_elements (buffer); i > 0; i--) {
-    action = swfdec_ring_buffer_pop (buffer);
-    g_assert (action);
-    if (action->actor == NULL)
-      continue;
-    tmp = *action;
-    action = swfdec_ring_buffer_push (buffer);
-    *action = tmp;
-  }
-  SWFDEC_INFO ("compresed action queue to %u elements", 
-      swfdec_ring_buffer_get_n_elements (buffer));
-  for (i = 0; i < swfdec_ring_buffer_get_n_elements (buffer); i++) {
-    action = swfdec_ring_buffer_peek_nth (buffer, i);
-    g_assert (action->actor != NULL);
-  }
+  SwfdecPlayerAction *action = g_slice_new (SwfdecPlayerAction);
+
+  action->actor = actor;
+  action->script = script;
+  action->event = event;
+  action->key = key;
+  action->importance = importance;
+  action->player_link.data = action;
+  action->actor_link.data = action;
+  g_queue_push_tail_link (&player->priv->actions[importance], &action->player_link);
+  g_queue_push_tail_link (&actor->actions, &action->actor_link);
 }
 
 static void
-swfdec_player_do_add_action (SwfdecPlayer *player, guint importance, SwfdecPlayerAction *act)
+swfdec_player_action_free (SwfdecPlayer *player, SwfdecPlayerAction *action)
 {
-  SwfdecPlayerPrivate *priv = player->priv;
-  SwfdecPlayerAction *action = swfdec_ring_buffer_push (priv->actions[importance]);
-  if (action == NULL) {
-    /* try to get rid of freed actions */
-    swfdec_player_compress_actions (priv->actions[importance]);
-    action = swfdec_ring_buffer_push (priv->actions[importance]);
-    if (action == NULL) {
-      if (swfdec_ring_buffer_get_size (priv->actions[importance]) == 256) {
-	SWFDEC_WARNING ("256 levels of recursion were exceeded in one action list.");
-      }
-      swfdec_ring_buffer_set_size (priv->actions[importance],
-	  swfdec_ring_buffer_get_size (priv->actions[importance]) + 16);
-      action = swfdec_ring_buffer_push (priv->actions[importance]);
-      g_assert (action);
-    }
-  }
-  *action = *act;
+  g_queue_unlink (&player->priv->actions[action->importance], &action->player_link);
+  g_queue_unlink (&action->actor->actions, &action->actor_link);
+  g_slice_free (SwfdecPlayerAction, action);
 }
 
 /**
@@ -447,29 +541,25 @@ void
 swfdec_player_add_action (SwfdecPlayer *player, SwfdecActor *actor,
     SwfdecEventType type, guint8 key, guint importance)
 {
-  SwfdecPlayerAction action = { actor, NULL, type, key };
-
   g_return_if_fail (SWFDEC_IS_PLAYER (player));
   g_return_if_fail (SWFDEC_IS_ACTOR (actor));
   g_return_if_fail (importance < SWFDEC_PLAYER_N_ACTION_QUEUES);
 
   SWFDEC_LOG ("adding action %s %u", SWFDEC_MOVIE (actor)->name, type);
-  swfdec_player_do_add_action (player, importance, &action);
+  swfdec_player_do_add_action (player, actor, NULL, type, key, importance);
 }
 
 void
 swfdec_player_add_action_script	(SwfdecPlayer *player, SwfdecActor *actor,
     SwfdecScript *script, guint importance)
 {
-  SwfdecPlayerAction action = { actor, script, 0 };
-
   g_return_if_fail (SWFDEC_IS_PLAYER (player));
   g_return_if_fail (SWFDEC_IS_ACTOR (actor));
   g_return_if_fail (script != NULL);
   g_return_if_fail (importance < SWFDEC_PLAYER_N_ACTION_QUEUES);
 
   SWFDEC_LOG ("adding action script %s %s", SWFDEC_MOVIE (actor)->name, script->name);
-  swfdec_player_do_add_action (player, importance, &action);
+  swfdec_player_do_add_action (player, actor, script, 0, 0, importance);
 }
 
 /**
@@ -484,23 +574,14 @@ void
 swfdec_player_remove_all_actions (SwfdecPlayer *player, SwfdecActor *actor)
 {
   SwfdecPlayerAction *action;
-  SwfdecPlayerPrivate *priv;
-  guint i, j;
 
   g_return_if_fail (SWFDEC_IS_PLAYER (player));
   g_return_if_fail (SWFDEC_IS_ACTOR (actor));
 
-  priv = player->priv;
-  for (i = 0; i < SWFDEC_PLAYER_N_ACTION_QUEUES; i++) {
-    for (j = 0; j < swfdec_ring_buffer_get_n_elements (priv->actions[i]); j++) {
-      action = swfdec_ring_buffer_peek_nth (priv->actions[i], j);
-
-      if (action->actor == actor) {
-	SWFDEC_LOG ("removing action %p %u", 
-	    action->actor, action->event);
-	action->actor = NULL;
-      }
-    }
+  while (!g_queue_is_empty (&actor->actions)) {
+    action = g_queue_peek_head (&actor->actions);
+    SWFDEC_LOG ("removing action %p %u", action->actor, action->event);
+    swfdec_player_action_free (player, action);
   }
 }
 
@@ -509,27 +590,32 @@ swfdec_player_do_action (SwfdecPlayer *player)
 {
   SwfdecPlayerAction *action;
   SwfdecPlayerPrivate *priv;
+  SwfdecActor *actor;
+  SwfdecScript *script;
+  SwfdecEventType event;
+  guint8 key;
   guint i;
 
   priv = player->priv;
   for (i = 0; i < SWFDEC_PLAYER_N_ACTION_QUEUES; i++) {
-    do {
-      action = swfdec_ring_buffer_pop (priv->actions[i]);
-      if (action == NULL)
-	break;
-    } while (action->actor == NULL); /* skip removed actions */
-    if (action) {
-      if (action->script) {
-	SwfdecSandbox *sandbox = SWFDEC_MOVIE (action->actor)->resource->sandbox;
-	SwfdecAsObject *object = swfdec_as_relay_get_as_object (SWFDEC_AS_RELAY (action->actor));
-	swfdec_sandbox_use (sandbox);
-	swfdec_as_object_run (object, action->script);
-	swfdec_sandbox_unuse (sandbox);
-      } else {
-	swfdec_actor_execute (action->actor, action->event, action->key);
-      }
-      return TRUE;
+    action = g_queue_peek_head (&priv->actions[i]);
+    if (action == NULL)
+      continue;
+    actor = action->actor;
+    script = action->script;
+    event = action->event;
+    key = action->key;
+    swfdec_player_action_free (player, action);
+    if (script) {
+      SwfdecSandbox *sandbox = SWFDEC_MOVIE (actor)->resource->sandbox;
+      SwfdecAsObject *object = swfdec_as_relay_get_as_object (SWFDEC_AS_RELAY (actor));
+      swfdec_sandbox_use (sandbox);
+      swfdec_as_object_run (object, script);
+      swfdec_sandbox_unuse (sandbox);
+    } else {
+      swfdec_actor_execute (actor, event, key);
     }
+    return TRUE;
   }
 
   return FALSE;
@@ -677,9 +763,11 @@ enum {
   PROP_START_TIME,
   PROP_FOCUS,
   PROP_RENDERER,
+  PROP_LOAD_CACHE,
   PROP_FULLSCREEN,
   PROP_ALLOW_FULLSCREEN,
-  PROP_SELECTION
+  PROP_SELECTION,
+  PROP_XML_PARSE_BUDGET
 };
 
 G_DEFINE_TYPE (SwfdecPlayer, swfdec_player, SWFDEC_TYPE_AS_CONTEXT)
@@ -805,6 +893,9 @@ swfdec_player_get_property (GObject *object, guint param_id, GValue *value,
     case PROP_RENDERER:
       g_value_set_object (value, priv->renderer);
       break;
+    case PROP_LOAD_CACHE:
+      g_value_set_object (value, priv->load_cache);
+      break;
     case PROP_FULLSCREEN:
       g_value_set_boolean (value, priv->fullscreen);
       break;
@@ -814,6 +905,9 @@ swfdec_player_get_property (GObject *object, guint param_id, GValue *value,
     case PROP_SELECTION:
       g_value_set_string (value, priv->selection);
       break;
+    case PROP_XML_PARSE_BUDGET:
+      g_value_set_uint (value, priv->xml_parse_budget);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
       break;
@@ -1008,9 +1102,15 @@ swfdec_player_set_property (GObject *object, guint param_id, const GValue *value
     case PROP_RENDERER:
       swfdec_player_set_renderer (player, g_value_get_object (value));
       break;
+    case PROP_LOAD_CACHE:
+      swfdec_player_set_load_cache (player, g_value_get_object (value));
+      break;
     case PROP_ALLOW_FULLSCREEN:
       swfdec_player_set_allow_fullscreen (player, g_value_get_boolean (value));
       break;
+    case PROP_XML_PARSE_BUDGET:
+      swfdec_player_set_xml_parse_budget (player, g_value_get_uint (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
       break;
@@ -1036,7 +1136,6 @@ swfdec_player_dispose (GObject *object)
 {
   SwfdecPlayer *player = SWFDEC_PLAYER (object);
   SwfdecPlayerPrivate *priv = player->priv;
-  guint i;
 
   swfdec_player_stop_all_sounds (player);
   swfdec_function_list_clear (&priv->resource_requests);
@@ -1070,25 +1169,23 @@ swfdec_player_dispose (GObject *object)
     }
   }
   {
-    SwfdecPlayerAction *action;
+    guint i;
     for (i = 0; i < SWFDEC_PLAYER_N_ACTION_QUEUES; i++) {
-      while ((action = swfdec_ring_buffer_pop (priv->actions[i])) != NULL) {
-	g_assert (action->actor == NULL); /* skip removed actions */
-      }
+      g_assert (g_queue_is_empty (&priv->actions[i]));
     }
   }
 #endif
   swfdec_ring_buffer_free (priv->external_actions);
-  for (i = 0; i < SWFDEC_PLAYER_N_ACTION_QUEUES; i++) {
-    swfdec_ring_buffer_free (priv->actions[i]);
-  }
   g_assert (priv->actors == NULL);
+  g_assert (g_sequence_get_length (priv->active_actors) == 0);
+  g_sequence_free (priv->active_actors);
   g_assert (priv->audio == NULL);
   g_slist_free (priv->sandboxes);
   if (priv->external_timeout.callback)
     swfdec_player_remove_timeout (player, &priv->external_timeout);
   swfdec_player_stop_ticking (player);
-  g_assert (priv->timeouts == NULL);
+  g_assert (priv->timeouts->len == 0);
+  g_ptr_array_free (priv->timeouts, TRUE);
   g_list_free (priv->intervals);
   priv->intervals = NULL;
   g_object_unref (priv->cache);
@@ -1102,6 +1199,10 @@ swfdec_player_dispose (GObject *object)
     g_object_unref (priv->renderer);
     priv->renderer = NULL;
   }
+  if (priv->load_cache) {
+    g_object_unref (priv->load_cache);
+    priv->load_cache = NULL;
+  }
   if (priv->runtime) {
     g_timer_destroy (priv->runtime);
     priv->runtime = NULL;
@@ -1139,13 +1240,11 @@ swfdec_player_broadcast (SwfdecPlayer *player, const char *object_name,
     SwfdecSandbox *sandbox = walk->data;
     swfdec_sandbox_use (sandbox);
     swfdec_as_object_get_variable (SWFDEC_AS_CONTEXT (player)->global, object_name, &vals[0]);
-    if (!SWFDEC_AS_VALUE_IS_COMPOSITE (vals[0]))
-      return;
-    obj = SWFDEC_AS_VALUE_GET_COMPOSITE (vals[0]);
-    if (obj == NULL)
-      return;
-    SWFDEC_AS_VALUE_SET_STRING (&vals[0], signal_name);
-    swfdec_as_object_call (obj, SWFDEC_AS_STR_broadcastMessage, argc + 1, vals, NULL);
+    obj = SWFDEC_AS_VALUE_IS_COMPOSITE (vals[0]) ? SWFDEC_AS_VALUE_GET_COMPOSITE (vals[0]) : NULL;
+    if (obj) {
+      SWFDEC_AS_VALUE_SET_STRING (&vals[0], signal_name);
+      swfdec_as_broadcaster_broadcast (obj, argc + 1, vals);
+    }
     swfdec_sandbox_unuse (sandbox);
   }
 }
@@ -1751,7 +1850,7 @@ swfdec_player_iterate (SwfdecTimeout *timeout)
 {
   SwfdecPlayerPrivate *priv = (SwfdecPlayerPrivate *) ((void *) ((guint8 *) timeout - G_STRUCT_OFFSET (SwfdecPlayerPrivate, iterate_timeout)));
   SwfdecPlayer *player = priv->player;
-  GList *walk;
+  GSequenceIter *iter;
 
   /* add timeout again - do this first because later code can change it */
   /* FIXME: rounding issues? */
@@ -1761,23 +1860,30 @@ swfdec_player_iterate (SwfdecTimeout *timeout)
   SWFDEC_INFO ("=== START ITERATION ===");
   /* start the iteration. This performs a goto next frame on all 
    * movies that are not stopped. It also queues onEnterFrame.
+   * Only active actors are iterated, the others would not do anything. They
+   * are sorted like priv->actors, so the order of events doesn't change.
    */
-  for (walk = priv->actors; walk; walk = walk->next) {
-    SwfdecActorClass *klass = SWFDEC_ACTOR_GET_CLASS (walk->data);
+  iter = g_sequence_get_begin_iter (priv->active_actors);
+  while (!g_sequence_iter_is_end (iter)) {
+    SwfdecActor *actor = g_sequence_get (iter);
+    SwfdecActorClass *klass = SWFDEC_ACTOR_GET_CLASS (actor);
     if (klass->iterate_start)
-      klass->iterate_start (walk->data);
+      klass->iterate_start (actor);
+    iter = g_sequence_iter_next (iter);
   }
   swfdec_player_perform_actions (player);
   SWFDEC_INFO ("=== STOP ITERATION ===");
-  /* this loop allows removal of walk->data */
-  walk = priv->actors;
-  while (walk) {
-    SwfdecMovie *cur = walk->data;
-    SwfdecActorClass *klass = SWFDEC_ACTOR_GET_CLASS (cur);
-    walk = walk->next;
+  /* this loop allows removal of the current actor */
+  iter = g_sequence_get_begin_iter (priv->active_actors);
+  while (!g_sequence_iter_is_end (iter)) {
+    SwfdecActor *actor = g_sequence_get (iter);
+    SwfdecActorClass *klass = SWFDEC_ACTOR_GET_CLASS (actor);
+    iter = g_sequence_iter_next (iter);
     g_assert (klass->iterate_end);
-    if (!klass->iterate_end (SWFDEC_ACTOR (cur)))
-      swfdec_movie_destroy (cur);
+    if (!klass->iterate_end (actor))
+      swfdec_movie_destroy (SWFDEC_MOVIE (actor));
+    else if (!swfdec_actor_needs_iterate (actor))
+      swfdec_actor_deactivate (actor);
   }
   swfdec_player_execute_on_load_init (player);
   swfdec_function_list_execute_and_clear (&priv->resource_requests, player);
@@ -1814,15 +1920,15 @@ swfdec_player_do_advance (SwfdecPlayer *player, gulong msecs, guint audio_sample
   if (!swfdec_player_lock (player))
     return;
 
-  g_assert (priv->timeouts != NULL);
+  g_assert (priv->timeouts->len > 0);
 
   target_time = priv->time + SWFDEC_MSECS_TO_TICKS (msecs);
   SWFDEC_DEBUG ("advancing %lu msecs (%u audio frames)", msecs, audio_samples);
 
-  timeout = priv->timeouts->data;
+  timeout = g_ptr_array_index (priv->timeouts, 0);
   swfdec_player_advance_audio (player, audio_samples);
   if (timeout->timestamp <= target_time) {
-    priv->timeouts = g_list_remove (priv->timeouts, timeout);
+    swfdec_player_timeouts_remove (priv->timeouts, timeout);
     priv->time = timeout->timestamp;
     SWFDEC_LOG ("activating timeout %p now (timeout is %"G_GUINT64_FORMAT,
 	timeout, timeout->timestamp);
@@ -1862,10 +1968,10 @@ swfdec_player_lock (SwfdecPlayer *player)
 {
   g_return_val_if_fail (SWFDEC_IS_PLAYER (player), FALSE);
   g_assert (!swfdec_player_is_locked (player));
-  g_assert (swfdec_ring_buffer_get_n_elements (player->priv->actions[0]) == 0);
-  g_assert (swfdec_ring_buffer_get_n_elements (player->priv->actions[1]) == 0);
-  g_assert (swfdec_ring_buffer_get_n_elements (player->priv->actions[2]) == 0);
-  g_assert (swfdec_ring_buffer_get_n_elements (player->priv->actions[3]) == 0);
+  g_assert (g_queue_is_empty (&player->priv->actions[0]));
+  g_assert (g_queue_is_empty (&player->priv->actions[1]));
+  g_assert (g_queue_is_empty (&player->priv->actions[2]));
+  g_assert (g_queue_is_empty (&player->priv->actions[3]));
 
   if (swfdec_as_context_is_aborted (SWFDEC_AS_CONTEXT (player)))
     return FALSE;
@@ -2030,10 +2136,10 @@ swfdec_player_unlock (SwfdecPlayer *player)
   SwfdecAsContext *context;
 
   g_return_if_fail (SWFDEC_IS_PLAYER (player));
-  g_assert (swfdec_ring_buffer_get_n_elements (player->priv->actions[0]) == 0);
-  g_assert (swfdec_ring_buffer_get_n_elements (player->priv->actions[1]) == 0);
-  g_assert (swfdec_ring_buffer_get_n_elements (player->priv->actions[2]) == 0);
-  g_assert (swfdec_ring_buffer_get_n_elements (player->priv->actions[3]) == 0);
+  g_assert (g_queue_is_empty (&player->priv->actions[0]));
+  g_assert (g_queue_is_empty (&player->priv->actions[1]));
+  g_assert (g_queue_is_empty (&player->priv->actions[2]));
+  g_assert (g_queue_is_empty (&player->priv->actions[3]));
   context = SWFDEC_AS_CONTEXT (player);
   g_return_if_fail (context->state != SWFDEC_AS_CONTEXT_INTERRUPTED);
 
@@ -2211,6 +2317,9 @@ swfdec_player_class_init (SwfdecPlayerClass *klass)
   g_object_class_install_property (object_class, PROP_RENDERER,
       g_param_spec_object ("renderer", "renderer", "the renderer used by this player",
 	  SWFDEC_TYPE_RENDERER, G_PARAM_READWRITE | G_PARAM_CONSTRUCT));
+  g_object_class_install_property (object_class, PROP_LOAD_CACHE,
+      g_param_spec_object ("load-cache", "load cache", "cache used for loaded files or NULL if none",
+	  SWFDEC_TYPE_LOAD_CACHE, G_PARAM_READWRITE));
   g_object_class_install_property (object_class, PROP_FULLSCREEN,
       g_param_spec_boolean ("fullscreen", "fullscreen", "if the player is in fullscreen mode",
 	  FALSE, G_PARAM_READABLE));
@@ -2221,6 +2330,9 @@ swfdec_player_class_init (SwfdecPlayerClass *klass)
   g_object_class_install_property (object_class, PROP_SELECTION,
       g_param_spec_string ("selection", "selection", "currently selected text",
 	  NULL, G_PARAM_READABLE));
+  g_object_class_install_property (object_class, PROP_XML_PARSE_BUDGET,
+      g_param_spec_uint ("xml-parse-budget", "XML parse budget", "maximum number of XML tokens parsed in one go while loading",
+	  1, G_MAXUINT, 1024, G_PARAM_READWRITE));
 
   /**
    * SwfdecPlayer::invalidate:
@@ -2413,7 +2525,6 @@ static void
 swfdec_player_init (SwfdecPlayer *player)
 {
   SwfdecPlayerPrivate *priv;
-  guint i;
 
   player->priv = priv = G_TYPE_INSTANCE_GET_PRIVATE (player, SWFDEC_TYPE_PLAYER, SwfdecPlayerPrivate);
   priv->player = player;
@@ -2422,9 +2533,6 @@ swfdec_player_init (SwfdecPlayer *player)
   priv->registered_classes = g_hash_table_new (g_direct_hash, g_direct_equal);
   priv->scripting_callbacks = g_hash_table_new (g_direct_hash, g_direct_equal);
 
-  for (i = 0; i < SWFDEC_PLAYER_N_ACTION_QUEUES; i++) {
-    priv->actions[i] = swfdec_ring_buffer_new_for_type (SwfdecPlayerAction, 16);
-  }
   priv->external_actions = swfdec_ring_buffer_new_for_type (SwfdecPlayerExternalAction, 8);
   // Big cache is required to allow images in the sizes of 3000x2000
   priv->cache = swfdec_cache_new (32 * 1024 * 1024);
@@ -2433,7 +2541,11 @@ swfdec_player_init (SwfdecPlayer *player)
   priv->runtime = g_timer_new ();
   g_timer_stop (priv->runtime);
   priv->max_runtime = 10 * 1000;
+  priv->xml_parse_budget = 1024;
   priv->invalidations = g_array_new (FALSE, FALSE, sizeof (SwfdecRectangle));
+  priv->timeouts = g_ptr_array_new ();
+  priv->active_actors = g_sequence_new (NULL);
+  priv->matrix_generation = 1;
   priv->mouse_visible = TRUE;
   priv->mouse_cursor = SWFDEC_MOUSE_CURSOR_NORMAL;
   priv->stage_width = -1;
@@ -2845,8 +2957,10 @@ swfdec_player_load_with_headers (SwfdecPlayer *player, const char *url,
     SwfdecBuffer *buffer, guint header_count, const char **header_names,
     const char **header_values)
 {
+  SwfdecPlayerPrivate *priv;
   SwfdecLoader *loader;
   SwfdecLoaderClass *klass;
+  SwfdecURL *cache_url = NULL;
 
   g_return_val_if_fail (SWFDEC_IS_PLAYER (player), NULL);
   g_return_val_if_fail (url != NULL, NULL);
@@ -2857,9 +2971,31 @@ swfdec_player_load_with_headers (SwfdecPlayer *player, const char *url,
   g_return_val_if_fail (header_values == NULL ||
       header_values[header_count] == NULL, NULL);
 
-  loader = g_object_new (player->priv->loader_type, NULL);
+  priv = player->priv;
+  /* only cache GET requests, requests posting data or setting custom headers 
+   * may have side effects or different results */
+  if (priv->load_cache && buffer == NULL && header_count == 0) {
+    if (!swfdec_url_path_is_relative (url)) {
+      cache_url = swfdec_url_new (url);
+    } else if (priv->base_url) {
+      cache_url = swfdec_url_new_relative (priv->base_url, url);
+    }
+    if (cache_url) {
+      loader = swfdec_load_cache_lookup (priv->load_cache, cache_url);
+      if (loader) {
+	swfdec_url_free (cache_url);
+	return loader;
+      }
+    }
+  }
+
+  loader = g_object_new (priv->loader_type, NULL);
   klass = SWFDEC_LOADER_GET_CLASS (loader);
   g_return_val_if_fail (klass->load != NULL, NULL);
+  if (cache_url) {
+    swfdec_load_cache_watch (priv->load_cache, loader, cache_url);
+    swfdec_url_free (cache_url);
+  }
   klass->load (loader, player, url, buffer, header_count, header_names,
       header_values);
 
@@ -3559,6 +3695,48 @@ swfdec_player_set_maximum_runtime (SwfdecPlayer *player, gulong msecs)
   g_object_notify (G_OBJECT (player), "max-runtime");
 }
 
+/**
+ * swfdec_player_get_xml_parse_budget:
+ * @player: a #SwfdecPlayer
+ *
+ * Queries how much XML @player may parse in one go while it is loading. See 
+ * swfdec_player_set_xml_parse_budget() for details.
+ *
+ * Returns: the number of XML tokens parsed in one go
+ **/
+guint
+swfdec_player_get_xml_parse_budget (SwfdecPlayer *player)
+{
+  g_return_val_if_fail (SWFDEC_IS_PLAYER (player), 1024);
+
+  return player->priv->xml_parse_budget;
+}
+
+/**
+ * swfdec_player_set_xml_parse_budget:
+ * @player: a #SwfdecPlayer
+ * @tokens: number of tags, text nodes, comments and so on, must be larger 
+ *          than 0
+ *
+ * XML that is loaded using XML.load() or XMLSocket is parsed while it arrives,
+ * so the parsed document is available immediately once loading finishes. 
+ * This function sets how many tokens may be parsed before the @player
+ * continues with other work and resumes parsing later. Larger values finish
+ * parsing large documents earlier, smaller values keep the player more 
+ * responsive. The budget is counted in tokens and not in time, so scripts
+ * see the same behavior no matter how fast the machine is. The default is 
+ * 1024 tokens.
+ **/
+void
+swfdec_player_set_xml_parse_budget (SwfdecPlayer *player, guint tokens)
+{
+  g_return_if_fail (SWFDEC_IS_PLAYER (player));
+  g_return_if_fail (tokens > 0);
+
+  player->priv->xml_parse_budget = tokens;
+  g_object_notify (G_OBJECT (player), "xml-parse-budget");
+}
+
 /**
  * swfdec_player_get_scripting:
  * @player: a #SwfdecPlayer
@@ -3710,6 +3888,51 @@ swfdec_player_set_renderer (SwfdecPlayer *player, SwfdecRenderer *renderer)
   g_object_notify (G_OBJECT (player), "renderer");
 }
 
+/**
+ * swfdec_player_get_load_cache:
+ * @player: a player
+ *
+ * Gets the cache used for files loaded by @player. See 
+ * swfdec_player_set_load_cache() for details.
+ *
+ * Returns: the #SwfdecLoadCache in use or %NULL if none
+ **/
+SwfdecLoadCache *
+swfdec_player_get_load_cache (SwfdecPlayer *player)
+{
+  g_return_val_if_fail (SWFDEC_IS_PLAYER (player), NULL);
+
+  return player->priv->load_cache;
+}
+
+/**
+ * swfdec_player_set_load_cache:
+ * @player: a player
+ * @cache: the cache to use or %NULL to not cache loaded files
+ *
+ * Sets the cache to use for files loaded by @player. When a file is requested
+ * that is available in @cache, the @player will not create a #SwfdecLoader, 
+ * but use the cached data instead. No cache is used by default.
+ **/
+void
+swfdec_player_set_load_cache (SwfdecPlayer *player, SwfdecLoadCache *cache)
+{
+  SwfdecPlayerPrivate *priv;
+
+  g_return_if_fail (SWFDEC_IS_PLAYER (player));
+  g_return_if_fail (cache == NULL || SWFDEC_IS_LOAD_CACHE (cache));
+
+  priv = player->priv;
+  if (priv->load_cache == cache)
+    return;
+  if (cache)
+    g_object_ref (cache);
+  if (priv->load_cache)
+    g_object_unref (priv->load_cache);
+  priv->load_cache = cache;
+  g_object_notify (G_OBJECT (player), "load-cache");
+}
+
 /**
  * swfdec_player_get_base_url:
  * @player: a #SwfdecPlayer
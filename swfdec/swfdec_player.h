@@ -24,6 +24,7 @@
 #include <cairo.h>
 #include <swfdec/swfdec_as_context.h>
 #include <swfdec/swfdec_as_types.h>
+#include <swfdec/swfdec_load_cache.h>
 #include <swfdec/swfdec_url.h>
 
 G_BEGIN_DECLS
@@ -132,6 +133,11 @@ gulong		swfdec_player_get_maximum_runtime
 void		swfdec_player_set_maximum_runtime 
 						(SwfdecPlayer *		player,
 						 gulong			msecs);
+guint		swfdec_player_get_xml_parse_budget
+						(SwfdecPlayer *		player);
+void		swfdec_player_set_xml_parse_budget
+						(SwfdecPlayer *		player,
+						 guint			tokens);
 const SwfdecURL *
 		swfdec_player_get_url		(SwfdecPlayer *		player);
 void		swfdec_player_set_url    	(SwfdecPlayer *		player,
@@ -154,6 +160,10 @@ void		swfdec_player_set_focus		(SwfdecPlayer *		player,
 SwfdecRenderer *swfdec_player_get_renderer	(SwfdecPlayer *		player);
 void		swfdec_player_set_renderer	(SwfdecPlayer *		player,
 						 SwfdecRenderer *	renderer);
+SwfdecLoadCache *
+		swfdec_player_get_load_cache	(SwfdecPlayer *		player);
+void		swfdec_player_set_load_cache	(SwfdecPlayer *		player,
+						 SwfdecLoadCache *	cache);
 gboolean	swfdec_player_get_fullscreen	(SwfdecPlayer *		player);
 gboolean	swfdec_player_get_allow_fullscreen
 						(SwfdecPlayer *		player);
@@ -51,6 +51,9 @@ struct _SwfdecTimeout {
   SwfdecTick		timestamp;		/* timestamp at which this thing is supposed to trigger */
   void			(* callback)		(SwfdecTimeout *advance);
   void			(* free)		(SwfdecTimeout *advance);
+  /* set by the player */
+  guint			index;			/* position in the player's timeouts + 1 or 0 if not added */
+  guint64		serial;			/* order timeouts with the same timestamp were added in */
 };
 
 #define SWFDEC_PLAYER_N_ACTION_QUEUES 4
@@ -77,6 +80,7 @@ struct _SwfdecPlayerPrivate
   SwfdecURL *		url;			/* url or NULL if not set yet */
   SwfdecURL *		base_url;	      	/* base url or NULL if not set yet */
   SwfdecRenderer *	renderer;		/* the renderer to use */
+  SwfdecLoadCache *	load_cache;		/* cache for loaded files or NULL */
   SwfdecPlayerScripting *scripting;		/* scripting object */
   GHashTable *		scripting_callbacks;	/* GC string => SwfdecAsFunction mapping of script callbacks */
   GType			loader_type;		/* type to use for creating sockets */
@@ -106,10 +110,12 @@ struct _SwfdecPlayerPrivate
   GList *		intervals;		/* all currently running intervals */
   GHashTable *		registered_classes;	/* name => SwfdecAsObject constructor */
   GSList *		xml_sockets;		/* all XMLSockets currently in use */
+  SwfdecXmlParser *	xml_parser;		/* streamed parse parseXML() may use right now or NULL */
 
   /* rendering */
   GArray *		invalidations;		/* fine-grained areas in need of redraw */
   GSList *		invalid_pending;	/* pending invalidations due to invalidate_last */
+  guint64		matrix_generation;	/* incremented whenever the matrix of a movie changes, never wraps */
   gboolean		fullscreen;		/* TRUE if the player has gone fullscreen */
 
   /* mouse */
@@ -142,16 +148,21 @@ struct _SwfdecPlayerPrivate
 
   /* events and advancing */
   SwfdecTick		time;			/* current time */
-  GList *		timeouts;	      	/* list of events, sorted by timestamp */
+  GPtrArray *		timeouts;	      	/* binary heap of events, sorted by timestamp */
+  guint64		timeout_serial;		/* serial for the next added timeout */
   guint			tick;			/* next tick */
   SwfdecTimeout		iterate_timeout;      	/* callback for iterating */
   GTimer *		runtime;		/* for checking how long we've been running */
   gulong		max_runtime;		/* maximum number of seconds the player may run */
+  guint			xml_parse_budget;	/* maximum XML tokens parsed in one go while loading */
   SwfdecRingBuffer *	external_actions;     	/* external actions we've queued up, like resize or loader stuff */
   SwfdecTimeout		external_timeout;      	/* callback for iterating */
   /* iterating */
   GList *		actors;			/* list of all SwfdecActor instances active in this player */
-  SwfdecRingBuffer *	actions[SWFDEC_PLAYER_N_ACTION_QUEUES]; /* all actions we've queued up so far */
+  GSequence *		active_actors;		/* actors that need iterating, newest first */
+  guint			actor_serial;		/* serial for the next created actor */
+  gboolean		enter_frame_handlers;	/* TRUE if any object might have an onEnterFrame handler */
+  GQueue		actions[SWFDEC_PLAYER_N_ACTION_QUEUES]; /* all actions we've queued up so far */
 
   /* security */
   GSList *		sandboxes;		/* all existing sandboxes */
@@ -209,6 +220,8 @@ void		swfdec_player_grab_focus	(SwfdecPlayer *		player,
 #define swfdec_player_has_focus(player,actor) ((player)->priv->focus == (actor))
 #define swfdec_player_is_key_pressed(player,key) ((player)->priv->key_pressed[(key) / 8] & (1 << ((key) % 8)))
 #define swfdec_player_is_mouse_pressed(player) ((player)->priv->mouse_button & 1)
+void		swfdec_player_use_enter_frame_handlers
+						(SwfdecPlayer *		player);
 void		swfdec_player_add_timeout	(SwfdecPlayer *		player,
 						 SwfdecTimeout *	timeout);
 void		swfdec_player_remove_timeout	(SwfdecPlayer *		player,
@@ -0,0 +1,657 @@
+/* Swfdec
+ * Copyright (c) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, 
+ * Boston, MA  02110-1301  USA
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "swfdec_player_pool.h"
+#include "swfdec_debug.h"
+#include "swfdec_player_internal.h"
+#include "swfdec_renderer_internal.h"
+
+/*** GTK-DOC ***/
+
+/**
+ * SECTION:SwfdecPlayerPool
+ * @title: SwfdecPlayerPool
+ * @short_description: run many players in parallel
+ *
+ * A #SwfdecPlayerPool runs a lot of independent players on a fixed number of
+ * threads. This is useful for applications processing many Flash files at 
+ * once, like creating thumbnails for them.
+ *
+ * Players are added to the pool using swfdec_player_pool_add(). After that, 
+ * the players must only be accessed using the functions provided by the pool
+ * until they are removed again with swfdec_player_pool_remove() or until 
+ * swfdec_player_pool_wait() returned. Work is queued using 
+ * swfdec_player_pool_advance() and swfdec_player_pool_render(). A player is 
+ * only ever processed by one thread at a time and its work is done in the 
+ * order it was queued. To be fair to all players, long advances are split 
+ * into smaller steps and players take turns in using the threads.
+ *
+ * The pool can also enforce limits on the players it processes: a maximum 
+ * runtime for scripts, a maximum amount of memory the script engine may use
+ * and a budget for the caches of the players' renderers that is split evenly 
+ * between all players in the pool.
+ */
+
+/**
+ * SwfdecPlayerPool:
+ *
+ * The object used to run players in parallel. All its members are private.
+ */
+
+/* maximum amount of msecs to advance a player before letting other players run */
+#define SWFDEC_PLAYER_POOL_SLICE 100
+
+typedef enum {
+  SWFDEC_PLAYER_POOL_ADVANCE,
+  SWFDEC_PLAYER_POOL_RENDER
+} SwfdecPlayerPoolJobType;
+
+typedef struct {
+  SwfdecPlayerPoolJobType	type;		/* what to do */
+  gulong			msecs;		/* msecs still to advance */
+  cairo_t *			cr;		/* context to render to */
+} SwfdecPlayerPoolJob;
+
+typedef struct {
+  SwfdecPlayer *	player;		/* the player */
+  GQueue		jobs;		/* SwfdecPlayerPoolJob still to do for player */
+  gboolean		busy;		/* TRUE while queued in or processed by a thread */
+} SwfdecPlayerPoolEntry;
+
+struct _SwfdecPlayerPoolPrivate {
+  GThreadPool *		threads;	/* the threads doing the work */
+  guint			n_threads;	/* number of threads */
+
+  GMutex *		mutex;		/* mutex protecting the members below */
+  GCond *		cond;		/* signalled whenever a player becomes idle */
+  GHashTable *		players;	/* SwfdecPlayer => SwfdecPlayerPoolEntry */
+  guint			n_busy;		/* number of busy players */
+  gulong		max_runtime;	/* maximum runtime of players or 0 for no limit */
+  gsize			max_memory;	/* maximum memory of players or 0 for no limit */
+  gsize			cache_size;	/* size of all renderer caches or 0 for no limit */
+};
+
+enum {
+  PROP_0,
+  PROP_N_THREADS,
+  PROP_MAX_RUNTIME,
+  PROP_MAX_MEMORY,
+  PROP_CACHE_SIZE
+};
+
+G_DEFINE_TYPE (SwfdecPlayerPool, swfdec_player_pool, G_TYPE_OBJECT)
+
+static void
+swfdec_player_pool_job_free (SwfdecPlayerPoolJob *job)
+{
+  if (job->cr)
+    cairo_destroy (job->cr);
+  g_slice_free (SwfdecPlayerPoolJob, job);
+}
+
+/* returns TRUE when the job is done */
+static gboolean
+swfdec_player_pool_job_run (SwfdecPlayerPoolJob *job, SwfdecPlayer *player)
+{
+  gulong msecs;
+
+  switch (job->type) {
+    case SWFDEC_PLAYER_POOL_ADVANCE:
+      msecs = MIN (job->msecs, SWFDEC_PLAYER_POOL_SLICE);
+      swfdec_player_advance (player, msecs);
+      job->msecs -= msecs;
+      return job->msecs == 0;
+    case SWFDEC_PLAYER_POOL_RENDER:
+      swfdec_player_render (player, job->cr);
+      return TRUE;
+    default:
+      g_assert_not_reached ();
+      return TRUE;
+  }
+}
+
+static void
+swfdec_player_pool_run (gpointer entryp, gpointer poolp)
+{
+  SwfdecPlayerPoolEntry *entry = entryp;
+  SwfdecPlayerPool *pool = poolp;
+  SwfdecPlayerPoolPrivate *priv = pool->priv;
+  SwfdecPlayerPoolJob *job;
+  gulong max_runtime;
+  gsize max_memory, cache_size;
+
+  g_mutex_lock (priv->mutex);
+  job = g_queue_peek_head (&entry->jobs);
+  max_runtime = priv->max_runtime;
+  max_memory = priv->max_memory;
+  cache_size = priv->cache_size / g_hash_table_size (priv->players);
+  g_mutex_unlock (priv->mutex);
+
+  /* apply the limits while nobody else is using the player */
+  if (max_runtime && swfdec_player_get_maximum_runtime (entry->player) != max_runtime)
+    swfdec_player_set_maximum_runtime (entry->player, max_runtime);
+  if (max_memory)
+    swfdec_as_context_set_max_memory (SWFDEC_AS_CONTEXT (entry->player), max_memory);
+  if (cache_size)
+    swfdec_renderer_set_max_cache_size (swfdec_player_get_renderer (entry->player), cache_size);
+
+  g_assert (job);
+  if (swfdec_player_pool_job_run (job, entry->player)) {
+    g_mutex_lock (priv->mutex);
+    g_queue_pop_head (&entry->jobs);
+    g_mutex_unlock (priv->mutex);
+    swfdec_player_pool_job_free (job);
+  }
+
+  g_mutex_lock (priv->mutex);
+  if (g_queue_is_empty (&entry->jobs)) {
+    entry->busy = FALSE;
+    priv->n_busy--;
+    g_cond_broadcast (priv->cond);
+  } else {
+    /* queue at the end, so other players get their turn */
+    g_thread_pool_push (priv->threads, entry, NULL);
+  }
+  g_mutex_unlock (priv->mutex);
+}
+
+static void
+swfdec_player_pool_entry_free (gpointer entryp)
+{
+  SwfdecPlayerPoolEntry *entry = entryp;
+
+  g_assert (!entry->busy);
+  g_assert (g_queue_is_empty (&entry->jobs));
+  g_object_unref (entry->player);
+  g_slice_free (SwfdecPlayerPoolEntry, entry);
+}
+
+static void
+swfdec_player_pool_queue (SwfdecPlayerPool *pool, SwfdecPlayer *player,
+    SwfdecPlayerPoolJob *job)
+{
+  SwfdecPlayerPoolPrivate *priv = pool->priv;
+  SwfdecPlayerPoolEntry *entry;
+
+  g_mutex_lock (priv->mutex);
+  entry = g_hash_table_lookup (priv->players, player);
+  if (entry == NULL) {
+    g_mutex_unlock (priv->mutex);
+    g_critical ("player %p is not in player pool %p", player, pool);
+    swfdec_player_pool_job_free (job);
+    return;
+  }
+  g_queue_push_tail (&entry->jobs, job);
+  if (!entry->busy) {
+    entry->busy = TRUE;
+    priv->n_busy++;
+    g_thread_pool_push (priv->threads, entry, NULL);
+  }
+  g_mutex_unlock (priv->mutex);
+}
+
+static void
+swfdec_player_pool_dispose (GObject *object)
+{
+  SwfdecPlayerPool *pool = SWFDEC_PLAYER_POOL (object);
+  SwfdecPlayerPoolPrivate *priv = pool->priv;
+
+  if (priv->threads) {
+    swfdec_player_pool_wait (pool, NULL);
+    g_thread_pool_free (priv->threads, FALSE, TRUE);
+    priv->threads = NULL;
+  }
+  if (priv->players) {
+    g_hash_table_destroy (priv->players);
+    priv->players = NULL;
+  }
+
+  G_OBJECT_CLASS (swfdec_player_pool_parent_class)->dispose (object);
+}
+
+static void
+swfdec_player_pool_finalize (GObject *object)
+{
+  SwfdecPlayerPool *pool = SWFDEC_PLAYER_POOL (object);
+
+  g_mutex_free (pool->priv->mutex);
+  g_cond_free (pool->priv->cond);
+
+  G_OBJECT_CLASS (swfdec_player_pool_parent_class)->finalize (object);
+}
+
+static void
+swfdec_player_pool_constructed (GObject *object)
+{
+  SwfdecPlayerPool *pool = SWFDEC_PLAYER_POOL (object);
+
+  /* non-exclusive thread pools never fail to be created */
+  pool->priv->threads = g_thread_pool_new (swfdec_player_pool_run, pool, 
+      pool->priv->n_threads, FALSE, NULL);
+
+  if (G_OBJECT_CLASS (swfdec_player_pool_parent_class)->constructed)
+    G_OBJECT_CLASS (swfdec_player_pool_parent_class)->constructed (object);
+}
+
+static void
+swfdec_player_pool_get_property (GObject *object, guint param_id, GValue *value,
+    GParamSpec *pspec)
+{
+  SwfdecPlayerPool *pool = SWFDEC_PLAYER_POOL (object);
+
+  switch (param_id) {
+    case PROP_N_THREADS:
+      g_value_set_uint (value, pool->priv->n_threads);
+      break;
+    case PROP_MAX_RUNTIME:
+      g_value_set_ulong (value, swfdec_player_pool_get_maximum_runtime (pool));
+      break;
+    case PROP_MAX_MEMORY:
+      g_value_set_ulong (value, swfdec_player_pool_get_maximum_memory (pool));
+      break;
+    case PROP_CACHE_SIZE:
+      g_value_set_ulong (value, swfdec_player_pool_get_cache_size (pool));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
+      break;
+  }
+}
+
+static void
+swfdec_player_pool_set_property (GObject *object, guint param_id, const GValue *value,
+    GParamSpec *pspec)
+{
+  SwfdecPlayerPool *pool = SWFDEC_PLAYER_POOL (object);
+
+  switch (param_id) {
+    case PROP_N_THREADS:
+      pool->priv->n_threads = g_value_get_uint (value);
+      break;
+    case PROP_MAX_RUNTIME:
+      swfdec_player_pool_set_maximum_runtime (pool, g_value_get_ulong (value));
+      break;
+    case PROP_MAX_MEMORY:
+      swfdec_player_pool_set_maximum_memory (pool, g_value_get_ulong (value));
+      break;
+    case PROP_CACHE_SIZE:
+      swfdec_player_pool_set_cache_size (pool, g_value_get_ulong (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
+      break;
+  }
+}
+
+static void
+swfdec_player_pool_class_init (SwfdecPlayerPoolClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (SwfdecPlayerPoolPrivate));
+
+  object_class->dispose = swfdec_player_pool_dispose;
+  object_class->finalize = swfdec_player_pool_finalize;
+  object_class->constructed = swfdec_player_pool_constructed;
+  object_class->get_property = swfdec_player_pool_get_property;
+  object_class->set_property = swfdec_player_pool_set_property;
+
+  g_object_class_install_property (object_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "n threads", "number of threads processing the players",
+	  1, G_MAXUINT, 1, G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+  g_object_class_install_property (object_class, PROP_MAX_RUNTIME,
+      g_param_spec_ulong ("max-runtime", "maximum runtime", "maximum time in msecs scripts may run in a player or 0 for the player's setting",
+	  0, G_MAXULONG, 0, G_PARAM_READWRITE));
+  /* FIXME: should be g_param_spec_size(), but no such thing exists */
+  g_object_class_install_property (object_class, PROP_MAX_MEMORY,
+      g_param_spec_ulong ("max-memory", "maximum memory", "maximum memory scripts in a player may use or 0 for no limit",
+	  0, G_MAXULONG, 0, G_PARAM_READWRITE));
+  g_object_class_install_property (object_class, PROP_CACHE_SIZE,
+      g_param_spec_ulong ("cache-size", "cache size", "size of all players' renderer caches or 0 for the renderers' settings",
+	  0, G_MAXULONG, 0, G_PARAM_READWRITE));
+}
+
+static void
+swfdec_player_pool_init (SwfdecPlayerPool *pool)
+{
+  SwfdecPlayerPoolPrivate *priv;
+
+  pool->priv = priv = G_TYPE_INSTANCE_GET_PRIVATE (pool, SWFDEC_TYPE_PLAYER_POOL, SwfdecPlayerPoolPrivate);
+
+  priv->mutex = g_mutex_new ();
+  priv->cond = g_cond_new ();
+  priv->players = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+      NULL, swfdec_player_pool_entry_free);
+}
+
+/*** PUBLIC API ***/
+
+/**
+ * swfdec_player_pool_new:
+ * @n_threads: number of threads to use, must be at least 1
+ *
+ * Creates a new pool for running players in parallel.
+ *
+ * Returns: a new #SwfdecPlayerPool
+ **/
+SwfdecPlayerPool *
+swfdec_player_pool_new (guint n_threads)
+{
+  g_return_val_if_fail (n_threads > 0, NULL);
+
+  return g_object_new (SWFDEC_TYPE_PLAYER_POOL, "n-threads", n_threads, NULL);
+}
+
+/**
+ * swfdec_player_pool_get_n_threads:
+ * @pool: a #SwfdecPlayerPool
+ *
+ * Queries the number of threads @pool uses.
+ *
+ * Returns: the number of threads
+ **/
+guint
+swfdec_player_pool_get_n_threads (SwfdecPlayerPool *pool)
+{
+  g_return_val_if_fail (SWFDEC_IS_PLAYER_POOL (pool), 1);
+
+  return pool->priv->n_threads;
+}
+
+/**
+ * swfdec_player_pool_get_maximum_runtime:
+ * @pool: a #SwfdecPlayerPool
+ *
+ * Queries the maximum runtime set on players by @pool. See 
+ * swfdec_player_pool_set_maximum_runtime() for details.
+ *
+ * Returns: the maximum runtime in msecs or 0 if the players' settings are used
+ **/
+gulong
+swfdec_player_pool_get_maximum_runtime (SwfdecPlayerPool *pool)
+{
+  gulong ret;
+
+  g_return_val_if_fail (SWFDEC_IS_PLAYER_POOL (pool), 0);
+
+  g_mutex_lock (pool->priv->mutex);
+  ret = pool->priv->max_runtime;
+  g_mutex_unlock (pool->priv->mutex);
+
+  return ret;
+}
+
+/**
+ * swfdec_player_pool_set_maximum_runtime:
+ * @pool: a #SwfdecPlayerPool
+ * @msecs: maximum runtime in msecs or 0 to use the players' settings
+ *
+ * Sets the maximum runtime of all players in @pool. The value will be set on 
+ * the players with swfdec_player_set_maximum_runtime() before they are 
+ * processed the next time.
+ **/
+void
+swfdec_player_pool_set_maximum_runtime (SwfdecPlayerPool *pool, gulong msecs)
+{
+  g_return_if_fail (SWFDEC_IS_PLAYER_POOL (pool));
+
+  g_mutex_lock (pool->priv->mutex);
+  pool->priv->max_runtime = msecs;
+  g_mutex_unlock (pool->priv->mutex);
+  g_object_notify (G_OBJECT (pool), "max-runtime");
+}
+
+/**
+ * swfdec_player_pool_get_maximum_memory:
+ * @pool: a #SwfdecPlayerPool
+ *
+ * Queries the maximum amount of memory the script engine of players in @pool 
+ * may use. See swfdec_player_pool_set_maximum_memory() for details.
+ *
+ * Returns: the maximum memory in bytes or 0 if unlimited
+ **/
+gsize
+swfdec_player_pool_get_maximum_memory (SwfdecPlayerPool *pool)
+{
+  gsize ret;
+
+  g_return_val_if_fail (SWFDEC_IS_PLAYER_POOL (pool), 0);
+
+  g_mutex_lock (pool->priv->mutex);
+  ret = pool->priv->max_memory;
+  g_mutex_unlock (pool->priv->mutex);
+
+  return ret;
+}
+
+/**
+ * swfdec_player_pool_set_maximum_memory:
+ * @pool: a #SwfdecPlayerPool
+ * @bytes: maximum amount of memory in bytes or 0 for no limit
+ *
+ * Sets the maximum amount of memory the script engine of each player in @pool 
+ * may use. Players exceeding this limit will abort script execution with an
+ * out of memory error.
+ **/
+void
+swfdec_player_pool_set_maximum_memory (SwfdecPlayerPool *pool, gsize bytes)
+{
+  g_return_if_fail (SWFDEC_IS_PLAYER_POOL (pool));
+
+  g_mutex_lock (pool->priv->mutex);
+  pool->priv->max_memory = bytes;
+  g_mutex_unlock (pool->priv->mutex);
+  g_object_notify (G_OBJECT (pool), "max-memory");
+}
+
+/**
+ * swfdec_player_pool_get_cache_size:
+ * @pool: a #SwfdecPlayerPool
+ *
+ * Queries the budget for the caches of all players' renderers. See 
+ * swfdec_player_pool_set_cache_size() for details.
+ *
+ * Returns: the size in bytes or 0 if the renderers' settings are used
+ **/
+gsize
+swfdec_player_pool_get_cache_size (SwfdecPlayerPool *pool)
+{
+  gsize ret;
+
+  g_return_val_if_fail (SWFDEC_IS_PLAYER_POOL (pool), 0);
+
+  g_mutex_lock (pool->priv->mutex);
+  ret = pool->priv->cache_size;
+  g_mutex_unlock (pool->priv->mutex);
+
+  return ret;
+}
+
+/**
+ * swfdec_player_pool_set_cache_size:
+ * @pool: a #SwfdecPlayerPool
+ * @bytes: size in bytes or 0 to use the renderers' settings
+ *
+ * Sets the amount of memory all the caches of the renderers of the players 
+ * in @pool may use together. This size will be split evenly between all 
+ * players in the pool.
+ **/
+void
+swfdec_player_pool_set_cache_size (SwfdecPlayerPool *pool, gsize bytes)
+{
+  g_return_if_fail (SWFDEC_IS_PLAYER_POOL (pool));
+
+  g_mutex_lock (pool->priv->mutex);
+  pool->priv->cache_size = bytes;
+  g_mutex_unlock (pool->priv->mutex);
+  g_object_notify (G_OBJECT (pool), "cache-size");
+}
+
+/**
+ * swfdec_player_pool_add:
+ * @pool: a #SwfdecPlayerPool
+ * @player: a player that is not part of any pool yet
+ *
+ * Adds @player to the players processed by @pool. From now on, the @player 
+ * must not be accessed from outside the @pool, unless no work is queued for it.
+ **/
+void
+swfdec_player_pool_add (SwfdecPlayerPool *pool, SwfdecPlayer *player)
+{
+  SwfdecPlayerPoolPrivate *priv;
+  SwfdecPlayerPoolEntry *entry;
+
+  g_return_if_fail (SWFDEC_IS_PLAYER_POOL (pool));
+  g_return_if_fail (SWFDEC_IS_PLAYER (player));
+
+  priv = pool->priv;
+  entry = g_slice_new0 (SwfdecPlayerPoolEntry);
+  entry->player = g_object_ref (player);
+  g_queue_init (&entry->jobs);
+
+  g_mutex_lock (priv->mutex);
+  if (g_hash_table_lookup (priv->players, player)) {
+    g_mutex_unlock (priv->mutex);
+    swfdec_player_pool_entry_free (entry);
+    g_return_if_reached ();
+  }
+  g_hash_table_insert (priv->players, player, entry);
+  g_mutex_unlock (priv->mutex);
+}
+
+/**
+ * swfdec_player_pool_remove:
+ * @pool: a #SwfdecPlayerPool
+ * @player: a player in @pool
+ *
+ * Waits until all work queued for @player is done and then removes it from 
+ * @pool.
+ **/
+void
+swfdec_player_pool_remove (SwfdecPlayerPool *pool, SwfdecPlayer *player)
+{
+  SwfdecPlayerPoolPrivate *priv;
+  SwfdecPlayerPoolEntry *entry;
+
+  g_return_if_fail (SWFDEC_IS_PLAYER_POOL (pool));
+  g_return_if_fail (SWFDEC_IS_PLAYER (player));
+
+  priv = pool->priv;
+  g_mutex_lock (priv->mutex);
+  entry = g_hash_table_lookup (priv->players, player);
+  if (entry == NULL) {
+    g_mutex_unlock (priv->mutex);
+    g_return_if_reached ();
+  }
+  while (entry->busy)
+    g_cond_wait (priv->cond, priv->mutex);
+  g_hash_table_steal (priv->players, player);
+  g_mutex_unlock (priv->mutex);
+
+  swfdec_player_pool_entry_free (entry);
+}
+
+/**
+ * swfdec_player_pool_advance:
+ * @pool: a #SwfdecPlayerPool
+ * @player: a player in @pool
+ * @msecs: number of msecs to advance @player
+ *
+ * Queues a call to swfdec_player_advance() for @player. The function returns
+ * immediately, use swfdec_player_pool_wait() to wait for the advance to happen.
+ **/
+void
+swfdec_player_pool_advance (SwfdecPlayerPool *pool, SwfdecPlayer *player,
+    gulong msecs)
+{
+  SwfdecPlayerPoolJob *job;
+
+  g_return_if_fail (SWFDEC_IS_PLAYER_POOL (pool));
+  g_return_if_fail (SWFDEC_IS_PLAYER (player));
+
+  if (msecs == 0)
+    return;
+
+  job = g_slice_new0 (SwfdecPlayerPoolJob);
+  job->type = SWFDEC_PLAYER_POOL_ADVANCE;
+  job->msecs = msecs;
+  swfdec_player_pool_queue (pool, player, job);
+}
+
+/**
+ * swfdec_player_pool_render:
+ * @pool: a #SwfdecPlayerPool
+ * @player: a player in @pool
+ * @cr: cairo context to render to
+ *
+ * Queues a call to swfdec_player_render() for @player. The function returns
+ * immediately, use swfdec_player_pool_wait() to wait for the rendering to 
+ * happen. The @pool keeps a reference to @cr until the rendering is done. You
+ * must not use @cr or its target surface until then.
+ **/
+void
+swfdec_player_pool_render (SwfdecPlayerPool *pool, SwfdecPlayer *player,
+    cairo_t *cr)
+{
+  SwfdecPlayerPoolJob *job;
+
+  g_return_if_fail (SWFDEC_IS_PLAYER_POOL (pool));
+  g_return_if_fail (SWFDEC_IS_PLAYER (player));
+  g_return_if_fail (cr != NULL);
+
+  job = g_slice_new0 (SwfdecPlayerPoolJob);
+  job->type = SWFDEC_PLAYER_POOL_RENDER;
+  job->cr = cairo_reference (cr);
+  swfdec_player_pool_queue (pool, player, job);
+}
+
+/**
+ * swfdec_player_pool_wait:
+ * @pool: a #SwfdecPlayerPool
+ * @player: a player in @pool or %NULL to wait for all players
+ *
+ * Waits until all work queued for @player is done. After this function 
+ * returns, you may access @player again until you queue new work for it.
+ **/
+void
+swfdec_player_pool_wait (SwfdecPlayerPool *pool, SwfdecPlayer *player)
+{
+  SwfdecPlayerPoolPrivate *priv;
+  SwfdecPlayerPoolEntry *entry;
+
+  g_return_if_fail (SWFDEC_IS_PLAYER_POOL (pool));
+  g_return_if_fail (player == NULL || SWFDEC_IS_PLAYER (player));
+
+  priv = pool->priv;
+  g_mutex_lock (priv->mutex);
+  if (player) {
+    entry = g_hash_table_lookup (priv->players, player);
+    while (entry && entry->busy)
+      g_cond_wait (priv->cond, priv->mutex);
+  } else {
+    while (priv->n_busy > 0)
+      g_cond_wait (priv->cond, priv->mutex);
+  }
+  g_mutex_unlock (priv->mutex);
+}
@@ -0,0 +1,89 @@
+/* Swfdec
+ * Copyright (c) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, 
+ * Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef _SWFDEC_PLAYER_POOL_H_
+#define _SWFDEC_PLAYER_POOL_H_
+
+#include <cairo.h>
+#include <swfdec/swfdec_player.h>
+
+G_BEGIN_DECLS
+
+typedef struct _SwfdecPlayerPool SwfdecPlayerPool;
+typedef struct _SwfdecPlayerPoolPrivate SwfdecPlayerPoolPrivate;
+typedef struct _SwfdecPlayerPoolClass SwfdecPlayerPoolClass;
+
+#define SWFDEC_TYPE_PLAYER_POOL                    (swfdec_player_pool_get_type())
+#define SWFDEC_IS_PLAYER_POOL(obj)                 (G_TYPE_CHECK_INSTANCE_TYPE ((obj), SWFDEC_TYPE_PLAYER_POOL))
+#define SWFDEC_IS_PLAYER_POOL_CLASS(klass)         (G_TYPE_CHECK_CLASS_TYPE ((klass), SWFDEC_TYPE_PLAYER_POOL))
+#define SWFDEC_PLAYER_POOL(obj)                    (G_TYPE_CHECK_INSTANCE_CAST ((obj), SWFDEC_TYPE_PLAYER_POOL, SwfdecPlayerPool))
+#define SWFDEC_PLAYER_POOL_CLASS(klass)            (G_TYPE_CHECK_CLASS_CAST ((klass), SWFDEC_TYPE_PLAYER_POOL, SwfdecPlayerPoolClass))
+#define SWFDEC_PLAYER_POOL_GET_CLASS(obj)          (G_TYPE_INSTANCE_GET_CLASS ((obj), SWFDEC_TYPE_PLAYER_POOL, SwfdecPlayerPoolClass))
+
+struct _SwfdecPlayerPool {
+  GObject		object;
+
+  /*< private >*/
+  SwfdecPlayerPoolPrivate *priv;
+};
+
+struct _SwfdecPlayerPoolClass
+{
+  /*< private >*/
+  GObjectClass		object_class;
+};
+
+GType			swfdec_player_pool_get_type	(void);
+
+SwfdecPlayerPool *	swfdec_player_pool_new		(guint			n_threads);
+
+guint			swfdec_player_pool_get_n_threads(SwfdecPlayerPool *	pool);
+gulong			swfdec_player_pool_get_maximum_runtime
+							(SwfdecPlayerPool *	pool);
+void			swfdec_player_pool_set_maximum_runtime
+							(SwfdecPlayerPool *	pool,
+							 gulong			msecs);
+gsize			swfdec_player_pool_get_maximum_memory
+							(SwfdecPlayerPool *	pool);
+void			swfdec_player_pool_set_maximum_memory
+							(SwfdecPlayerPool *	pool,
+							 gsize			bytes);
+gsize			swfdec_player_pool_get_cache_size
+							(SwfdecPlayerPool *	pool);
+void			swfdec_player_pool_set_cache_size
+							(SwfdecPlayerPool *	pool,
+							 gsize			bytes);
+
+void			swfdec_player_pool_add		(SwfdecPlayerPool *	pool,
+							 SwfdecPlayer *		player);
+void			swfdec_player_pool_remove	(SwfdecPlayerPool *	pool,
+							 SwfdecPlayer *		player);
+void			swfdec_player_pool_advance	(SwfdecPlayerPool *	pool,
+							 SwfdecPlayer *		player,
+							 gulong			msecs);
+void			swfdec_player_pool_render	(SwfdecPlayerPool *	pool,
+							 SwfdecPlayer *		player,
+							 cairo_t *		cr);
+void			swfdec_player_pool_wait		(SwfdecPlayerPool *	pool,
+							 SwfdecPlayer *		player);
+
+
+G_END_DECLS
+#endif
@@ -302,6 +302,15 @@ swfdec_renderer_get_max_cache_size (SwfdecRenderer *renderer)
   return swfdec_cache_get_max_cache_size (renderer->priv->cache);
 }
 
+void
+swfdec_renderer_set_max_cache_size (SwfdecRenderer *renderer, gsize size)
+{
+  g_return_if_fail (SWFDEC_IS_RENDERER (renderer));
+
+  if (swfdec_cache_get_max_cache_size (renderer->priv->cache) != size)
+    swfdec_cache_set_max_cache_size (renderer->priv->cache, size);
+}
+
 SwfdecRenderer *
 swfdec_renderer_new_default (SwfdecPlayer *player)
 {
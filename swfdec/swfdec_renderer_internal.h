@@ -48,6 +48,9 @@ SwfdecCached *		swfdec_renderer_get_cache	(SwfdecRenderer *	renderer,
 							 gpointer		data);
 gsize			swfdec_renderer_get_max_cache_size
 							(SwfdecRenderer *	renderer);
+void			swfdec_renderer_set_max_cache_size
+							(SwfdecRenderer *	renderer,
+							 gsize			size);
 
 cairo_surface_t *	swfdec_renderer_create_similar	(SwfdecRenderer *	renderer,
 							 cairo_surface_t *	surface);
@@ -34,6 +34,7 @@
 #include "swfdec_debug.h"
 #include "swfdec_decoder.h"
 #include "swfdec_image_decoder.h"
+#include "swfdec_internal.h"
 #include "swfdec_loader_internal.h"
 #include "swfdec_movie_clip_loader.h"
 #include "swfdec_player_internal.h"
@@ -88,6 +89,7 @@ swfdec_resource_stream_target_image (SwfdecResource *instance)
       movie->sprite = dec->main_sprite;
       g_assert (movie->sprite->parse_frame > 0);
       movie->n_frames = movie->sprite->n_frames;
+      swfdec_actor_activate (SWFDEC_ACTOR (movie));
       swfdec_movie_invalidate_last (SWFDEC_MOVIE (movie));
       swfdec_sandbox_use (instance->sandbox);
       swfdec_as_object_set_constructor_by_name (swfdec_as_relay_get_as_object (
@@ -231,6 +233,27 @@ swfdec_resource_stream_target_open (SwfdecStreamTarget *target, SwfdecStream *st
   instance->state = SWFDEC_RESOURCE_OPENED;
 }
 
+static char *
+swfdec_resource_checksum_queue (SwfdecBufferQueue *queue)
+{
+  GChecksum *checksum;
+  SwfdecBufferQueueIter iter = { NULL, 0, 0 };
+  SwfdecBuffer *buffer;
+  gsize offset = 0;
+  char *ret;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA1);
+  while ((buffer = swfdec_buffer_queue_peek_buffer_at (queue, offset, &iter))) {
+    g_checksum_update (checksum, buffer->data, buffer->length);
+    offset += buffer->length;
+    swfdec_buffer_unref (buffer);
+  }
+  ret = g_strdup (g_checksum_get_string (checksum));
+  g_checksum_free (checksum);
+
+  return ret;
+}
+
 static gboolean
 swfdec_resource_stream_target_parse (SwfdecStreamTarget *target, SwfdecStream *stream)
 {
@@ -244,14 +267,25 @@ swfdec_resource_stream_target_parse (SwfdecStreamTarget *target, SwfdecStream *s
 
   queue = swfdec_stream_get_queue (stream);
   if (dec == NULL && swfdec_buffer_queue_get_offset (queue) == 0) {
+    SwfdecSwfDecoder *shared = NULL;
     if (swfdec_buffer_queue_get_depth (queue) < SWFDEC_DECODER_DETECT_LENGTH)
       return FALSE;
     buffer = swfdec_buffer_queue_peek (queue, 4);
     dec = swfdec_decoder_new (buffer);
     swfdec_buffer_unref (buffer);
+    /* if we have the whole file, another player might have parsed it already */
+    if (SWFDEC_IS_SWF_DECODER (dec) && swfdec_stream_is_complete (stream)) {
+      resource->checksum = swfdec_resource_checksum_queue (queue);
+      shared = swfdec_swf_decoder_get_shared (resource->checksum);
+      if (shared) {
+	SWFDEC_INFO ("using shared decoder for %s", swfdec_stream_describe (stream));
+	g_object_unref (dec);
+	dec = SWFDEC_DECODER (shared);
+      }
+    }
     if (dec == NULL) {
       SWFDEC_ERROR ("no decoder found for format");
-    } else {
+    } else if (shared == NULL) {
       glong total;
       resource->decoder = dec;
       g_signal_connect_swapped (dec, "missing-plugin", 
@@ -260,6 +294,26 @@ swfdec_resource_stream_target_parse (SwfdecStreamTarget *target, SwfdecStream *s
       if (total >= 0)
 	dec->bytes_total = total;
     }
+    if (shared) {
+      GSList *walk;
+      resource->decoder = dec;
+      resource->shared = TRUE;
+      /* the decoder is done, so it only tells us the plugins it missed */
+      for (walk = dec->missing_plugins; walk; walk = walk->next) {
+	swfdec_player_add_missing_plugin (SWFDEC_PLAYER (swfdec_gc_object_get_context (resource)),
+	    walk->data);
+      }
+      swfdec_buffer_queue_flush (queue, swfdec_buffer_queue_get_depth (queue));
+      resource->version = shared->version;
+      if (swfdec_resource_is_root (resource)) {
+	swfdec_player_initialize (SWFDEC_PLAYER (swfdec_gc_object_get_context (resource)),
+	    dec->rate, dec->width, dec->height);
+      }
+      if (shared->main_sprite->parse_frame > 0)
+	swfdec_resource_stream_target_image (resource);
+      swfdec_resource_emit_signal (resource, SWFDEC_AS_STR_onLoadProgress, TRUE, NULL, 0);
+      return FALSE;
+    }
   }
   while (swfdec_buffer_queue_get_depth (queue)) {
     parsed = 0;
@@ -324,7 +378,15 @@ swfdec_resource_stream_target_close (SwfdecStreamTarget *target, SwfdecStream *s
   swfdec_resource_emit_signal (resource, SWFDEC_AS_STR_onLoadProgress, TRUE, NULL, 0);
   if (resource->decoder) {
     SwfdecDecoder *dec = resource->decoder;
-    swfdec_decoder_eof (dec);
+    /* shared decoders are completely parsed already */
+    if (!resource->shared) {
+      swfdec_decoder_eof (dec);
+      /* the decoder may be used by other players now, don't keep our handler */
+      g_signal_handlers_disconnect_by_func (dec,
+	  swfdec_player_add_missing_plugin, swfdec_gc_object_get_context (resource));
+      if (resource->checksum && SWFDEC_IS_SWF_DECODER (dec))
+	swfdec_swf_decoder_share (SWFDEC_SWF_DECODER (dec), resource->checksum);
+    }
     if (dec->data_type != SWFDEC_LOADER_DATA_UNKNOWN)
       swfdec_loader_set_data_type (SWFDEC_LOADER (stream), dec->data_type);
   }
@@ -406,12 +468,15 @@ swfdec_resource_dispose (GObject *object)
     resource->loader = NULL;
   }
   if (resource->decoder) {
-    g_signal_handlers_disconnect_by_func (resource->decoder,
+    if (!resource->shared) {
+      g_signal_handlers_disconnect_by_func (resource->decoder,
 	  swfdec_player_add_missing_plugin, swfdec_gc_object_get_context (resource));
+    }
     g_object_unref (resource->decoder);
     resource->decoder = NULL;
   }
   g_free (resource->variables);
+  g_free (resource->checksum);
   g_hash_table_destroy (resource->exports);
   g_hash_table_destroy (resource->export_names);
 
@@ -63,6 +63,8 @@ struct _SwfdecResource
   SwfdecMovie *		target;		/* target path we use for signalling */
   SwfdecMovieClipLoader *clip_loader;	/* loader that gets notified about load events */
   SwfdecSandbox *	clip_loader_sandbox; /* sandbox used for events on the clip loader */
+  char *		checksum;	/* checksum of the complete file or NULL if not known */
+  gboolean		shared;		/* decoder was parsed by another resource */
 };
 
 struct _SwfdecResourceClass
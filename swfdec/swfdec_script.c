@@ -21,10 +21,13 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include "swfdec_script.h"
 #include "swfdec_script_internal.h"
 #include "swfdec_as_context.h"
 #include "swfdec_as_interpret.h"
+#include "swfdec_as_strings.h"
 #include "swfdec_debug.h"
 
 /**
@@ -76,6 +79,272 @@ validate_action (gconstpointer bytecode, guint action, const guint8 *data, guint
   return TRUE;
 }
 
+/*** ANALYSIS ***/
+
+/* Functions get an activation object with this, arguments and super set on
+ * every call. Creating the arguments array in particular is expensive, so we
+ * inspect the bytecode to find out if the variables can be looked up at all.
+ * This is the case if their name appears in a constant pool or Push action -
+ * either on its own or as part of a path like "this.foo" - or if a variable is
+ * looked up using a name that was computed at runtime (like eval() does).
+ * Actions that resolve a path taken from the stack, like SetVariable or 
+ * GetProperty, could always compute one of these names, so they are assumed
+ * to use all of them. Nested functions are part of the bytecode, so uses
+ * inside closures are found, too. */
+
+typedef struct {
+  guint			uses;		/* SwfdecScriptUses found so far */
+  GHashTable *		targets;	/* bytecode => bytecode of jump targets */
+  gboolean		literal;	/* last action pushed a string or constant */
+} SwfdecScriptAnalysis;
+
+static gboolean
+swfdec_script_analyze_name (const char *s, gsize len, const char *name)
+{
+  /* names are case-insensitive before Flash 7 */
+  return strlen (name) == len && g_ascii_strncasecmp (s, name, len) == 0;
+}
+
+static void
+swfdec_script_analyze_string (SwfdecScriptAnalysis *analysis, const char *s)
+{
+  gsize len;
+
+  do {
+    len = strcspn (s, ".:/");
+    if (swfdec_script_analyze_name (s, len, SWFDEC_AS_STR_this))
+      analysis->uses |= SWFDEC_SCRIPT_USES_THIS;
+    else if (swfdec_script_analyze_name (s, len, SWFDEC_AS_STR_arguments))
+      analysis->uses |= SWFDEC_SCRIPT_USES_ARGS;
+    else if (swfdec_script_analyze_name (s, len, SWFDEC_AS_STR_super))
+      analysis->uses |= SWFDEC_SCRIPT_USES_SUPER;
+    s += len;
+  } while (*s++);
+}
+
+/* data is the data of a ConstantPool action */
+static void
+swfdec_script_analyze_constant_pool (SwfdecScriptAnalysis *analysis, 
+    const guint8 *data, guint len)
+{
+  const guint8 *end;
+
+  if (len < 2)
+    return;
+  for (end = data + len, data += 2; data < end; data++) {
+    const guint8 *s = memchr (data, 0, end - data);
+    if (s == NULL) {
+      analysis->uses = SWFDEC_SCRIPT_USES_ALL;
+      return;
+    }
+    swfdec_script_analyze_string (analysis, (const char *) data);
+    data = s;
+  }
+}
+
+static void
+swfdec_script_analyze_push (SwfdecScriptAnalysis *analysis, const guint8 *data, guint len)
+{
+  static const int sizes[] = { -1, 4, 0, 0, 1, 1, 8, 4, 1, 2 };
+  const guint8 *end = data + len;
+  guint type;
+
+  analysis->literal = FALSE;
+  while (data < end) {
+    type = *data++;
+    if (type >= G_N_ELEMENTS (sizes)) {
+      analysis->uses = SWFDEC_SCRIPT_USES_ALL;
+      return;
+    } else if (sizes[type] < 0) {
+      const guint8 *s = memchr (data, 0, end - data);
+      if (s == NULL) {
+	analysis->uses = SWFDEC_SCRIPT_USES_ALL;
+	return;
+      }
+      swfdec_script_analyze_string (analysis, (const char *) data);
+      data = s + 1;
+    } else {
+      data += sizes[type];
+    }
+    analysis->literal = type == 0 || type == 8 || type == 9;
+  }
+}
+
+static gboolean
+swfdec_script_analyze_jumps (gconstpointer bytecode, guint action, 
+    const guint8 *data, guint len, gpointer analysisp)
+{
+  SwfdecScriptAnalysis *analysis = analysisp;
+  const guint8 *target;
+
+  /* Jump and If */
+  if ((action == 0x99 || action == 0x9D) && len == 2) {
+    target = data + 2 + (gint16) (data[0] | data[1] << 8);
+    g_hash_table_insert (analysis->targets, (gpointer) target, (gpointer) target);
+  }
+  return TRUE;
+}
+
+static gboolean
+swfdec_script_analyze_action (gconstpointer bytecode, guint action, 
+    const guint8 *data, guint len, gpointer analysisp)
+{
+  SwfdecScriptAnalysis *analysis = analysisp;
+
+  switch (action) {
+    case 0x1C: /* GetVariable */
+    case 0x3B: /* Delete2 */
+    case 0x3D: /* CallFunction */
+    case 0x46: /* Enumerate */
+      /* the name of the variable was computed at runtime */
+      if (!analysis->literal || g_hash_table_lookup (analysis->targets, bytecode))
+	analysis->uses = SWFDEC_SCRIPT_USES_ALL;
+      break;
+    case 0x1D: /* SetVariable */
+    case 0x20: /* SetTarget2 */
+    case 0x22: /* GetProperty */
+    case 0x23: /* SetProperty */
+    case 0x24: /* CloneSprite */
+    case 0x25: /* RemoveSprite */
+    case 0x27: /* StartDrag */
+    case 0x9A: /* GetURL2 */
+    case 0x9E: /* Call */
+    case 0x9F: /* GotoFrame2 */
+      /* these resolve a path taken from the stack, often from below the top,
+       * so we don't know if it was pushed as a literal */
+      analysis->uses = SWFDEC_SCRIPT_USES_ALL;
+      break;
+    case 0x55: /* Enumerate2 */
+    case 0x8E: /* DefineFunction2 */
+    case 0x9B: /* DefineFunction */
+      /* a function called through its variable in our activation object gets 
+       * the activation object as this and can return it. Once that happened, 
+       * any name may be looked up in it. */
+      analysis->uses = SWFDEC_SCRIPT_USES_ALL;
+      break;
+    case 0x88: /* ConstantPool */
+      swfdec_script_analyze_constant_pool (analysis, data, len);
+      break;
+    case 0x96: /* Push */
+      swfdec_script_analyze_push (analysis, data, len);
+      return analysis->uses != SWFDEC_SCRIPT_USES_ALL;
+    default:
+      break;
+  }
+  analysis->literal = FALSE;
+  return analysis->uses != SWFDEC_SCRIPT_USES_ALL;
+}
+
+/**
+ * swfdec_script_analyze:
+ * @script: a script
+ *
+ * Checks which of the implicit variables of a function's activation object
+ * the @script may access and stores the result in @script's uses. Scripts 
+ * are shared between players running in different threads, so this must be 
+ * done before the @script is used and again after its constant pool was set.
+ **/
+void
+swfdec_script_analyze (SwfdecScript *script)
+{
+  SwfdecScriptAnalysis analysis = { 0, NULL, FALSE };
+  SwfdecBits bits;
+
+  g_return_if_fail (script != NULL);
+
+  if (script->constant_pool) {
+    swfdec_script_analyze_constant_pool (&analysis, script->constant_pool->data,
+	script->constant_pool->length);
+  }
+  analysis.targets = g_hash_table_new (g_direct_hash, g_direct_equal);
+  swfdec_bits_init_data (&bits, script->main, script->exit - script->main);
+  if (!swfdec_script_foreach_internal (&bits, swfdec_script_analyze_jumps, &analysis)) {
+    analysis.uses = SWFDEC_SCRIPT_USES_ALL;
+  } else {
+    swfdec_bits_init_data (&bits, script->main, script->exit - script->main);
+    if (!swfdec_script_foreach_internal (&bits, swfdec_script_analyze_action, &analysis))
+      analysis.uses = SWFDEC_SCRIPT_USES_ALL;
+  }
+  g_hash_table_destroy (analysis.targets);
+
+  script->uses = analysis.uses;
+}
+
+/* scripts are shared between players running in different threads */
+G_LOCK_DEFINE_STATIC (functions);
+
+/**
+ * swfdec_script_lookup_function:
+ * @script: the script containing a DefineFunction action
+ * @pc: location of the DefineFunction action inside @script
+ * @constant_pool: the constant pool in use when the action is executed or %NULL
+ * @version: version the function will be executed with
+ *
+ * Looks up a function script that was previously created from the 
+ * DefineFunction action at @pc using swfdec_script_add_function(). This 
+ * avoids parsing and validating the function's bytecode every time the 
+ * action is executed.
+ *
+ * Returns: a new reference to the function's script or %NULL if none is 
+ *          available.
+ **/
+SwfdecScript *
+swfdec_script_lookup_function (SwfdecScript *script, const guint8 *pc,
+    SwfdecBuffer *constant_pool, guint version)
+{
+  SwfdecScript *function;
+
+  g_return_val_if_fail (script != NULL, NULL);
+  g_return_val_if_fail (pc >= script->main && pc < script->exit, NULL);
+
+  G_LOCK (functions);
+  if (script->functions == NULL) {
+    function = NULL;
+  } else {
+    function = g_hash_table_lookup (script->functions, pc);
+    /* constant pools are recreated for every frame, so compare the data */
+    if (function && function->version == version && 
+	(function->constant_pool == NULL ? constant_pool == NULL :
+	 (constant_pool != NULL &&
+	  function->constant_pool->data == constant_pool->data &&
+	  function->constant_pool->length == constant_pool->length)))
+      swfdec_script_ref (function);
+    else
+      function = NULL;
+  }
+  G_UNLOCK (functions);
+
+  return function;
+}
+
+/**
+ * swfdec_script_add_function:
+ * @script: the script containing a DefineFunction action
+ * @pc: location of the DefineFunction action inside @script
+ * @function: the script created from that action
+ *
+ * Remembers @function for the DefineFunction action at @pc, so it can be 
+ * reused by swfdec_script_lookup_function(). An already remembered function 
+ * for @pc is replaced.
+ **/
+void
+swfdec_script_add_function (SwfdecScript *script, const guint8 *pc,
+    SwfdecScript *function)
+{
+  g_return_if_fail (script != NULL);
+  g_return_if_fail (pc >= script->main && pc < script->exit);
+  g_return_if_fail (function != NULL);
+
+  G_LOCK (functions);
+  if (script->functions == NULL) {
+    script->functions = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+	NULL, (GDestroyNotify) swfdec_script_unref);
+  }
+  g_hash_table_replace (script->functions, (gpointer) pc, 
+      swfdec_script_ref (function));
+  G_UNLOCK (functions);
+}
+
 /*** PUBLIC API ***/
 
 gboolean
@@ -153,6 +422,7 @@ swfdec_script_new_from_bits (SwfdecBits *bits, const char *name, guint version)
   script->exit = buffer->data + buffer->length;
   script->buffer = swfdec_buffer_ref (swfdec_buffer_get_super (buffer));
   swfdec_buffer_unref (buffer);
+  swfdec_script_analyze (script);
   return script;
 }
 
@@ -170,7 +440,7 @@ swfdec_script_ref (SwfdecScript *script)
   g_return_val_if_fail (script != NULL, NULL);
   g_return_val_if_fail (script->refcount > 0, NULL);
 
-  script->refcount++;
+  g_atomic_int_inc (&script->refcount);
   return script;
 }
 
@@ -189,10 +459,11 @@ swfdec_script_unref (SwfdecScript *script)
   g_return_if_fail (script != NULL);
   g_return_if_fail (script->refcount > 0);
 
-  script->refcount--;
-  if (script->refcount > 0)
+  if (!g_atomic_int_dec_and_test (&script->refcount))
     return;
 
+  if (script->functions)
+    g_hash_table_destroy (script->functions);
   if (script->buffer)
     swfdec_buffer_unref (script->buffer);
   if (script->constant_pool)
@@ -42,6 +42,14 @@ typedef enum {
   SWFDEC_SCRIPT_PRELOAD_GLOBAL = (1 << 8)
 } SwfdecScriptFlag;
 
+/* implicit variables of a function's activation object the script might access */
+typedef enum {
+  SWFDEC_SCRIPT_USES_THIS = (1 << 0),
+  SWFDEC_SCRIPT_USES_ARGS = (1 << 1),
+  SWFDEC_SCRIPT_USES_SUPER = (1 << 2),
+  SWFDEC_SCRIPT_USES_ALL = (1 << 3) - 1
+} SwfdecScriptUses;
+
 typedef gboolean (* SwfdecScriptForeachFunc) (gconstpointer bytecode, guint action, 
     const guint8 *data, guint len, gpointer user_data);
 
@@ -50,7 +58,7 @@ struct _SwfdecScript {
   SwfdecBuffer *	buffer;			/* buffer holding the script */
   const guint8 *	main;			/* entry point for script */
   const guint8 *	exit;			/* exit point for script */
-  guint		 	refcount;		/* reference count */
+  volatile gint	 	refcount;		/* reference count */
   char *		name;			/* name identifying this script */
   guint			version;		/* version of the script */
   guint			n_registers;		/* number of registers */
@@ -58,6 +66,8 @@ struct _SwfdecScript {
   guint			flags;			/* SwfdecScriptFlags */
   guint			n_arguments;  		/* number of arguments */
   SwfdecScriptArgument *arguments;		/* arguments or NULL if none */
+  guint			uses;			/* SwfdecScriptUses */
+  GHashTable *		functions;		/* pc => SwfdecScript for functions defined in this script */
 };
 
 struct _SwfdecScriptArgument {
@@ -75,6 +85,14 @@ SwfdecScript *	swfdec_script_new_from_bits   		(SwfdecBits *			bits,
 gboolean	swfdec_script_foreach			(SwfdecScript *			script,
 							 SwfdecScriptForeachFunc	func,
 							 gpointer			user_data);
+void		swfdec_script_analyze			(SwfdecScript *			script);
+SwfdecScript *	swfdec_script_lookup_function		(SwfdecScript *			script,
+							 const guint8 *			pc,
+							 SwfdecBuffer *			constant_pool,
+							 guint				version);
+void		swfdec_script_add_function		(SwfdecScript *			script,
+							 const guint8 *			pc,
+							 SwfdecScript *			function);
 
 G_END_DECLS
 
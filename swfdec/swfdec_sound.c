@@ -174,8 +174,11 @@ tag_func_define_sound (SwfdecSwfDecoder * s, guint tag)
   return SWFDEC_STATUS_OK;
 }
 
-SwfdecBuffer *
-swfdec_sound_get_decoded (SwfdecSound *sound)
+/* sounds may be shared between players running in different threads */
+G_LOCK_DEFINE_STATIC (decoded);
+
+static SwfdecBuffer *
+swfdec_sound_decode (SwfdecSound *sound)
 {
   gpointer decoder;
   SwfdecBuffer *tmp;
@@ -184,11 +187,6 @@ swfdec_sound_get_decoded (SwfdecSound *sound)
   guint n_samples;
   guint depth;
 
-  g_return_val_if_fail (SWFDEC_IS_SOUND (sound), NULL);
-
-  if (sound->decoded) {
-    return sound->decoded;
-  }
   if (sound->encoded == NULL)
     return NULL;
 
@@ -235,10 +233,24 @@ swfdec_sound_get_decoded (SwfdecSound *sound)
     SWFDEC_WARNING ("%u samples in %u bytes should be available, but only %"G_GSIZE_FORMAT" bytes are",
 	n_samples, n_samples * sample_bytes, tmp->length);
   }
-  /* only assign here, the decoding code checks this variable */
-  sound->decoded = tmp;
 
-  return sound->decoded;
+  return tmp;
+}
+
+SwfdecBuffer *
+swfdec_sound_get_decoded (SwfdecSound *sound)
+{
+  SwfdecBuffer *ret;
+
+  g_return_val_if_fail (SWFDEC_IS_SOUND (sound), NULL);
+
+  G_LOCK (decoded);
+  if (sound->decoded == NULL)
+    sound->decoded = swfdec_sound_decode (sound);
+  ret = sound->decoded;
+  G_UNLOCK (decoded);
+
+  return ret;
 }
 
 void
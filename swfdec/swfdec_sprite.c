@@ -26,6 +26,7 @@
 
 #include "swfdec_sprite.h"
 #include "swfdec_debug.h"
+#include "swfdec_filter.h"
 #include "swfdec_movie.h"
 #include "swfdec_player_internal.h"
 #include "swfdec_script.h"
@@ -142,3 +143,197 @@ swfdec_sprite_get_frame (SwfdecSprite *sprite, const char *label)
   return -1;
 }
 
+
+static guint
+swfdec_sprite_place_get_clipeventflags (SwfdecBits *bits, guint version)
+{
+  if (version <= 5) {
+    return swfdec_bits_get_u16 (bits);
+  } else {
+    return swfdec_bits_get_u32 (bits);
+  }
+}
+
+/**
+ * swfdec_sprite_place_new:
+ * @bits: the contents of a PlaceObject2 or PlaceObject3 tag
+ * @tag: the tag
+ * @version: version of the file containing the tag
+ * @player: player to create filters for or %NULL
+ * @filters: pointer to take the list of filters or %NULL
+ *
+ * Parses a PlaceObject2 or PlaceObject3 tag. Filters are objects of a 
+ * player, so tags containing filters can only be parsed when a @player is 
+ * given. This allows parsing most tags only once while decoding.
+ *
+ * Returns: the parsed tag or %NULL if the tag contains filters and no player
+ *          was given
+ **/
+SwfdecSpritePlace *
+swfdec_sprite_place_new (SwfdecBits *bits, guint tag, guint version,
+    SwfdecPlayer *player, GSList **filters)
+{
+  SwfdecSpritePlace *place;
+  gboolean has_clip_actions;
+  gboolean has_clip_depth;
+  gboolean has_name;
+  gboolean has_ratio;
+  gboolean has_character;
+  gboolean cache;
+  gboolean has_blend_mode = 0;
+
+  g_return_val_if_fail (bits != NULL, NULL);
+  g_return_val_if_fail (player == NULL || SWFDEC_IS_PLAYER (player), NULL);
+  g_return_val_if_fail (player == NULL || filters != NULL, NULL);
+
+  place = g_slice_new0 (SwfdecSpritePlace);
+
+  /* 1) check which stuff is set */
+  has_clip_actions = swfdec_bits_getbit (bits);
+  has_clip_depth = swfdec_bits_getbit (bits);
+  has_name = swfdec_bits_getbit (bits);
+  has_ratio = swfdec_bits_getbit (bits);
+  place->has_ctrans = swfdec_bits_getbit (bits);
+  place->has_transform = swfdec_bits_getbit (bits);
+  has_character = swfdec_bits_getbit (bits);
+  place->move = swfdec_bits_getbit (bits);
+
+  SWFDEC_LOG ("parsing PlaceObject%d", tag == SWFDEC_TAG_PLACEOBJECT2 ? 2 : 3);
+  SWFDEC_LOG ("  has_clip_actions = %d", has_clip_actions);
+  SWFDEC_LOG ("  has_clip_depth = %d", has_clip_depth);
+  SWFDEC_LOG ("  has_name = %d", has_name);
+  SWFDEC_LOG ("  has_ratio = %d", has_ratio);
+  SWFDEC_LOG ("  has_ctrans = %d", place->has_ctrans);
+  SWFDEC_LOG ("  has_transform = %d", place->has_transform);
+  SWFDEC_LOG ("  has_character = %d", has_character);
+  SWFDEC_LOG ("  move = %d", place->move);
+
+  if (tag == SWFDEC_TAG_PLACEOBJECT3) {
+    swfdec_bits_getbits (bits, 5);
+    cache = swfdec_bits_getbit (bits);
+    has_blend_mode = swfdec_bits_getbit (bits);
+    place->has_filter = swfdec_bits_getbit (bits);
+    SWFDEC_LOG ("  cache = %d", cache);
+    SWFDEC_LOG ("  has filter = %d", place->has_filter);
+    SWFDEC_LOG ("  has blend mode = %d", has_blend_mode);
+    if (place->has_filter && player == NULL) {
+      g_slice_free (SwfdecSpritePlace, place);
+      return NULL;
+    }
+  }
+
+  /* 2) read all properties */
+  place->depth = swfdec_bits_get_u16 (bits);
+  if (place->depth >= 16384) {
+    SWFDEC_FIXME ("depth of placement too high: %u >= 16384", place->depth);
+  }
+  SWFDEC_LOG ("  depth = %d (=> %d)", place->depth, place->depth - 16384);
+  place->depth -= 16384;
+  if (has_character) {
+    place->id = swfdec_bits_get_u16 (bits);
+    SWFDEC_LOG ("  id = %d", place->id);
+  } else {
+    place->id = 0;
+  }
+
+  if (place->has_transform) {
+    swfdec_bits_get_matrix (bits, &place->transform, NULL);
+    SWFDEC_LOG ("  matrix = { %g %g, %g %g } + { %g %g }", 
+	place->transform.xx, place->transform.yx,
+	place->transform.xy, place->transform.yy,
+	place->transform.x0, place->transform.y0);
+  }
+  if (place->has_ctrans) {
+    swfdec_bits_get_color_transform (bits, &place->ctrans);
+    SWFDEC_LOG ("  color transform = %d %d  %d %d  %d %d  %d %d",
+	place->ctrans.ra, place->ctrans.rb,
+	place->ctrans.ga, place->ctrans.gb,
+	place->ctrans.ba, place->ctrans.bb,
+	place->ctrans.aa, place->ctrans.ab);
+  }
+
+  if (has_ratio) {
+    place->ratio = swfdec_bits_get_u16 (bits);
+    SWFDEC_LOG ("  ratio = %d", place->ratio);
+  } else {
+    place->ratio = -1;
+  }
+
+  if (has_name) {
+    place->name = swfdec_bits_get_string (bits, version);
+    SWFDEC_LOG ("  name = %s", place->name);
+  }
+
+  if (has_clip_depth) {
+    place->clip_depth = swfdec_bits_get_u16 (bits) - 16384;
+    SWFDEC_LOG ("  clip_depth = %d (=> %d)", place->clip_depth + 16384, place->clip_depth);
+  } else {
+    place->clip_depth = 0;
+  }
+
+  if (place->has_filter) {
+    *filters = swfdec_filter_parse (player, bits);
+  } else if (filters) {
+    *filters = NULL;
+  }
+
+  if (has_blend_mode) {
+    place->blend_mode = swfdec_bits_get_u8 (bits);
+    SWFDEC_LOG ("  blend mode = %u", place->blend_mode);
+  } else {
+    place->blend_mode = 0;
+  }
+
+  if (has_clip_actions) {
+    int reserved, clip_event_flags, event_flags, key_code;
+    char *script_name;
+
+    place->events = swfdec_event_list_new ();
+    reserved = swfdec_bits_get_u16 (bits);
+    clip_event_flags = swfdec_sprite_place_get_clipeventflags (bits, version);
+
+    if (place->name)
+      script_name = g_strdup (place->name);
+    else if (place->id)
+      script_name = g_strdup_printf ("Sprite%u", place->id);
+    else
+      script_name = g_strdup ("unknown");
+    while ((event_flags = swfdec_sprite_place_get_clipeventflags (bits, version)) != 0) {
+      guint length = swfdec_bits_get_u32 (bits);
+      SwfdecBits action_bits;
+
+      swfdec_bits_init_bits (&action_bits, bits, length);
+      if (event_flags & (1<<SWFDEC_EVENT_KEY_PRESS))
+	key_code = swfdec_bits_get_u8 (&action_bits);
+      else
+	key_code = 0;
+
+      SWFDEC_INFO ("clip event with flags 0x%X, key code %d", event_flags, key_code);
+#define SWFDEC_UNIMPLEMENTED_EVENTS \
+  ((1<< SWFDEC_EVENT_DATA))
+      if (event_flags & SWFDEC_UNIMPLEMENTED_EVENTS) {
+	SWFDEC_ERROR ("using non-implemented clip events %u", event_flags & SWFDEC_UNIMPLEMENTED_EVENTS);
+      }
+      swfdec_event_list_parse (place->events, &action_bits, version, 
+	  event_flags, key_code, script_name);
+      if (swfdec_bits_left (&action_bits)) {
+	SWFDEC_ERROR ("not all action data was parsed: %u bytes left",
+	    swfdec_bits_left (&action_bits));
+      }
+    }
+    g_free (script_name);
+  }
+
+  return place;
+}
+
+void
+swfdec_sprite_place_free (SwfdecSpritePlace *place)
+{
+  g_return_if_fail (place != NULL);
+
+  g_free (place->name);
+  if (place->events)
+    swfdec_event_list_free (place->events);
+  g_slice_free (SwfdecSpritePlace, place);
+}
@@ -43,6 +43,23 @@ struct _SwfdecSpriteAction {
   SwfdecBuffer *		buffer;	/* the buffer for this data (can be NULL) */
 };
 
+/* a parsed PlaceObject2 or PlaceObject3 tag */
+struct _SwfdecSpritePlace {
+  gboolean			move;		/* TRUE if an existing movie is modified */
+  int				depth;		/* depth to place at */
+  guint				id;		/* id of the character to place or 0 */
+  gboolean			has_transform;	/* TRUE if transform is set */
+  cairo_matrix_t		transform;	/* transformation matrix */
+  gboolean			has_ctrans;	/* TRUE if ctrans is set */
+  SwfdecColorTransform		ctrans;		/* color transform */
+  int				ratio;		/* ratio or -1 if unset */
+  char *			name;		/* name of the movie or NULL */
+  int				clip_depth;	/* depth to clip to or 0 */
+  guint				blend_mode;	/* blend mode */
+  gboolean			has_filter;	/* TRUE if the tag contains filters */
+  SwfdecEventList *		events;		/* clip events or NULL */
+};
+
 #define SWFDEC_TYPE_SPRITE                    (swfdec_sprite_get_type())
 #define SWFDEC_IS_SPRITE(obj)                 (G_TYPE_CHECK_INSTANCE_TYPE ((obj), SWFDEC_TYPE_SPRITE))
 #define SWFDEC_IS_SPRITE_CLASS(klass)         (G_TYPE_CHECK_CLASS_TYPE ((klass), SWFDEC_TYPE_SPRITE))
@@ -85,6 +102,14 @@ gboolean	swfdec_sprite_get_action	(SwfdecSprite *		sprite,
 						 SwfdecBuffer **	buffer);
 int		swfdec_sprite_get_frame		(SwfdecSprite *		sprite,
 				      		 const char *		label);
+
+SwfdecSpritePlace *
+		swfdec_sprite_place_new		(SwfdecBits *		bits,
+						 guint			tag,
+						 guint			version,
+						 SwfdecPlayer *		player,
+						 GSList **		filters);
+void		swfdec_sprite_place_free	(SwfdecSpritePlace *	place);
 #define swfdec_sprite_is_loaded(sprite) ((sprite)->parse_frame == (sprite)->n_frames)
 
 
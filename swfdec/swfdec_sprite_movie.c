@@ -52,16 +52,6 @@ swfdec_sprite_movie_remove_child (SwfdecMovie *movie, int depth)
   return TRUE;
 }
 
-static int
-swfdec_get_clipeventflags (SwfdecMovie *movie, SwfdecBits * bits)
-{
-  if (SWFDEC_SWF_DECODER (movie->resource->decoder)->version <= 5) {
-    return swfdec_bits_get_u16 (bits);
-  } else {
-    return swfdec_bits_get_u32 (bits);
-  }
-}
-
 static gboolean
 swfdec_sprite_movie_perform_old_place (SwfdecSpriteMovie *movie,
     SwfdecBits *bits, guint tag)
@@ -134,184 +124,42 @@ swfdec_sprite_movie_perform_old_place (SwfdecSpriteMovie *movie,
 
 
 static gboolean
-swfdec_sprite_movie_perform_place (SwfdecSpriteMovie *movie, SwfdecBits *bits, guint tag)
+swfdec_sprite_movie_perform_place (SwfdecSpriteMovie *movie, SwfdecBuffer *buffer, 
+    SwfdecBits *bits, guint tag)
 {
   SwfdecPlayer *player = SWFDEC_PLAYER (swfdec_gc_object_get_context (movie));
   SwfdecMovie *mov = SWFDEC_MOVIE (movie);
   SwfdecMovie *cur;
   SwfdecSwfDecoder *dec;
-  gboolean has_clip_actions;
-  gboolean has_clip_depth;
-  gboolean has_name;
-  gboolean has_ratio;
-  gboolean has_ctrans;
-  gboolean has_transform;
-  gboolean has_character;
-  gboolean move;
-  int depth;
-  gboolean cache;
-  gboolean has_blend_mode = 0;
-  gboolean has_filter = 0;
-  int clip_depth;
-  cairo_matrix_t transform;
-  SwfdecColorTransform ctrans;
-  guint ratio, id, version;
-  SwfdecEventList *events;
+  SwfdecSpritePlace *place;
   const char *name;
-  guint blend_mode;
   SwfdecGraphic *graphic;
   GSList *filters;
+  gboolean shared, ret = TRUE;
 
   dec = SWFDEC_SWF_DECODER (mov->resource->decoder);
-  version = dec->version;
-
-  /* 1) check which stuff is set */
-  has_clip_actions = swfdec_bits_getbit (bits);
-  has_clip_depth = swfdec_bits_getbit (bits);
-  has_name = swfdec_bits_getbit (bits);
-  has_ratio = swfdec_bits_getbit (bits);
-  has_ctrans = swfdec_bits_getbit (bits);
-  has_transform = swfdec_bits_getbit (bits);
-  has_character = swfdec_bits_getbit (bits);
-  move = swfdec_bits_getbit (bits);
 
   SWFDEC_LOG ("performing PlaceObject%d on movie %s", tag == SWFDEC_TAG_PLACEOBJECT2 ? 2 : 3, mov->name);
-  SWFDEC_LOG ("  has_clip_actions = %d", has_clip_actions);
-  SWFDEC_LOG ("  has_clip_depth = %d", has_clip_depth);
-  SWFDEC_LOG ("  has_name = %d", has_name);
-  SWFDEC_LOG ("  has_ratio = %d", has_ratio);
-  SWFDEC_LOG ("  has_ctrans = %d", has_ctrans);
-  SWFDEC_LOG ("  has_transform = %d", has_transform);
-  SWFDEC_LOG ("  has_character = %d", has_character);
-  SWFDEC_LOG ("  move = %d", move);
-
-  if (tag == SWFDEC_TAG_PLACEOBJECT3) {
-    swfdec_bits_getbits (bits, 5);
-    cache = swfdec_bits_getbit (bits);
-    has_blend_mode = swfdec_bits_getbit (bits);
-    has_filter = swfdec_bits_getbit (bits);
-    SWFDEC_LOG ("  cache = %d", cache);
-    SWFDEC_LOG ("  has filter = %d", has_filter);
-    SWFDEC_LOG ("  has blend mode = %d", has_blend_mode);
-  }
-
-  /* 2) read all properties */
-  depth = swfdec_bits_get_u16 (bits);
-  if (depth >= 16384) {
-    SWFDEC_FIXME ("depth of placement too high: %u >= 16384", depth);
-  }
-  SWFDEC_LOG ("  depth = %d (=> %d)", depth, depth - 16384);
-  depth -= 16384;
-  if (has_character) {
-    id = swfdec_bits_get_u16 (bits);
-    SWFDEC_LOG ("  id = %d", id);
-  } else {
-    id = 0;
-  }
-
-  if (has_transform) {
-    swfdec_bits_get_matrix (bits, &transform, NULL);
-    SWFDEC_LOG ("  matrix = { %g %g, %g %g } + { %g %g }", 
-	transform.xx, transform.yx,
-	transform.xy, transform.yy,
-	transform.x0, transform.y0);
-  }
-  if (has_ctrans) {
-    swfdec_bits_get_color_transform (bits, &ctrans);
-    SWFDEC_LOG ("  color transform = %d %d  %d %d  %d %d  %d %d",
-	ctrans.ra, ctrans.rb,
-	ctrans.ga, ctrans.gb,
-	ctrans.ba, ctrans.bb,
-	ctrans.aa, ctrans.ab);
-  }
-
-  if (has_ratio) {
-    ratio = swfdec_bits_get_u16 (bits);
-    SWFDEC_LOG ("  ratio = %d", ratio);
-  } else {
-    ratio = -1;
-  }
-
-  if (has_name) {
-    char *s = swfdec_bits_get_string (bits, version);
-    if (s) {
-      name = swfdec_as_context_give_string (SWFDEC_AS_CONTEXT (player), s);
-      SWFDEC_LOG ("  name = %s", name);
-    } else {
-      name = NULL;
-    }
-  } else {
-    name = NULL;
-  }
-
-  if (has_clip_depth) {
-    clip_depth = swfdec_bits_get_u16 (bits) - 16384;
-    SWFDEC_LOG ("  clip_depth = %d (=> %d)", clip_depth + 16384, clip_depth);
-  } else {
-    clip_depth = 0;
-  }
-
-  if (has_filter) {
-    filters = swfdec_filter_parse (player, bits);
-  } else {
+  /* most tags were parsed while decoding, only the ones with filters need 
+   * to be parsed now */
+  place = buffer->data ? swfdec_swf_decoder_get_place (dec, buffer->data) : NULL;
+  shared = place != NULL;
+  if (shared) {
     filters = NULL;
-  }
-
-  if (has_blend_mode) {
-    blend_mode = swfdec_bits_get_u8 (bits);
-    SWFDEC_LOG ("  blend mode = %u", blend_mode);
   } else {
-    blend_mode = 0;
-  }
-
-  if (has_clip_actions) {
-    int reserved, clip_event_flags, event_flags, key_code;
-    char *script_name;
-
-    events = swfdec_event_list_new ();
-    reserved = swfdec_bits_get_u16 (bits);
-    clip_event_flags = swfdec_get_clipeventflags (mov, bits);
-
-    if (name)
-      script_name = g_strdup (name);
-    else if (id)
-      script_name = g_strdup_printf ("Sprite%u", id);
-    else
-      script_name = g_strdup ("unknown");
-    while ((event_flags = swfdec_get_clipeventflags (mov, bits)) != 0) {
-      guint length = swfdec_bits_get_u32 (bits);
-      SwfdecBits action_bits;
-
-      swfdec_bits_init_bits (&action_bits, bits, length);
-      if (event_flags & (1<<SWFDEC_EVENT_KEY_PRESS))
-	key_code = swfdec_bits_get_u8 (&action_bits);
-      else
-	key_code = 0;
-
-      SWFDEC_INFO ("clip event with flags 0x%X, key code %d", event_flags, key_code);
-#define SWFDEC_UNIMPLEMENTED_EVENTS \
-  ((1<< SWFDEC_EVENT_DATA))
-      if (event_flags & SWFDEC_UNIMPLEMENTED_EVENTS) {
-	SWFDEC_ERROR ("using non-implemented clip events %u", event_flags & SWFDEC_UNIMPLEMENTED_EVENTS);
-      }
-      swfdec_event_list_parse (events, &action_bits, version, 
-	  event_flags, key_code, script_name);
-      if (swfdec_bits_left (&action_bits)) {
-	SWFDEC_ERROR ("not all action data was parsed: %u bytes left",
-	    swfdec_bits_left (&action_bits));
-      }
-    }
-    g_free (script_name);
-  } else {
-    events = NULL;
+    place = swfdec_sprite_place_new (bits, tag, dec->version, player, &filters);
   }
+  if (place->name)
+    name = swfdec_as_context_get_string (SWFDEC_AS_CONTEXT (player), place->name);
+  else
+    name = NULL;
 
-  /* 3) perform the actions depending on the set properties */
-  cur = swfdec_movie_find (mov, depth);
-  graphic = swfdec_swf_decoder_get_character (dec, id);
-  if (move) {
+  /* perform the actions depending on the set properties */
+  cur = swfdec_movie_find (mov, place->depth);
+  graphic = swfdec_swf_decoder_get_character (dec, place->id);
+  if (place->move) {
     if (cur == NULL) {
-      SWFDEC_INFO ("no movie at depth %d, ignoring move command", depth);
+      SWFDEC_INFO ("no movie at depth %d, ignoring move command", place->depth);
       goto out;
     }
     if (graphic) {
@@ -319,24 +167,27 @@ swfdec_sprite_movie_perform_place (SwfdecSpriteMovie *movie, SwfdecBits *bits, g
       if (klass->replace)
 	klass->replace (cur, graphic);
     }
-    swfdec_movie_set_static_properties (cur, has_transform ? &transform : NULL, 
-	has_ctrans ? &ctrans : NULL, ratio, clip_depth, blend_mode, events);
+    swfdec_movie_set_static_properties (cur, 
+	place->has_transform ? &place->transform : NULL, 
+	place->has_ctrans ? &place->ctrans : NULL, place->ratio, 
+	place->clip_depth, place->blend_mode, place->events);
   } else {
-    if (cur != NULL && version > 5) {
-      SWFDEC_INFO ("depth %d is already occupied by movie %s, not placing", depth, cur->name);
+    if (cur != NULL && dec->version > 5) {
+      SWFDEC_INFO ("depth %d is already occupied by movie %s, not placing", place->depth, cur->name);
       goto out;
     }
     if (!SWFDEC_IS_GRAPHIC (graphic)) {
-      SWFDEC_FIXME ("character %u is not a graphic (does it even exist?), aborting", id);
-      if (events)
-	swfdec_event_list_free (events);
+      SWFDEC_FIXME ("character %u is not a graphic (does it even exist?), aborting", place->id);
       g_slist_foreach (filters, (GFunc) g_object_unref, NULL);
       g_slist_free (filters);
-      return FALSE;
+      ret = FALSE;
+      goto fail;
     }
-    cur = swfdec_movie_new (player, depth, mov, mov->resource, graphic, name);
-    swfdec_movie_set_static_properties (cur, has_transform ? &transform : NULL, 
-	has_ctrans ? &ctrans : NULL, ratio, clip_depth, blend_mode, events);
+    cur = swfdec_movie_new (player, place->depth, mov, mov->resource, graphic, name);
+    swfdec_movie_set_static_properties (cur, 
+	place->has_transform ? &place->transform : NULL, 
+	place->has_ctrans ? &place->ctrans : NULL, place->ratio, 
+	place->clip_depth, place->blend_mode, place->events);
     if (SWFDEC_IS_ACTOR (cur)) {
       SwfdecActor *actor = SWFDEC_ACTOR (cur);
       swfdec_actor_queue_script (actor, SWFDEC_EVENT_INITIALIZE);
@@ -346,16 +197,16 @@ swfdec_sprite_movie_perform_place (SwfdecSpriteMovie *movie, SwfdecBits *bits, g
     swfdec_movie_initialize (cur);
   }
 out:
-  if (has_filter) {
+  if (place->has_filter) {
     if (cur->filters)
       g_slist_free (cur->filters);
     swfdec_movie_invalidate_next (cur);
     cur->filters = filters;
   }
-
-  if (events)
-    swfdec_event_list_free (events);
-  return TRUE;
+fail:
+  if (!shared)
+    swfdec_sprite_place_free (place);
+  return ret;
 }
 
 static void
@@ -409,7 +260,7 @@ swfdec_sprite_movie_perform_one_action (SwfdecSpriteMovie *movie, guint tag, Swf
       return swfdec_sprite_movie_perform_old_place (movie, &bits, tag);
     case SWFDEC_TAG_PLACEOBJECT2:
     case SWFDEC_TAG_PLACEOBJECT3:
-      return swfdec_sprite_movie_perform_place (movie, &bits, tag);
+      return swfdec_sprite_movie_perform_place (movie, buffer, &bits, tag);
     case SWFDEC_TAG_REMOVEOBJECT:
       /* yes, this code is meant to be like this - the following u16 is the 
        * character id, that we don't care about, the rest is like RemoveObject2
@@ -594,6 +445,9 @@ swfdec_sprite_movie_goto (SwfdecSpriteMovie *movie, guint goto_frame)
     }
     old = my_g_list_split (old, walk);
     mov->list = g_list_concat (mov->list, walk);
+    for (walk = old; walk; walk = walk->next) {
+      swfdec_movie_unindex_child (mov, walk->data);
+    }
     n = goto_frame;
     movie->next_action = 0;
     remove_audio = TRUE;
@@ -648,6 +502,7 @@ swfdec_sprite_movie_goto (SwfdecSpriteMovie *movie, guint goto_frame)
 	  swfdec_movie_is_compatible (prev, cur)) {
 	SwfdecMovieClass *klass = SWFDEC_MOVIE_GET_CLASS (prev);
 	walk->data = prev;
+	swfdec_movie_index_child (mov, prev);
 	/* FIXME: This merging stuff probably needs to be improved a _lot_ */
 	if (klass->replace)
 	  klass->replace (prev, cur->graphic);
@@ -732,6 +587,28 @@ swfdec_sprite_movie_constructor (GType type, guint n_construct_properties,
   return object;
 }
 
+static gboolean
+swfdec_sprite_movie_needs_iterate (SwfdecActor *actor)
+{
+  SwfdecSpriteMovie *movie = SWFDEC_SPRITE_MOVIE (actor);
+  SwfdecPlayer *player = SWFDEC_PLAYER (swfdec_gc_object_get_context (movie));
+
+  /* onEnterFrame gets called, see swfdec_actor_execute() */
+  if (actor->events &&
+      swfdec_event_list_has_conditions (actor->events, SWFDEC_EVENT_ENTER, 0))
+    return TRUE;
+  if (player->priv->enter_frame_handlers &&
+      swfdec_movie_get_version (SWFDEC_MOVIE (movie)) > 5)
+    return TRUE;
+  /* the movie changes frames */
+  if (movie->sprite == NULL)
+    return FALSE;
+  if (movie->frame == (guint) -1)
+    return TRUE;
+  /* playing movies with only one frame don't go anywhere */
+  return movie->playing && (movie->n_frames != 1 || movie->frame != 1);
+}
+
 static void
 swfdec_sprite_movie_iterate (SwfdecActor *actor)
 {
@@ -805,6 +682,7 @@ swfdec_sprite_movie_class_init (SwfdecSpriteMovieClass * g_class)
   movie_class->finish_movie = swfdec_sprite_movie_finish_movie;
   movie_class->property_get = swfdec_sprite_movie_property_get;
   
+  actor_class->needs_iterate = swfdec_sprite_movie_needs_iterate;
   actor_class->iterate_start = swfdec_sprite_movie_iterate;
 }
 
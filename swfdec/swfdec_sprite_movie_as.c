@@ -419,6 +419,7 @@ swfdec_sprite_movie_play (SwfdecAsContext *cx, SwfdecAsObject *object,
   SWFDEC_AS_CHECK (SWFDEC_TYPE_SPRITE_MOVIE, &movie, "");
 
   movie->playing = TRUE;
+  swfdec_actor_activate (SWFDEC_ACTOR (movie));
 }
 
 SWFDEC_AS_NATIVE (900, 13, swfdec_sprite_movie_stop)
@@ -532,6 +533,7 @@ swfdec_sprite_movie_gotoAndPlay (SwfdecAsContext *cx, SwfdecAsObject *object,
 
   swfdec_sprite_movie_do_goto (movie, &val);
   movie->playing = TRUE;
+  swfdec_actor_activate (SWFDEC_ACTOR (movie));
 }
 
 SWFDEC_AS_NATIVE (900, 17, swfdec_sprite_movie_gotoAndStop)
@@ -83,6 +83,7 @@ struct _SwfdecStreamPrivate
   gboolean		queued;		/* TRUE if we have queued an action already */
   char *		error;		/* error message if in error state or NULL */
   SwfdecBufferQueue *	queue;		/* SwfdecBufferQueue managing the input buffers */
+  SwfdecBufferQueue *	recording;	/* copy of all pushed buffers or NULL if not recording */
 };
 
 enum {
@@ -140,6 +141,10 @@ swfdec_stream_dispose (GObject *object)
     swfdec_buffer_queue_unref (stream->queue);
     stream->queue = NULL;
   }
+  if (stream->recording) {
+    swfdec_buffer_queue_unref (stream->recording);
+    stream->recording = NULL;
+  }
   g_free (stream->error);
   stream->error = NULL;
 
@@ -188,6 +193,24 @@ swfdec_stream_get_queue (SwfdecStream *stream)
   return stream->priv->queue;
 }
 
+/* starts keeping a copy of all data pushed into the stream from now on */
+void
+swfdec_stream_record (SwfdecStream *stream)
+{
+  g_return_if_fail (SWFDEC_IS_STREAM (stream));
+
+  if (stream->priv->recording == NULL)
+    stream->priv->recording = swfdec_buffer_queue_new ();
+}
+
+SwfdecBufferQueue *
+swfdec_stream_get_recording (SwfdecStream *stream)
+{
+  g_return_val_if_fail (SWFDEC_IS_STREAM (stream), NULL);
+
+  return stream->priv->recording;
+}
+
 static void swfdec_stream_queue_processing (SwfdecStream *stream);
 
 static void
@@ -445,6 +468,8 @@ swfdec_stream_push (SwfdecStream *stream, SwfdecBuffer *buffer)
   g_return_if_fail (stream->priv->state == SWFDEC_STREAM_STATE_OPEN);
   g_return_if_fail (buffer != NULL);
 
+  if (stream->priv->recording)
+    swfdec_buffer_queue_push (stream->priv->recording, swfdec_buffer_ref (buffer));
   swfdec_buffer_queue_push (stream->priv->queue, buffer);
   /* FIXME */
   if (SWFDEC_IS_LOADER (stream))
@@ -50,14 +50,35 @@ enum {
 
 G_DEFINE_TYPE (SwfdecSwfDecoder, swfdec_swf_decoder, SWFDEC_TYPE_DECODER)
 
+/* completely parsed decoders are immutable, so players loading the same file
+ * can share them. This maps the key (a checksum of the file's contents) to the
+ * decoder. The decoders are not referenced, they remove themselves when 
+ * disposed. */
+G_LOCK_DEFINE_STATIC (shared_decoders);
+static GHashTable *shared_decoders = NULL;
+
 static void
 swfdec_swf_decoder_dispose (GObject *object)
 {
   SwfdecSwfDecoder *s = SWFDEC_SWF_DECODER (object);
 
+  if (s->shared_key) {
+    gboolean resurrected;
+    G_LOCK (shared_decoders);
+    g_hash_table_remove (shared_decoders, s->shared_key);
+    /* another thread might have gotten us via swfdec_swf_decoder_get_shared()
+     * before we removed ourselves, we'll be disposed again later then */
+    resurrected = G_OBJECT (s)->ref_count > 1;
+    G_UNLOCK (shared_decoders);
+    g_free (s->shared_key);
+    s->shared_key = NULL;
+    if (resurrected)
+      return;
+  }
   g_hash_table_destroy (s->characters);
   g_object_unref (s->main_sprite);
   g_hash_table_destroy (s->scripts);
+  g_hash_table_destroy (s->places);
 
   if (s->compressed)
     inflateEnd (&s->z);
@@ -424,6 +445,65 @@ swfdec_swf_decoder_init (SwfdecSwfDecoder *s)
       NULL, g_object_unref);
   s->scripts = g_hash_table_new_full (g_direct_hash, g_direct_equal,
       NULL, (GDestroyNotify) swfdec_script_unref);
+  s->places = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+      NULL, (GDestroyNotify) swfdec_sprite_place_free);
+}
+
+/**
+ * swfdec_swf_decoder_get_shared:
+ * @key: key the decoder was shared with
+ *
+ * Looks up a completely parsed decoder that was shared using 
+ * swfdec_swf_decoder_share().
+ *
+ * Returns: a new reference to the shared decoder or %NULL if none
+ **/
+SwfdecSwfDecoder *
+swfdec_swf_decoder_get_shared (const char *key)
+{
+  SwfdecSwfDecoder *s;
+
+  g_return_val_if_fail (key != NULL, NULL);
+
+  G_LOCK (shared_decoders);
+  if (shared_decoders) {
+    s = g_hash_table_lookup (shared_decoders, key);
+    if (s)
+      g_object_ref (s);
+  } else {
+    s = NULL;
+  }
+  G_UNLOCK (shared_decoders);
+
+  return s;
+}
+
+/**
+ * swfdec_swf_decoder_share:
+ * @s: a completely parsed decoder
+ * @key: key to share the decoder with, usually a checksum of the file
+ *
+ * Makes @s available to swfdec_swf_decoder_get_shared() for as long as it 
+ * exists. If @s isn't completely parsed or a different decoder is already 
+ * shared with @key, nothing happens.
+ **/
+void
+swfdec_swf_decoder_share (SwfdecSwfDecoder *s, const char *key)
+{
+  g_return_if_fail (SWFDEC_IS_SWF_DECODER (s));
+  g_return_if_fail (key != NULL);
+
+  if (s->shared_key || s->state != SWFDEC_STATE_EOF)
+    return;
+
+  G_LOCK (shared_decoders);
+  if (shared_decoders == NULL)
+    shared_decoders = g_hash_table_new (g_str_hash, g_str_equal);
+  if (g_hash_table_lookup (shared_decoders, key) == NULL) {
+    s->shared_key = g_strdup (key);
+    g_hash_table_insert (shared_decoders, s->shared_key, s);
+  }
+  G_UNLOCK (shared_decoders);
 }
 
 gpointer
@@ -486,3 +566,23 @@ swfdec_swf_decoder_get_script (SwfdecSwfDecoder *s, guint8 *data)
   return g_hash_table_lookup (s->scripts, data);
 }
 
+void
+swfdec_swf_decoder_add_place (SwfdecSwfDecoder *s, guint8 *data, 
+    SwfdecSpritePlace *place)
+{
+  g_return_if_fail (SWFDEC_IS_SWF_DECODER (s));
+  g_return_if_fail (data != NULL);
+  g_return_if_fail (place != NULL);
+
+  g_hash_table_insert (s->places, data, place);
+}
+
+SwfdecSpritePlace *
+swfdec_swf_decoder_get_place (SwfdecSwfDecoder *s, guint8 *data)
+{
+  g_return_val_if_fail (SWFDEC_IS_SWF_DECODER (s), NULL);
+  g_return_val_if_fail (data != NULL, NULL);
+
+  return g_hash_table_lookup (s->places, data);
+}
+
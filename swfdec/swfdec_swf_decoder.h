@@ -63,6 +63,7 @@ struct _SwfdecSwfDecoder
   SwfdecSprite *	main_sprite;	/* the root sprite */
   SwfdecSprite *	parse_sprite;	/* the sprite that parsed at the moment */
   GHashTable *		scripts;      	/* buffer -> script mapping for all scripts */
+  GHashTable *		places;		/* buffer -> SwfdecSpritePlace mapping for parsed PlaceObject tags */
 
   gboolean		use_network;	/* allow network or local access */
   gboolean		has_metadata;	/* TRUE if this file contains metadata */
@@ -71,6 +72,8 @@ struct _SwfdecSwfDecoder
   char *		metadata;	/* NULL if unset or contents of Metadata tag (supposed to be RDF) */
 
   SwfdecBuffer *	jpegtables;	/* jpeg tables for DefineJPEG compressed jpeg files */
+
+  char *		shared_key;	/* key this decoder is shared with or NULL if not shared */
 };
 
 struct _SwfdecSwfDecoderClass {
@@ -89,6 +92,17 @@ void		swfdec_swf_decoder_add_script		(SwfdecSwfDecoder *	s,
 							 SwfdecScript *		script);
 SwfdecScript *	swfdec_swf_decoder_get_script		(SwfdecSwfDecoder *	s,
 							 guint8 *		data);
+void		swfdec_swf_decoder_add_place		(SwfdecSwfDecoder *	s,
+							 guint8 *		data,
+							 SwfdecSpritePlace *	place);
+SwfdecSpritePlace *
+		swfdec_swf_decoder_get_place		(SwfdecSwfDecoder *	s,
+							 guint8 *		data);
+
+SwfdecSwfDecoder *
+		swfdec_swf_decoder_get_shared		(const char *		key);
+void		swfdec_swf_decoder_share		(SwfdecSwfDecoder *	s,
+							 const char *		key);
 
 SwfdecTagFunc swfdec_swf_decoder_get_tag_func (int tag);
 const char *swfdec_swf_decoder_get_tag_name (int tag);
@@ -285,6 +285,23 @@ tag_func_enqueue (SwfdecSwfDecoder *s, guint tag)
   return SWFDEC_STATUS_OK;
 }
 
+/* PlaceObject tags are executed very often, so parse them only once */
+static int
+tag_func_place_object (SwfdecSwfDecoder * s, guint tag)
+{
+  SwfdecSpritePlace *place;
+  SwfdecBits bits;
+
+  if (s->b.buffer && swfdec_bits_left (&s->b)) {
+    bits = s->b;
+    place = swfdec_sprite_place_new (&bits, tag, s->version, NULL, NULL);
+    if (place)
+      swfdec_swf_decoder_add_place (s, (guint8 *) s->b.ptr, place);
+  }
+
+  return tag_func_enqueue (s, tag);
+}
+
 static int
 tag_func_show_frame (SwfdecSwfDecoder * s, guint tag)
 {
@@ -430,7 +447,7 @@ static struct tag_func_struct tag_funcs[] = {
   [SWFDEC_TAG_DEFINESHAPE2] = {"DefineShape2", tag_define_shape, 0},
   [SWFDEC_TAG_DEFINEBUTTONCXFORM] = {"DefineButtonCXForm", NULL, 0},
   [SWFDEC_TAG_PROTECT] = {"Protect", tag_func_protect, 0},
-  [SWFDEC_TAG_PLACEOBJECT2] = {"PlaceObject2", tag_func_enqueue, SWFDEC_TAG_DEFINE_SPRITE },
+  [SWFDEC_TAG_PLACEOBJECT2] = {"PlaceObject2", tag_func_place_object, SWFDEC_TAG_DEFINE_SPRITE },
   [SWFDEC_TAG_REMOVEOBJECT2] = {"RemoveObject2", tag_func_enqueue, SWFDEC_TAG_DEFINE_SPRITE },
   [SWFDEC_TAG_DEFINESHAPE3] = {"DefineShape3", tag_define_shape_3, 0},
   [SWFDEC_TAG_DEFINETEXT2] = {"DefineText2", tag_func_define_text, 0},
@@ -464,7 +481,7 @@ static struct tag_func_struct tag_funcs[] = {
   [SWFDEC_TAG_SCRIPTLIMITS] = {"ScriptLimits", NULL, 0},
   [SWFDEC_TAG_SETTABINDEX] = {"SetTabIndex", NULL, SWFDEC_TAG_DEFINE_SPRITE },
   [SWFDEC_TAG_FILEATTRIBUTES] = {"FileAttributes", tag_func_file_attributes, SWFDEC_TAG_FIRST_ONLY },
-  [SWFDEC_TAG_PLACEOBJECT3] = {"PlaceObject3", tag_func_enqueue, SWFDEC_TAG_DEFINE_SPRITE },
+  [SWFDEC_TAG_PLACEOBJECT3] = {"PlaceObject3", tag_func_place_object, SWFDEC_TAG_DEFINE_SPRITE },
   [SWFDEC_TAG_IMPORTASSETS2] = {"ImportAssets2", NULL, 0},
   [SWFDEC_TAG_DEFINEFONTALIGNZONES] = {"DefineFontAlignZones", NULL, 0},
   [SWFDEC_TAG_CSMTEXTSETTINGS] = {"CSMTextSettings", NULL, 0},
@@ -65,8 +65,10 @@ swfdec_text_render (SwfdecGraphic *graphic, cairo_t *cr,
   SwfdecColor color;
   SwfdecText *text = SWFDEC_TEXT (graphic);
   SwfdecColorTransform force_color;
+  cairo_matrix_t base, matrix;
 
   cairo_transform (cr, &text->transform);
+  cairo_get_matrix (cr, &base);
   /* scale by bounds */
   for (i = 0; i < text->glyphs->len; i++) {
     SwfdecTextGlyph *glyph;
@@ -86,17 +88,19 @@ swfdec_text_render (SwfdecGraphic *graphic, cairo_t *cr,
     cairo_matrix_scale (&pos, 
 	(double) glyph->height / glyph->font->scale_factor,
 	(double) glyph->height / glyph->font->scale_factor);
-    cairo_save (cr);
-    cairo_transform (cr, &pos);
-    if (!cairo_matrix_invert (&pos)) {
-      color = swfdec_color_apply_transform (glyph->color, trans);
-      swfdec_color_transform_init_color (&force_color, color);
-      swfdec_draw_paint (draw, cr, &force_color);
-    } else {
+    cairo_matrix_multiply (&matrix, &pos, &base);
+    if (cairo_matrix_invert (&pos)) {
       SWFDEC_ERROR ("non-invertible matrix!");
+      continue;
     }
-    cairo_restore (cr);
+    /* glyphs are fills, so they use the renderer's coverage cache, which 
+     * keeps their masks from the first time they are painted */
+    color = swfdec_color_apply_transform (glyph->color, trans);
+    cairo_set_matrix (cr, &matrix);
+    swfdec_color_transform_init_color (&force_color, color);
+    swfdec_draw_paint (draw, cr, &force_color);
   }
+  cairo_set_matrix (cr, &base);
 }
 
 static void
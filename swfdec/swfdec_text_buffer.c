@@ -86,9 +86,10 @@ swfdec_text_buffer_class_init (SwfdecTextBufferClass *klass)
 
   object_class->dispose = swfdec_text_buffer_dispose;
 
+  /* position, number of bytes removed, number of bytes inserted */
   signals[TEXT_CHANGED] = g_signal_new ("text-changed", G_TYPE_FROM_CLASS (klass),
-      G_SIGNAL_RUN_LAST, 0, NULL, NULL, g_cclosure_marshal_VOID__VOID,
-      G_TYPE_NONE, 0);
+      G_SIGNAL_RUN_LAST, 0, NULL, NULL, swfdec_marshal_VOID__ULONG_ULONG_ULONG,
+      G_TYPE_NONE, 3, G_TYPE_ULONG, G_TYPE_ULONG, G_TYPE_ULONG);
   signals[CURSOR_CHANGED] = g_signal_new ("cursor-changed", G_TYPE_FROM_CLASS (klass),
       G_SIGNAL_RUN_LAST, 0, NULL, NULL, swfdec_marshal_VOID__ULONG_ULONG,
       G_TYPE_NONE, 2, G_TYPE_ULONG, G_TYPE_ULONG);
@@ -240,7 +241,7 @@ swfdec_text_buffer_insert_text (SwfdecTextBuffer *buffer,
   if (buffer->cursor_end >= pos)
     buffer->cursor_end += len;
 
-  g_signal_emit (buffer, signals[TEXT_CHANGED], 0);
+  g_signal_emit (buffer, signals[TEXT_CHANGED], 0, (gulong) pos, 0UL, (gulong) len);
   g_signal_emit (buffer, signals[CURSOR_CHANGED], 0,
       (gulong) MIN (buffer->cursor_start, buffer->cursor_end),
       (gulong) MAX (buffer->cursor_start, buffer->cursor_end));
@@ -290,7 +291,7 @@ swfdec_text_buffer_delete_text (SwfdecTextBuffer *buffer,
   else if (buffer->cursor_end > pos)
     buffer->cursor_end = pos;
 
-  g_signal_emit (buffer, signals[TEXT_CHANGED], 0);
+  g_signal_emit (buffer, signals[TEXT_CHANGED], 0, (gulong) pos, (gulong) length, 0UL);
   g_signal_emit (buffer, signals[CURSOR_CHANGED], 0,
       (gulong) MIN (buffer->cursor_start, buffer->cursor_end),
       (gulong) MAX (buffer->cursor_start, buffer->cursor_end));
@@ -414,7 +415,8 @@ swfdec_text_buffer_set_attributes (SwfdecTextBuffer *buffer, gsize start,
       g_sequence_iter_next (end_iter));
   CHECK_ATTRIBUTES (buffer);
 
-  g_signal_emit (buffer, signals[TEXT_CHANGED], 0);
+  g_signal_emit (buffer, signals[TEXT_CHANGED], 0, (gulong) start, 
+      (gulong) length, (gulong) length);
 }
 
 const SwfdecTextAttributes *
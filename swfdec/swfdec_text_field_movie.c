@@ -341,6 +341,7 @@ swfdec_text_field_movie_emit_onScroller (SwfdecTextFieldMovie *text)
 	SWFDEC_ACTOR (text), SWFDEC_EVENT_SCROLL, 0, SWFDEC_PLAYER_ACTION_QUEUE_NORMAL);
   }
   text->onScroller_emitted = TRUE;
+  swfdec_actor_activate (SWFDEC_ACTOR (text));
 }
 
 void
@@ -470,6 +471,7 @@ swfdec_text_field_movie_init_movie (SwfdecMovie *movie)
   }
   /* don't emit onScroller here, plz */
   text->onScroller_emitted = TRUE;
+  swfdec_actor_activate (SWFDEC_ACTOR (text));
   swfdec_text_field_movie_update_layout (text);
   if (swfdec_movie_get_version (movie) > 6)
     text->onScroller_emitted = FALSE;
@@ -492,6 +494,14 @@ swfdec_text_field_movie_finish_movie (SwfdecMovie *movie)
   swfdec_text_field_movie_set_listen_variable (text, NULL);
 }
 
+static gboolean
+swfdec_text_field_movie_needs_iterate (SwfdecActor *actor)
+{
+  SwfdecTextFieldMovie *text = SWFDEC_TEXT_FIELD_MOVIE (actor);
+
+  return text->changed || text->onScroller_emitted;
+}
+
 static void
 swfdec_text_field_movie_iterate (SwfdecActor *actor)
 {
@@ -972,15 +982,17 @@ swfdec_text_field_movie_class_init (SwfdecTextFieldMovieClass * g_class)
   actor_class->key_press = swfdec_text_field_movie_key_press;
   actor_class->key_release = swfdec_text_field_movie_key_release;
 
+  actor_class->needs_iterate = swfdec_text_field_movie_needs_iterate;
   actor_class->iterate_start = swfdec_text_field_movie_iterate;
 }
 
 static void
 swfdec_text_field_movie_text_changed (SwfdecTextBuffer *buffer, 
-    SwfdecTextFieldMovie *text)
+    gulong pos, gulong removed, gulong inserted, SwfdecTextFieldMovie *text)
 {
   swfdec_movie_invalidate_last (SWFDEC_MOVIE (text));
   text->changed++;
+  swfdec_actor_activate (SWFDEC_ACTOR (text));
 }
 
 static void
@@ -1112,6 +1124,64 @@ swfdec_text_field_movie_get_text (SwfdecTextFieldMovie *text)
   return swfdec_as_context_give_string (swfdec_gc_object_get_context (text), ret);
 }
 
+/* Returns how many bytes at the start of the text are the same after 
+ * replacing it with str. Inserted text uses the default format, so this 
+ * only counts text that uses it already. */
+static gsize
+swfdec_text_field_movie_get_common_prefix (SwfdecTextFieldMovie *text,
+    const char *str)
+{
+  SwfdecTextBufferIter *iter;
+  const char *old;
+  gsize i;
+
+  old = swfdec_text_buffer_get_text (text->text);
+  for (i = 0; str[i] != '\0' && str[i] == old[i]; i++);
+  /* don't split characters */
+  while (i > 0 && (str[i] & 0xC0) == 0x80)
+    i--;
+  if (i == 0)
+    return 0;
+
+  iter = swfdec_text_buffer_get_iter (text->text, 0);
+  if (swfdec_text_attributes_diff (
+	swfdec_text_buffer_iter_get_attributes (text->text, iter),
+	swfdec_text_buffer_get_default_attributes (text->text)) != 0)
+    return 0;
+  iter = swfdec_text_buffer_iter_next (text->text, iter);
+  if (iter != NULL)
+    i = MIN (i, swfdec_text_buffer_iter_get_start (text->text, iter));
+  return i;
+}
+
+/* Does the same as deleting all text and inserting str, but keeps the text at
+ * the start that doesn't change, so it doesn't need to be layouted again. */
+static void
+swfdec_text_field_movie_replace_text (SwfdecTextFieldMovie *text, 
+    const char *str)
+{
+  gsize keep, length, new_length;
+  guint changes;
+
+  length = swfdec_text_buffer_get_length (text->text);
+  new_length = strlen (str);
+  keep = swfdec_text_field_movie_get_common_prefix (text, str);
+
+  /* scripts get a change for both the deletion and the insertion */
+  changes = (length > 0 ? 1 : 0) + (new_length > 0 ? 1 : 0);
+  g_signal_handlers_block_by_func (text->text, 
+      swfdec_text_field_movie_text_changed, text);
+  if (length > keep)
+    swfdec_text_buffer_delete_text (text->text, keep, length - keep);
+  swfdec_text_buffer_insert_text (text->text, keep, str + keep);
+  g_signal_handlers_unblock_by_func (text->text, 
+      swfdec_text_field_movie_text_changed, text);
+  swfdec_text_buffer_set_cursor (text->text, new_length, new_length);
+
+  for (; changes > 0; changes--)
+    swfdec_text_field_movie_text_changed (text->text, 0, 0, 0, text);
+}
+
 void
 swfdec_text_field_movie_set_text (SwfdecTextFieldMovie *text, const char *str,
     gboolean html)
@@ -1125,29 +1195,29 @@ swfdec_text_field_movie_set_text (SwfdecTextFieldMovie *text, const char *str,
   if (html && swfdec_gc_object_get_context (text)->version < 8)
     swfdec_text_buffer_reset_default_attributes (text->text);
 
-  length = swfdec_text_buffer_get_length (text->text);
-  if (length)
-    swfdec_text_buffer_delete_text (text->text, 0, length);
-
   if (swfdec_gc_object_get_context (text)->version >= 7 &&
       text->style_sheet != NULL)
   {
+    html = TRUE;
     text->style_sheet_input = str;
-    swfdec_text_field_movie_html_parse (text, str);
   }
   else
   {
     text->style_sheet_input = NULL;
-    if (html) {
-      swfdec_text_field_movie_html_parse (text, str);
-    } else {
-      char *s, *p;
-      s = p = g_strdup (str);
-      while ((p = strchr (p, '\r')))
-	*p = '\n';
-      swfdec_text_buffer_insert_text (text->text, 0, s);
-      g_free (s);
-    }
+  }
+
+  if (html) {
+    length = swfdec_text_buffer_get_length (text->text);
+    if (length)
+      swfdec_text_buffer_delete_text (text->text, 0, length);
+    swfdec_text_field_movie_html_parse (text, str);
+  } else {
+    char *s, *p;
+    s = p = g_strdup (str);
+    while ((p = strchr (p, '\r')))
+      *p = '\n';
+    swfdec_text_field_movie_replace_text (text, s);
+    g_free (s);
   }
 }
 
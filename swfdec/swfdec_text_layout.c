@@ -288,7 +288,7 @@ swfdec_text_layout_apply_attributes (SwfdecTextLayout *layout, PangoAttrList *li
 
 static const SwfdecTextBlock *
 swfdec_text_layout_create_paragraph (SwfdecTextLayout *layout, PangoContext *context,
-    const SwfdecTextBlock *last, gsize start, gsize end)
+    GSequenceIter *before, const SwfdecTextBlock *last, gsize start, gsize end)
 {
   SwfdecTextBufferIter *iter;
   SwfdecTextBlock *block;
@@ -321,7 +321,7 @@ swfdec_text_layout_create_paragraph (SwfdecTextLayout *layout, PangoContext *con
     swfdec_text_layout_apply_attributes_to_description (layout, attr, desc);
     pango_layout_set_font_description (block->layout, desc);
     pango_font_description_free (desc);
-    g_sequence_append (layout->blocks, block);
+    g_sequence_insert_before (before, block);
 
     if (layout->password) {
       /* requires sane line breaking so we can't just replace the text with * chars.
@@ -393,37 +393,71 @@ swfdec_text_layout_create_paragraph (SwfdecTextLayout *layout, PangoContext *con
   return last;
 }
 
-static void
-swfdec_text_layout_create (SwfdecTextLayout *layout)
+/* creates the blocks for all paragraphs in the text between start and end and
+ * inserts them before the given iter. last is the block in front of them. */
+static const SwfdecTextBlock *
+swfdec_text_layout_create_range (SwfdecTextLayout *layout, GSequenceIter *before,
+    const SwfdecTextBlock *last, gsize start, gsize end)
 {
-  const char *p, *end, *string;
+  const char *string;
   PangoContext *context;
   PangoFontMap *map;
-  const SwfdecTextBlock *last = NULL;
+  gsize p;
 
   map = pango_cairo_font_map_get_default ();
   context = pango_cairo_font_map_create_context (PANGO_CAIRO_FONT_MAP (map));
 
-  p = string = swfdec_text_buffer_get_text (layout->text);
+  string = swfdec_text_buffer_get_text (layout->text);
   for (;;) {
-    end = strpbrk (p, "\r\n");
-    if (end == NULL) {
-      end = string + swfdec_text_buffer_get_length (layout->text);
-    }
-
-    last = swfdec_text_layout_create_paragraph (layout, context, last, p - string, end - string);
-
-    if (*end == '\0')
+    for (p = start; p < end && string[p] != '\r' && string[p] != '\n'; p++);
+    last = swfdec_text_layout_create_paragraph (layout, context, before, last, start, p);
+    if (p == end)
       break;
-    p = end + 1;
+    start = p + 1;
   }
 
   g_object_unref (context);
+  return last;
+}
+
+static void
+swfdec_text_layout_create (SwfdecTextLayout *layout)
+{
+  swfdec_text_layout_create_range (layout, g_sequence_get_end_iter (layout->blocks),
+      NULL, 0, swfdec_text_buffer_get_length (layout->text));
+}
+
+/* creates the blocks for the text that changed since the last layout and 
+ * moves the blocks after it to their new position */
+static void
+swfdec_text_layout_relayout (SwfdecTextLayout *layout)
+{
+  const SwfdecTextBlock *last;
+  SwfdecTextBlock *block;
+  GSequenceIter *iter;
+
+  iter = layout->dirty_iter;
+  last = g_sequence_iter_is_begin (iter) ? NULL : 
+    g_sequence_get (g_sequence_iter_prev (iter));
+  last = swfdec_text_layout_create_range (layout, iter, last,
+      layout->dirty_start, layout->dirty_end);
+  for (; !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter)) {
+    block = g_sequence_get (iter);
+    block->rect.y = last->rect.y + last->rect.height;
+    block->row = last->row + pango_layout_get_line_count (last->layout);
+    last = block;
+  }
+  layout->dirty = FALSE;
+  layout->dirty_iter = NULL;
 }
 
 static void
 swfdec_text_layout_ensure (SwfdecTextLayout *layout)
 {
+  if (layout->dirty) {
+    swfdec_text_layout_relayout (layout);
+    return;
+  }
   if (!g_sequence_iter_is_end (g_sequence_get_begin_iter (layout->blocks)))
     return;
 
@@ -433,6 +467,8 @@ swfdec_text_layout_ensure (SwfdecTextLayout *layout)
 static void
 swfdec_text_layout_invalidate (SwfdecTextLayout *layout)
 {
+  layout->dirty = FALSE;
+  layout->dirty_iter = NULL;
   if (g_sequence_iter_is_end (g_sequence_get_begin_iter (layout->blocks)))
     return;
 
@@ -442,6 +478,94 @@ swfdec_text_layout_invalidate (SwfdecTextLayout *layout)
   layout->layout_width = 0;
 }
 
+/* finds the first block that ends at or after the given byte index */
+static GSequenceIter *
+swfdec_text_layout_find_index (SwfdecTextLayout *layout, gsize index_)
+{
+  GSequenceIter *begin, *end, *mid;
+  SwfdecTextBlock *cur;
+
+  begin = g_sequence_get_begin_iter (layout->blocks);
+  end = g_sequence_iter_prev (g_sequence_get_end_iter (layout->blocks));
+  while (begin != end) {
+    mid = g_sequence_range_get_midpoint (begin, end); 
+    cur = g_sequence_get (mid);
+    if (cur->end >= index_)
+      end = mid;
+    else
+      begin = g_sequence_iter_next (mid);
+  }
+  return begin;
+}
+
+/* Changes only drop the blocks of the paragraphs they touch and remember the 
+ * text that needs new blocks, so a lot of small changes - like when parsing 
+ * HTML - don't cause a lot of layouting. The next swfdec_text_layout_ensure() 
+ * creates the missing blocks. */
+static void
+swfdec_text_layout_text_changed (SwfdecTextBuffer *buffer, gulong pos, 
+    gulong removed, gulong inserted, SwfdecTextLayout *layout)
+{
+  GSequenceIter *iter, *next;
+  SwfdecTextBlock *block;
+  const char *string;
+  gsize start, end;
+
+  if (!layout->dirty &&
+      g_sequence_iter_is_end (g_sequence_get_begin_iter (layout->blocks)))
+    return;
+
+  /* text in front of start and after end (before the change) keeps its 
+   * blocks, the old dirty text gets merged */
+  start = pos;
+  end = pos + removed;
+  if (layout->dirty) {
+    start = MIN (start, layout->dirty_start);
+    end = MAX (end, layout->dirty_end);
+  }
+
+  /* drop all blocks touching the changed text */
+  iter = g_sequence_get_end_iter (layout->blocks);
+  if (!g_sequence_iter_is_begin (iter)) {
+    iter = swfdec_text_layout_find_index (layout, start);
+    block = g_sequence_get (iter);
+    if (block->end < start)
+      iter = g_sequence_iter_next (iter);
+  }
+  while (!g_sequence_iter_is_end (iter)) {
+    block = g_sequence_get (iter);
+    if (block->start > end)
+      break;
+    start = MIN (start, block->start);
+    end = MAX (end, block->end);
+    next = g_sequence_iter_next (iter);
+    g_sequence_remove (iter);
+    iter = next;
+  }
+  /* Blocks inside a paragraph are split at line breaks, so drop the ones in 
+   * front of us until we find a newline. Note that the text in front of pos
+   * hasn't changed. */
+  string = swfdec_text_buffer_get_text (buffer);
+  while (start > 0 && string[start - 1] != '\r' && string[start - 1] != '\n') {
+    g_assert (!g_sequence_iter_is_begin (iter));
+    next = g_sequence_iter_prev (iter);
+    block = g_sequence_get (next);
+    start = block->start;
+    g_sequence_remove (next);
+  }
+
+  layout->dirty = TRUE;
+  layout->dirty_start = start;
+  layout->dirty_end = end + inserted - removed;
+  layout->dirty_iter = iter;
+  for (; !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter)) {
+    block = g_sequence_get (iter);
+    block->start += inserted - removed;
+    block->end += inserted - removed;
+  }
+  layout->layout_width = 0;
+}
+
 /*** LAYOUT ***/
 
 /* A layout represents the whole text of a TextFieldMovie, this includes the
@@ -489,8 +613,8 @@ swfdec_text_layout_new (SwfdecTextBuffer *buffer)
 
   layout = g_object_new (SWFDEC_TYPE_TEXT_LAYOUT, NULL);
   layout->text = g_object_ref (buffer);
-  g_signal_connect_swapped (buffer, "text-changed",
-      G_CALLBACK (swfdec_text_layout_invalidate), layout);
+  g_signal_connect (buffer, "text-changed",
+      G_CALLBACK (swfdec_text_layout_text_changed), layout);
 
   return layout;
 }
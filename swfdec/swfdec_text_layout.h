@@ -50,6 +50,10 @@ struct _SwfdecTextLayout
 
   /* layout data */
   GSequence *		blocks;		/* ordered list of blocks */
+  gboolean		dirty;		/* TRUE if blocks are missing for some text */
+  gsize			dirty_start;	/* start of text without blocks */
+  gsize			dirty_end;	/* end of text without blocks */
+  GSequenceIter *	dirty_iter;	/* first block after the text without blocks */
   /* cached values */
   guint			layout_width;	/* width of layout or 0 if not computed yet */
 };
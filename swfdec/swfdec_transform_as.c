@@ -121,8 +121,7 @@ swfdec_transform_as_set_matrix (SwfdecAsContext *cx, SwfdecAsObject *object,
   movie->matrix = tmp;
 
   swfdec_movie_queue_update (movie, SWFDEC_MOVIE_INVALID_EXTENTS);
-  swfdec_matrix_ensure_invertible (&movie->matrix, &movie->inverse_matrix);
-  g_signal_emit_by_name (movie, "matrix-changed");
+  swfdec_movie_matrix_changed (movie);
 }
 
 SWFDEC_AS_NATIVE (1106, 103, swfdec_transform_as_get_concatenatedMatrix)
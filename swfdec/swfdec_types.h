@@ -63,8 +63,10 @@ typedef struct _SwfdecSoundChunk SwfdecSoundChunk;
 typedef struct _SwfdecSprite SwfdecSprite;
 typedef struct _SwfdecSpriteFrame SwfdecSpriteFrame;
 typedef struct _SwfdecSpriteMovie SwfdecSpriteMovie;
+typedef struct _SwfdecSpritePlace SwfdecSpritePlace;
 typedef struct _SwfdecSwfDecoder SwfdecSwfDecoder;
 typedef struct _SwfdecText SwfdecText;
+typedef struct _SwfdecXmlParser SwfdecXmlParser;
 
 G_END_DECLS
 #endif
@@ -473,6 +473,12 @@ swfdec_xml_add_id_map (SwfdecXml *xml, SwfdecXmlNode *node, const char *id)
   g_return_if_fail (SWFDEC_IS_XML_NODE (xml));
   g_return_if_fail (id != NULL && id != SWFDEC_AS_STR_EMPTY);
 
+  // parsing ahead without an object, the map is created when adopting
+  if (SWFDEC_AS_RELAY (xml)->relay == NULL) {
+    xml->id_nodes = g_slist_prepend (xml->id_nodes, node);
+    return;
+  }
+
   context = swfdec_gc_object_get_context (xml);
   object = swfdec_as_relay_get_as_object (SWFDEC_AS_RELAY (xml));
   if (context->version >= 8) {
@@ -530,9 +536,9 @@ swfdec_xml_parse_attribute (SwfdecXml *xml, SwfdecXmlNode *node, const char *p)
     return strchr (p, '\0');
   }
 
-  end = p + 1;
+  end = p;
   do {
-    end = strchr (end, *p);
+    end = strchr (end + 1, *p);
   } while (end != NULL && *(end - 1) == '\\');
 
   if (end == NULL) {
@@ -556,10 +562,22 @@ swfdec_xml_parse_attribute (SwfdecXml *xml, SwfdecXmlNode *node, const char *p)
   return end + 1;
 }
 
+static SwfdecXmlNode *
+swfdec_xml_new_node (SwfdecXml *xml, SwfdecXmlNodeType type, const char *value)
+{
+  SwfdecAsContext *cx = swfdec_gc_object_get_context (xml);
+
+  /* streaming happens before scripts had a chance to change XMLNode, so it's
+   * looked up when the parsed tree is actually used */
+  if (xml->streaming)
+    return swfdec_xml_node_new_no_constructor (cx, type, value);
+  else
+    return swfdec_xml_node_new_no_properties (cx, type, value);
+}
+
 static const char *
 swfdec_xml_parse_tag (SwfdecXml *xml, SwfdecXmlNode **node, const char *p)
 {
-  SwfdecAsObject *object;
   SwfdecAsContext *cx;
   SwfdecXmlNode *child = NULL; // supress warning
   char *name;
@@ -570,7 +588,6 @@ swfdec_xml_parse_tag (SwfdecXml *xml, SwfdecXmlNode **node, const char *p)
   g_return_val_if_fail (*p == '<', strchr (p, '\0'));
   g_return_val_if_fail (SWFDEC_IS_XML (xml), strchr (p, '\0'));
 
-  object = swfdec_as_relay_get_as_object (SWFDEC_AS_RELAY (xml));
   cx = swfdec_gc_object_get_context (xml);
 
   // closing tag or opening tag?
@@ -602,7 +619,7 @@ swfdec_xml_parse_tag (SwfdecXml *xml, SwfdecXmlNode **node, const char *p)
       end = strchr (p, '\0');
   } else {
     // create the new element
-    child = swfdec_xml_node_new_no_properties (cx, SWFDEC_XML_NODE_ELEMENT,
+    child = swfdec_xml_new_node (xml, SWFDEC_XML_NODE_ELEMENT,
 	swfdec_as_context_give_string (cx, name));
     end = end + strspn (end, " \r\n\t");
     while (*end != '\0' && *end != '>' && (*end != '/' || *(end + 1) != '>')) {
@@ -663,7 +680,6 @@ swfdec_xml_parse_cdata (SwfdecXml *xml, SwfdecXmlNode *node, const char *p)
   SwfdecAsContext *cx;
   SwfdecXmlNode *child;
   const char *end;
-  char *text;
 
   g_assert (p != NULL);
   g_return_val_if_fail (strncmp (p, "<![CDATA[", strlen ("<![CDATA[")) == 0,
@@ -679,11 +695,9 @@ swfdec_xml_parse_cdata (SwfdecXml *xml, SwfdecXmlNode *node, const char *p)
     return strchr (p, '\0');
   }
 
-  text = g_strndup (p, end - p);
-
   cx = swfdec_gc_object_get_context (xml);
-  child = swfdec_xml_node_new_no_properties (cx, SWFDEC_XML_NODE_TEXT,
-      swfdec_as_context_give_string (cx, text));
+  child = swfdec_xml_new_node (xml, SWFDEC_XML_NODE_TEXT,
+      swfdec_as_context_get_string_len (cx, p, end - p));
   swfdec_xml_node_appendChild (node, child);
 
   end += strlen("]]>");
@@ -698,8 +712,7 @@ swfdec_xml_parse_text (SwfdecXml *xml, SwfdecXmlNode *node,
     const char *p, gboolean ignore_white)
 {
   SwfdecXmlNode *child;
-  const char *end;
-  char *text, *unescaped;
+  const char *end, *text;
 
   g_assert (p != NULL);
   g_return_val_if_fail (*p != '\0', p);
@@ -712,11 +725,14 @@ swfdec_xml_parse_text (SwfdecXml *xml, SwfdecXmlNode *node,
   if (!ignore_white || strspn (p, " \t\r\n") < (gsize)(end - p))
   {
     SwfdecAsContext *cx = swfdec_gc_object_get_context (xml);
-    text = g_strndup (p, end - p);
-    unescaped = swfdec_xml_unescape (cx, text);
-    g_free (text);
-    child = swfdec_xml_node_new_no_properties (cx, SWFDEC_XML_NODE_TEXT,
-	swfdec_as_context_give_string (cx, unescaped));
+    /* most text contains no entities, intern it without copying it first */
+    if (memchr (p, '&', end - p) == NULL) {
+      text = swfdec_as_context_get_string_len (cx, p, end - p);
+    } else {
+      text = swfdec_as_context_give_string (cx,
+	  swfdec_xml_unescape_len (cx, p, end - p, TRUE));
+    }
+    child = swfdec_xml_new_node (xml, SWFDEC_XML_NODE_TEXT, text);
     swfdec_xml_node_appendChild (node, child);
   }
 
@@ -725,10 +741,361 @@ swfdec_xml_parse_text (SwfdecXml *xml, SwfdecXmlNode *node,
   return end;
 }
 
+static const char *
+swfdec_xml_parse_token (SwfdecXml *xml, SwfdecXmlNode **node, const char *p,
+    gboolean ignore_white)
+{
+  if (*p == '<') {
+    if (g_ascii_strncasecmp (p + 1, "?xml", strlen ("?xml")) == 0) {
+      p = swfdec_xml_parse_xmlDecl (xml, *node, p);
+    } else if (g_ascii_strncasecmp (p + 1, "!DOCTYPE", strlen ("!DOCTYPE")) == 0) {
+      p = swfdec_xml_parse_docTypeDecl (xml, *node, p);
+    } else if (strncmp (p + 1, "!--", strlen ("!--")) == 0) {
+      p = swfdec_xml_parse_comment (xml, p);
+    } else if (g_ascii_strncasecmp (p + 1, "![CDATA", strlen ("![CDATA")) == 0) {
+      p = swfdec_xml_parse_cdata (xml, *node, p);
+    } else {
+      p = swfdec_xml_parse_tag (xml, node, p);
+    }
+  } else {
+    p = swfdec_xml_parse_text (xml, *node, p, ignore_white);
+  }
+  g_assert (p != NULL);
+
+  return p;
+}
+
+/*** INCREMENTAL PARSING ***/
+
+/* The parser below builds the tree for XML data while it is still loading,
+ * so huge documents don't have to be parsed in one go when the download
+ * finishes. Scripts may override onData, so the result is only used if
+ * parseXML() gets called with exactly the text that was streamed and is
+ * thrown away otherwise. */
+
+struct _SwfdecXmlParser {
+  SwfdecXml *		xml;		/* parentless root all nodes get appended to */
+  SwfdecXmlNode *	node;		/* node new children get appended to */
+  GString *		text;		/* text pushed into the parser */
+  gsize			pos;		/* offset into text of the first unparsed byte */
+  gboolean		terminated;	/* a 0 byte was pushed, ignore all further data */
+  const char *		result;		/* GC'ed string this parse is valid for or NULL */
+};
+
+SwfdecXmlParser *
+swfdec_xml_parser_new (SwfdecAsContext *context, gboolean ignore_white)
+{
+  SwfdecXmlParser *parser;
+  SwfdecXml *xml;
+
+  g_return_val_if_fail (SWFDEC_IS_AS_CONTEXT (context), NULL);
+
+  xml = g_object_new (SWFDEC_TYPE_XML, "context", context, NULL);
+  xml->ignore_white = ignore_white;
+  xml->streaming = TRUE;
+  swfdec_xml_node_init_values (SWFDEC_XML_NODE (xml),
+      SWFDEC_XML_NODE_ELEMENT, SWFDEC_AS_STR_EMPTY);
+  SWFDEC_XML_NODE (xml)->name = NULL;
+
+  parser = g_slice_new0 (SwfdecXmlParser);
+  parser->xml = xml;
+  parser->node = SWFDEC_XML_NODE (xml);
+  parser->text = g_string_new ("");
+
+  return parser;
+}
+
+void
+swfdec_xml_parser_free (SwfdecXmlParser *parser)
+{
+  g_return_if_fail (parser != NULL);
+
+  g_slist_free (parser->xml->id_nodes);
+  parser->xml->id_nodes = NULL;
+  g_string_free (parser->text, TRUE);
+  g_slice_free (SwfdecXmlParser, parser);
+}
+
+void
+swfdec_xml_parser_mark (SwfdecXmlParser *parser)
+{
+  g_return_if_fail (parser != NULL);
+
+  /* the current node is a descendant of the root */
+  swfdec_gc_object_mark (parser->xml);
+  if (parser->result)
+    swfdec_as_string_mark (parser->result);
+}
+
+/**
+ * swfdec_xml_parser_push:
+ * @parser: a #SwfdecXmlParser
+ * @data: UTF-8 encoded text
+ * @length: length of @data in bytes
+ *
+ * Appends @data to the text to be parsed. Like for strings, everything after
+ * a 0 byte is ignored.
+ **/
+void
+swfdec_xml_parser_push (SwfdecXmlParser *parser, const char *data, gsize length)
+{
+  const char *end;
+
+  g_return_if_fail (parser != NULL);
+  g_return_if_fail (data != NULL || length == 0);
+
+  if (parser->terminated)
+    return;
+
+  end = memchr (data, 0, length);
+  if (end != NULL) {
+    length = end - data;
+    parser->terminated = TRUE;
+  }
+  g_string_append_len (parser->text, data, length);
+}
+
+/* Checks if the token starting at p can be parsed without ever looking at the
+ * end of the currently available data. Mirrors what the parse functions above
+ * do, so parsing a token that is complete gives the same result it would give
+ * with the whole document available. */
+static gboolean
+swfdec_xml_parser_is_complete (const char *p, gsize length)
+{
+  const char *end;
+  int open;
+
+  if (*p != '<')
+    return strchr (p, '<') != NULL;
+
+  /* need enough data to decide what kind of token this is */
+  if (length < strlen ("<!DOCTYPE "))
+    return FALSE;
+
+  if (g_ascii_strncasecmp (p + 1, "?xml", strlen ("?xml")) == 0)
+    return strstr (p, "?>") != NULL;
+
+  if (g_ascii_strncasecmp (p + 1, "!DOCTYPE", strlen ("!DOCTYPE")) == 0) {
+    end = p + 1;
+    open = 1;
+    do {
+      end += strcspn (end, "<>");
+      if (*end == '<') {
+	open++;
+	end++;
+      } else if (*end == '>') {
+	open--;
+	end++;
+      }
+    } while (*end != '\0' && open > 0);
+    return *end != '\0';
+  }
+
+  if (strncmp (p + 1, "!--", strlen ("!--")) == 0)
+    return strstr (p, "-->") != NULL;
+
+  if (g_ascii_strncasecmp (p + 1, "![CDATA", strlen ("![CDATA")) == 0) {
+    /* malformed CDATA consumes the rest of the document */
+    if (strncmp (p, "<![CDATA[", strlen ("<![CDATA[")) != 0)
+      return FALSE;
+    return strstr (p + strlen ("<![CDATA["), "]]>") != NULL;
+  }
+
+  /* closing tag */
+  if (p[1] == '/') {
+    end = p + 1 + strcspn (p + 1, "> \r\n\t");
+    return strchr (end, '>') != NULL;
+  }
+
+  /* opening tag */
+  end = p + strcspn (p, "> \r\n\t");
+  if (*end == '\0')
+    return FALSE;
+  if (end - (p + 1) <= 0)
+    return TRUE;
+  end = end + strspn (end, " \r\n\t");
+  while (*end != '\0' && *end != '>' && (*end != '/' || *(end + 1) != '>')) {
+    /* attribute */
+    p = end;
+    end = p + strcspn (p, "=> \r\n\t");
+    if (end == p)
+      return TRUE;
+    end = end + strspn (end, " \r\n\t");
+    if (*end == '\0')
+      return FALSE;
+    if (*end != '=')
+      return TRUE;
+    end = end + 1 + strspn (end + 1, " \r\n\t");
+    if (*end == '\0')
+      return FALSE;
+    if (*end != '"' && *end != '\'')
+      return TRUE;
+    p = end;
+    do {
+      end = strchr (end + 1, *p);
+    } while (end != NULL && *(end - 1) == '\\');
+    if (end == NULL)
+      return FALSE;
+    end = end + 1 + strspn (end + 1, " \r\n\t");
+  }
+
+  return *end != '\0';
+}
+
+static gboolean
+swfdec_xml_parser_run (SwfdecXmlParser *parser, gboolean eos, guint *budget)
+{
+  SwfdecXml *xml = parser->xml;
+  const char *start, *p;
+  gboolean more = FALSE;
+
+  start = parser->text->str;
+  p = start + parser->pos;
+  eos |= parser->terminated;
+
+  while (xml->status == XML_PARSE_STATUS_OK && *p != '\0') {
+    if (!eos && !swfdec_xml_parser_is_complete (p, parser->text->len - (p - start)))
+      break;
+    if (budget) {
+      if (*budget == 0) {
+	more = TRUE;
+	break;
+      }
+      (*budget)--;
+    }
+    p = swfdec_xml_parse_token (xml, &parser->node, p, xml->ignore_white);
+  }
+
+  /* drop parsed text, but don't move memory around all the time */
+  parser->pos = p - start;
+  if (parser->pos > 4096 && parser->pos * 2 > parser->text->len) {
+    g_string_erase (parser->text, 0, parser->pos);
+    parser->pos = 0;
+  }
+
+  if (eos && xml->status == XML_PARSE_STATUS_OK &&
+      parser->node != SWFDEC_XML_NODE (xml))
+    xml->status = XML_PARSE_STATUS_TAG_NOT_CLOSED;
+
+  return more;
+}
+
+/**
+ * swfdec_xml_parser_parse:
+ * @parser: a #SwfdecXmlParser
+ * @budget: number of tokens that may still be parsed or %NULL for no limit.
+ *          Decremented by the number of tokens parsed.
+ *
+ * Parses all pushed text that can be parsed without knowing what comes next.
+ * The budget is counted in tokens and not in time so that how far parsing
+ * gets does not depend on the speed of the machine.
+ *
+ * Returns: %TRUE if parsing was interrupted and there is more work to do
+ **/
+gboolean
+swfdec_xml_parser_parse (SwfdecXmlParser *parser, guint *budget)
+{
+  g_return_val_if_fail (parser != NULL, FALSE);
+
+  if (parser->result)
+    return FALSE;
+
+  return swfdec_xml_parser_run (parser, FALSE, budget);
+}
+
+/**
+ * swfdec_xml_parser_finish:
+ * @parser: a #SwfdecXmlParser
+ * @text: the GC'ed string made from all the pushed text
+ *
+ * Parses the remaining text. Afterwards the parsed tree will be used when 
+ * parseXML() is called with @text while @parser is set as the player's
+ * xml_parser.
+ **/
+void
+swfdec_xml_parser_finish (SwfdecXmlParser *parser, const char *text)
+{
+  g_return_if_fail (parser != NULL);
+  g_return_if_fail (text != NULL);
+
+  if (parser->result == NULL)
+    swfdec_xml_parser_run (parser, TRUE, NULL);
+  parser->result = text;
+}
+
+/* sets the constructor on all nodes the parser created below root */
+static void
+swfdec_xml_parser_set_constructors (SwfdecXmlNode *root)
+{
+  SwfdecAsContext *cx = swfdec_gc_object_get_context (root);
+  SwfdecAsObject *construct;
+  SwfdecAsValue *val;
+  SwfdecXmlNode *node;
+  GSList *todo;
+  gint32 i;
+
+  val = swfdec_as_object_peek_variable (cx->global, SWFDEC_AS_STR_XMLNode);
+  if (val == NULL || !SWFDEC_AS_VALUE_IS_OBJECT (*val)) {
+    SWFDEC_WARNING ("could not find constructor %s", SWFDEC_AS_STR_XMLNode);
+    return;
+  }
+  construct = SWFDEC_AS_VALUE_GET_OBJECT (*val);
+
+  /* documents can be nested deep, so don't recurse */
+  todo = NULL;
+  for (i = swfdec_xml_node_num_children (root) - 1; i >= 0; i--)
+    todo = g_slist_prepend (todo, swfdec_xml_node_get_child (root, i));
+  while (todo) {
+    node = todo->data;
+    todo = g_slist_delete_link (todo, todo);
+    swfdec_as_object_set_constructor (
+	swfdec_as_relay_get_as_object (SWFDEC_AS_RELAY (node)), construct);
+    for (i = swfdec_xml_node_num_children (node) - 1; i >= 0; i--)
+      todo = g_slist_prepend (todo, swfdec_xml_node_get_child (node, i));
+  }
+}
+
+static gboolean
+swfdec_xml_parser_adopt (SwfdecXmlParser *parser, SwfdecXml *xml,
+    const char *text)
+{
+  SwfdecXmlNode *from, *to;
+  GSList *walk;
+
+  if (parser->result != text || parser->xml->ignore_white != xml->ignore_white)
+    return FALSE;
+  to = SWFDEC_XML_NODE (xml);
+  if (to->parent != NULL)
+    return FALSE;
+  from = SWFDEC_XML_NODE (parser->xml);
+
+  swfdec_xml_parser_set_constructors (from);
+  swfdec_xml_node_removeChildren (to);
+  while (swfdec_xml_node_num_children (from) > 0) {
+    swfdec_xml_node_appendChild (to, swfdec_xml_node_get_child (from, 0));
+  }
+  xml->xml_decl = parser->xml->xml_decl;
+  xml->doc_type_decl = parser->xml->doc_type_decl;
+  xml->status = parser->xml->status;
+
+  parser->xml->id_nodes = g_slist_reverse (parser->xml->id_nodes);
+  for (walk = parser->xml->id_nodes; walk; walk = walk->next) {
+    SwfdecXmlNode *node = walk->data;
+    swfdec_xml_add_id_map (xml, node,
+	swfdec_xml_node_get_attribute (node, SWFDEC_AS_STR_id));
+  }
+  g_slist_free (parser->xml->id_nodes);
+  parser->xml->id_nodes = NULL;
+
+  /* the nodes belong to xml now */
+  parser->result = NULL;
+  return TRUE;
+}
+
 static void
 swfdec_xml_parseXML (SwfdecXml *xml, const char *value)
 {
-  SwfdecAsObject *object;
+  SwfdecAsContext *cx;
   SwfdecXmlNode *node;
   const char *p;
   gboolean ignore_white;
@@ -736,7 +1103,11 @@ swfdec_xml_parseXML (SwfdecXml *xml, const char *value)
   g_return_if_fail (SWFDEC_IS_XML (xml));
   g_return_if_fail (value != NULL);
 
-  object = swfdec_as_relay_get_as_object (SWFDEC_AS_RELAY (xml));
+  cx = swfdec_gc_object_get_context (xml);
+  if (SWFDEC_IS_PLAYER (cx) && SWFDEC_PLAYER (cx)->priv->xml_parser != NULL &&
+      swfdec_xml_parser_adopt (SWFDEC_PLAYER (cx)->priv->xml_parser, xml, value))
+    return;
+
   node = SWFDEC_XML_NODE (xml);
 
   swfdec_xml_node_removeChildren (SWFDEC_XML_NODE (xml));
@@ -750,22 +1121,7 @@ swfdec_xml_parseXML (SwfdecXml *xml, const char *value)
   ignore_white = xml->ignore_white;
 
   while (xml->status == XML_PARSE_STATUS_OK && *p != '\0') {
-    if (*p == '<') {
-      if (g_ascii_strncasecmp (p + 1, "?xml", strlen ("?xml")) == 0) {
-	p = swfdec_xml_parse_xmlDecl (xml, node, p);
-      } else if (g_ascii_strncasecmp (p + 1, "!DOCTYPE", strlen ("!DOCTYPE")) == 0) {
-	p = swfdec_xml_parse_docTypeDecl (xml, node, p);
-      } else if (strncmp (p + 1, "!--", strlen ("!--")) == 0) {
-	p = swfdec_xml_parse_comment (xml, p);
-      } else if (g_ascii_strncasecmp (p + 1, "![CDATA", strlen ("![CDATA")) == 0) {
-	p = swfdec_xml_parse_cdata (xml, node, p);
-      } else {
-	p = swfdec_xml_parse_tag (xml, &node, p);
-      }
-    } else {
-      p = swfdec_xml_parse_text (xml, node, p, ignore_white);
-    }
-    g_assert (p != NULL);
+    p = swfdec_xml_parse_token (xml, &node, p, ignore_white);
   }
 
   if (xml->status == XML_PARSE_STATUS_OK && node != SWFDEC_XML_NODE (xml))
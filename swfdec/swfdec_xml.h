@@ -61,6 +61,9 @@ struct _SwfdecXml {
 
   SwfdecAsValue		content_type;
   SwfdecAsValue		loaded;
+
+  GSList *		id_nodes;	// nodes with an id while parsing without an object
+  gboolean		streaming;	// nodes get their constructor when the tree is adopted
 };
 
 struct _SwfdecXmlClass {
@@ -86,5 +89,17 @@ SwfdecXml *	swfdec_xml_new_no_properties	(SwfdecAsContext *	context,
 						 const char *		str,
 						 gboolean		ignore_white);
 
+SwfdecXmlParser *swfdec_xml_parser_new		(SwfdecAsContext *	context,
+						 gboolean		ignore_white);
+void		swfdec_xml_parser_free		(SwfdecXmlParser *	parser);
+void		swfdec_xml_parser_mark		(SwfdecXmlParser *	parser);
+void		swfdec_xml_parser_push		(SwfdecXmlParser *	parser,
+						 const char *		data,
+						 gsize			length);
+gboolean	swfdec_xml_parser_parse		(SwfdecXmlParser *	parser,
+						 guint *		budget);
+void		swfdec_xml_parser_finish	(SwfdecXmlParser *	parser,
+						 const char *		text);
+
 G_END_DECLS
 #endif
@@ -1063,8 +1063,9 @@ swfdec_xml_node_init_properties (SwfdecAsContext *cx)
       swfdec_xml_node_get_childNodes, NULL);
 }
 
+/* the caller has to set the constructor of the node's object */
 SwfdecXmlNode *
-swfdec_xml_node_new_no_properties (SwfdecAsContext *context,
+swfdec_xml_node_new_no_constructor (SwfdecAsContext *context,
     SwfdecXmlNodeType type, const char* value)
 {
   SwfdecXmlNode *node;
@@ -1074,9 +1075,6 @@ swfdec_xml_node_new_no_properties (SwfdecAsContext *context,
   g_return_val_if_fail (value != NULL, NULL);
 
   object = swfdec_as_object_new (context, NULL);
-  swfdec_as_object_set_constructor_by_name (object,
-      SWFDEC_AS_STR_XMLNode, NULL);
-
   node = g_object_new (SWFDEC_TYPE_XML_NODE, "context", context, NULL);
   swfdec_as_object_set_relay (object, SWFDEC_AS_RELAY (node));
   swfdec_xml_node_init_values (node, type, value);
@@ -1084,6 +1082,23 @@ swfdec_xml_node_new_no_properties (SwfdecAsContext *context,
   return node;
 }
 
+SwfdecXmlNode *
+swfdec_xml_node_new_no_properties (SwfdecAsContext *context,
+    SwfdecXmlNodeType type, const char* value)
+{
+  SwfdecXmlNode *node;
+
+  g_return_val_if_fail (SWFDEC_IS_AS_CONTEXT (context), NULL);
+  g_return_val_if_fail (value != NULL, NULL);
+
+  node = swfdec_xml_node_new_no_constructor (context, type, value);
+  swfdec_as_object_set_constructor_by_name (
+      swfdec_as_relay_get_as_object (SWFDEC_AS_RELAY (node)),
+      SWFDEC_AS_STR_XMLNode, NULL);
+
+  return node;
+}
+
 SwfdecXmlNode *
 swfdec_xml_node_new (SwfdecAsContext *context, SwfdecXmlNodeType type,
     const char* value)
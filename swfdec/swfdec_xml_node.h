@@ -88,6 +88,9 @@ SwfdecXmlNode *	swfdec_xml_node_new		(SwfdecAsContext *	context,
 SwfdecXmlNode *	swfdec_xml_node_new_no_properties (SwfdecAsContext *	context,
 						 SwfdecXmlNodeType	type,
 						 const char *		value);
+SwfdecXmlNode *	swfdec_xml_node_new_no_constructor (SwfdecAsContext *	context,
+						 SwfdecXmlNodeType	type,
+						 const char *		value);
 void		swfdec_xml_node_removeNode	(SwfdecXmlNode *	node);
 void		swfdec_xml_node_appendChild	(SwfdecXmlNode *	node,
 						 SwfdecXmlNode *	child);
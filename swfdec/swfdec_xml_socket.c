@@ -31,6 +31,7 @@
 #include "swfdec_loader_internal.h"
 #include "swfdec_movie.h"
 #include "swfdec_player_internal.h"
+#include "swfdec_xml.h"
 
 static void
 swfdec_xml_socket_ensure_closed (SwfdecXmlSocket *xml)
@@ -95,38 +96,70 @@ swfdec_xml_socket_stream_target_parse (SwfdecStreamTarget *target,
     SwfdecStream *stream)
 {
   SwfdecXmlSocket *xml = SWFDEC_XML_SOCKET (target);
+  SwfdecAsContext *cx = swfdec_gc_object_get_context (xml);
   SwfdecBufferQueue *queue;
   SwfdecBuffer *buffer;
+  gboolean more = FALSE;
+  guint budget, *limit;
   gsize len;
 
+  /* XML in incomplete strings is parsed ahead, but not for too long. Once
+   * the stream is closed, everything is delivered right away. */
+  budget = SWFDEC_PLAYER (cx)->priv->xml_parse_budget;
+  limit = swfdec_stream_is_complete (stream) ? NULL : &budget;
+  if (xml->parser) {
+    swfdec_sandbox_use (xml->sandbox);
+    more = swfdec_xml_parser_parse (xml->parser, limit);
+    swfdec_sandbox_unuse (xml->sandbox);
+  }
+
   /* parse until next 0 byte or take everything */
   queue = swfdec_stream_get_queue (stream);
-  while ((buffer = swfdec_buffer_queue_peek_buffer (queue))) {
+  while (!more && (buffer = swfdec_buffer_queue_peek_buffer (queue))) {
     guchar *nul = memchr (buffer->data, 0, buffer->length);
     
     len = nul ? (gsize) (nul - buffer->data + 1) : buffer->length;
     g_assert (len > 0);
     swfdec_buffer_unref (buffer);
     buffer = swfdec_buffer_queue_pull (queue, len);
+    if (xml->parser == NULL)
+      xml->parser = swfdec_xml_parser_new (cx, FALSE);
+    swfdec_xml_parser_push (xml->parser, (char *) buffer->data, buffer->length);
     swfdec_buffer_queue_push (xml->queue, buffer);
     if (nul) {
+      SwfdecXmlParser *parser = xml->parser;
+
+      xml->parser = NULL;
       len = swfdec_buffer_queue_get_depth (xml->queue);
       g_assert (len > 0);
       buffer = swfdec_buffer_queue_pull (xml->queue, len);
       if (!g_utf8_validate ((char *) buffer->data, len, NULL)) {
 	SWFDEC_FIXME ("invalid utf8 sent through socket, what now?");
       } else {
+	SwfdecPlayerPrivate *priv = SWFDEC_PLAYER (cx)->priv;
+	SwfdecXmlParser *old = priv->xml_parser;
 	SwfdecAsValue val;
+	const char *s;
 
-	SWFDEC_AS_VALUE_SET_STRING (&val, swfdec_as_context_get_string (
-	      swfdec_gc_object_get_context (xml), (char *) buffer->data));
+	s = swfdec_as_context_get_string (cx, (char *) buffer->data);
+	SWFDEC_AS_VALUE_SET_STRING (&val, s);
 	swfdec_sandbox_use (xml->sandbox);
+	/* let the default onData use what we parsed already */
+	swfdec_xml_parser_finish (parser, s);
+	priv->xml_parser = parser;
 	swfdec_as_object_call (xml->target, SWFDEC_AS_STR_onData, 1, &val, NULL);
+	priv->xml_parser = old;
 	swfdec_sandbox_unuse (xml->sandbox);
       }
+      swfdec_xml_parser_free (parser);
+      swfdec_buffer_unref (buffer);
+    } else {
+      swfdec_sandbox_use (xml->sandbox);
+      more = swfdec_xml_parser_parse (xml->parser, limit);
+      swfdec_sandbox_unuse (xml->sandbox);
     }
   }
-  return FALSE;
+  return more;
 }
 
 static void
@@ -193,6 +226,8 @@ swfdec_xml_socket_mark (SwfdecGcObject *object)
 
   swfdec_as_object_mark (sock->target);
   swfdec_gc_object_mark (sock->sandbox);
+  if (sock->parser)
+    swfdec_xml_parser_mark (sock->parser);
 
   SWFDEC_GC_OBJECT_CLASS (swfdec_xml_socket_parent_class)->mark (object);
 }
@@ -203,6 +238,10 @@ swfdec_xml_socket_dispose (GObject *object)
   SwfdecXmlSocket *xml = SWFDEC_XML_SOCKET (object);
 
   swfdec_xml_socket_ensure_closed (xml);
+  if (xml->parser) {
+    swfdec_xml_parser_free (xml->parser);
+    xml->parser = NULL;
+  }
   if (xml->queue) {
     swfdec_buffer_queue_unref (xml->queue);
     xml->queue = NULL;
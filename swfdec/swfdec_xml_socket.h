@@ -44,6 +44,7 @@ struct _SwfdecXmlSocket {
   SwfdecSandbox *	sandbox;	/* the sandbox we run in */
   gboolean		open;		/* the socket has been opened already */
   SwfdecBufferQueue *	queue;		/* everything that belongs to the same string */
+  SwfdecXmlParser *	parser;		/* parser for the string in queue or NULL */
   SwfdecAsObject *	target;		/* target object we call out to */
   SwfdecBufferQueue *	send_queue;	/* queue of data still to be sent */
 };
@@ -31,6 +31,7 @@
 
 #include "swfdec_test_function.h"
 #include "swfdec_test_initialize.h"
+#include "swfdec_test_runner.h"
 #include "swfdec_test_test.h"
 
 /*** VERIFICATION OF ENVIRONMENT ***/
@@ -123,25 +124,84 @@ load_script (const char *filename)
   return script;
 }
 
-int
-main (int argc, char **argv)
+typedef struct {
+  SwfdecScript *	script;		/* script to run */
+  gboolean		dump;		/* value of the dump variable */
+} SwfdecTestRun;
+
+static int
+run_script (const SwfdecTestRun *run, const char * const *filenames, guint n_filenames)
 {
-  char *script_filename = NULL;
-  GError *error = NULL;
   SwfdecAsContext *context;
   SwfdecAsObject *array;
-  SwfdecScript *script;
   SwfdecAsValue val;
+  guint i;
+  int ret;
+
+  context = g_object_new (SWFDEC_TYPE_AS_CONTEXT, NULL);
+  swfdec_as_context_startup (context);
+
+  SWFDEC_AS_VALUE_SET_BOOLEAN (&val, run->dump);
+  swfdec_as_object_set_variable (context->global,
+      swfdec_as_context_get_string (context, "dump"), &val);
+
+  swfdec_test_function_init_context (context);
+  swfdec_as_context_run_init_script (context, swfdec_test_initialize, 
+      sizeof (swfdec_test_initialize), SWFDEC_TEST_VERSION);
+
+  array = swfdec_as_array_new (context);
+  if (array == NULL) {
+    g_print ("ERROR: Not enough memory");
+    g_object_unref (context);
+    return EXIT_FAILURE;
+  }
+  for (i = 0; i < n_filenames; i++) {
+    SWFDEC_AS_VALUE_SET_STRING (&val, swfdec_as_context_get_string (context, filenames[i]));
+    swfdec_as_array_push (array, &val);
+  }
+  SWFDEC_AS_VALUE_SET_OBJECT (&val, array);
+  swfdec_as_object_set_variable (context->global, 
+    swfdec_as_context_get_string (context, "filenames"), &val);
+  swfdec_as_object_run (context->global, run->script);
+  if (swfdec_as_context_catch (context, &val)) {
+    g_print ("ERROR: %s\n", swfdec_as_value_to_string (context, val));
+    ret = EXIT_FAILURE;
+  } else {
+    g_print ("SUCCESS\n");
+    ret = EXIT_SUCCESS;
+  }
+
+  g_object_unref (context);
+
+  return ret;
+}
+
+static int
+run_script_isolated (const char *filename, gpointer data)
+{
+  return run_script (data, &filename, 1);
+}
+
+int
+main (int argc, char **argv)
+{
+  char *script_filename = NULL, *report = NULL;
+  GError *error = NULL;
+  SwfdecTestRun run = { NULL, FALSE };
+  GPtrArray *filenames;
   int i, ret;
-  gboolean dump = FALSE;
+  int jobs = 0, timeout = -1;
   gboolean no_check = FALSE, only_check = FALSE;
 
   GOptionEntry options[] = {
-    { "dump", 'd', 0, G_OPTION_ARG_NONE, &dump, "dump informative output on failure", FALSE },
+    { "dump", 'd', 0, G_OPTION_ARG_NONE, &run.dump, "dump informative output on failure", FALSE },
     { "no-check", 0, 0, G_OPTION_ARG_NONE, &no_check, "don't check if the system is ok for running the testsuite", FALSE },
     { "self-check", 0, 0, G_OPTION_ARG_NONE, &only_check, "run a system check and exit", FALSE },
     { "player", 'p', 0, G_OPTION_ARG_STRING, &swfdec_test_plugin_name, "player to test", "NAME" },
     { "script", 's', 0, G_OPTION_ARG_STRING, &script_filename, "script to execute if not ./default.sts", "FILENAME" },
+    { "jobs", 'j', 0, G_OPTION_ARG_INT, &jobs, "run every file in its own process, N at a time", "N" },
+    { "timeout", 't', 0, G_OPTION_ARG_INT, &timeout, "kill tests taking longer than SECONDS, implies --jobs", "SECONDS" },
+    { "report", 'r', 0, G_OPTION_ARG_FILENAME, &report, "write results, time and memory use of every test to FILENAME as JSON, implies --jobs", "FILENAME" },
     { NULL }
   };
   GOptionContext *ctx;
@@ -179,28 +239,17 @@ main (int argc, char **argv)
   /* allow env vars instead of options - eases running make check with different settings */
   if (swfdec_test_plugin_name == NULL)
     swfdec_test_plugin_name = g_strdup (g_getenv ("SWFDEC_TEST_PLAYER"));
+  if (jobs <= 0 && g_getenv ("SWFDEC_TEST_JOBS"))
+    jobs = atoi (g_getenv ("SWFDEC_TEST_JOBS"));
+  if (timeout < 0 && g_getenv ("SWFDEC_TEST_TIMEOUT"))
+    timeout = atoi (g_getenv ("SWFDEC_TEST_TIMEOUT"));
 
-  script = load_script (script_filename);
+  run.script = load_script (script_filename);
   g_free (script_filename);
-  if (script == NULL)
+  if (run.script == NULL)
     return EXIT_FAILURE;
 
-  context = g_object_new (SWFDEC_TYPE_AS_CONTEXT, NULL);
-  swfdec_as_context_startup (context);
-
-  SWFDEC_AS_VALUE_SET_BOOLEAN (&val, dump);
-  swfdec_as_object_set_variable (context->global,
-      swfdec_as_context_get_string (context, "dump"), &val);
-
-  swfdec_test_function_init_context (context);
-  swfdec_as_context_run_init_script (context, swfdec_test_initialize, 
-      sizeof (swfdec_test_initialize), SWFDEC_TEST_VERSION);
-
-  array = swfdec_as_array_new (context);
-  if (array == NULL) {
-    g_print ("ERROR: Not enough memory");
-    return EXIT_FAILURE;
-  }
+  filenames = g_ptr_array_new ();
   if (argc < 2) {
     GDir *dir;
     const char *file;
@@ -208,31 +257,28 @@ main (int argc, char **argv)
     while ((file = g_dir_read_name (dir))) {
       if (!g_str_has_suffix (file, ".swf"))
 	continue;
-      SWFDEC_AS_VALUE_SET_STRING (&val, swfdec_as_context_get_string (context, file));
-      swfdec_as_array_push (array, &val);
+      g_ptr_array_add (filenames, g_strdup (file));
     }
     g_dir_close (dir);
   } else {
     for (i = 1; i < argc; i++) {
-      SWFDEC_AS_VALUE_SET_STRING (&val, swfdec_as_context_get_string (context, argv[i]));
-      swfdec_as_array_push (array, &val);
+      g_ptr_array_add (filenames, g_strdup (argv[i]));
     }
   }
-  SWFDEC_AS_VALUE_SET_OBJECT (&val, array);
-  swfdec_as_object_set_variable (context->global, 
-    swfdec_as_context_get_string (context, "filenames"), &val);
-  swfdec_as_object_run (context->global, script);
-  if (swfdec_as_context_catch (context, &val)) {
-    g_print ("ERROR: %s\n", swfdec_as_value_to_string (context, val));
-    ret = EXIT_FAILURE;
+
+  if (jobs > 0 || timeout > 0 || report != NULL) {
+    ret = swfdec_test_runner_run ((const char * const *) filenames->pdata, 
+	filenames->len, jobs, MAX (timeout, 0), report, run_script_isolated, &run);
   } else {
-    g_print ("SUCCESS\n");
-    ret = EXIT_SUCCESS;
+    ret = run_script (&run, (const char * const *) filenames->pdata, filenames->len);
   }
 
-  swfdec_script_unref (script);
-  g_object_unref (context);
+  for (i = 0; i < (int) filenames->len; i++) {
+    g_free (g_ptr_array_index (filenames, i));
+  }
+  g_ptr_array_free (filenames, TRUE);
+  g_free (report);
+  swfdec_script_unref (run.script);
 
   return ret;
 }
-
@@ -0,0 +1,307 @@
+/* Swfdec
+ * Copyright (C) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, 
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "swfdec_test_runner.h"
+
+/* This file runs every test file in its own process. That way a crash or a 
+ * hang in one test can't take down the whole test run and multiple tests can
+ * run in parallel. Each child's output is captured in a temporary file and 
+ * printed in one piece once the child exits, so output of different tests 
+ * doesn't get interleaved.
+ */
+
+typedef enum {
+  SWFDEC_TEST_RESULT_PASS,
+  SWFDEC_TEST_RESULT_FAIL,
+  SWFDEC_TEST_RESULT_CRASH,
+  SWFDEC_TEST_RESULT_TIMEOUT
+} SwfdecTestResult;
+
+static const char *result_names[] = { "pass", "fail", "crash", "timeout" };
+
+typedef struct {
+  const char *		filename;	/* file that is tested */
+  pid_t			pid;		/* pid of child or 0 if not running */
+  char *		output;		/* name of file output is captured in */
+  GTimer *		timer;		/* wall time since start of child */
+  gboolean		killed;		/* TRUE if we killed the child for timing out */
+  SwfdecTestResult	result;		/* result of the test */
+  double		time;		/* wall time the test took in seconds */
+  glong			rss;		/* peak resident set size in kB */
+} SwfdecTestJob;
+
+static gboolean
+swfdec_test_job_start (SwfdecTestJob *job, SwfdecTestRunFunc func, gpointer data)
+{
+  GError *error = NULL;
+  int fd;
+
+  fd = g_file_open_tmp ("swfdec-test-XXXXXX", &job->output, &error);
+  if (fd < 0) {
+    g_print ("ERROR: %s\n", error->message);
+    g_error_free (error);
+    return FALSE;
+  }
+  /* make sure buffered output doesn't get duplicated in the child */
+  fflush (stdout);
+  fflush (stderr);
+  job->pid = fork ();
+  if (job->pid < 0) {
+    g_print ("ERROR: could not fork: %s\n", g_strerror (errno));
+    close (fd);
+    unlink (job->output);
+    g_free (job->output);
+    job->output = NULL;
+    job->pid = 0;
+    return FALSE;
+  } else if (job->pid == 0) {
+    int ret;
+    dup2 (fd, STDOUT_FILENO);
+    dup2 (fd, STDERR_FILENO);
+    close (fd);
+    ret = func (job->filename, data);
+    fflush (stdout);
+    fflush (stderr);
+    _exit (ret);
+  }
+  close (fd);
+  job->timer = g_timer_new ();
+  return TRUE;
+}
+
+static void
+swfdec_test_job_finish (SwfdecTestJob *job, int status, const struct rusage *usage)
+{
+  char *contents;
+
+  g_timer_stop (job->timer);
+  job->time = g_timer_elapsed (job->timer, NULL);
+  g_timer_destroy (job->timer);
+  job->timer = NULL;
+  job->pid = 0;
+  /* ru_maxrss is in kilobytes on Linux */
+  job->rss = usage->ru_maxrss;
+
+  if (job->killed) {
+    job->result = SWFDEC_TEST_RESULT_TIMEOUT;
+  } else if (WIFSIGNALED (status)) {
+    job->result = SWFDEC_TEST_RESULT_CRASH;
+  } else if (WIFEXITED (status) && WEXITSTATUS (status) == EXIT_SUCCESS) {
+    job->result = SWFDEC_TEST_RESULT_PASS;
+  } else {
+    job->result = SWFDEC_TEST_RESULT_FAIL;
+  }
+
+  if (g_file_get_contents (job->output, &contents, NULL, NULL)) {
+    g_print ("%s", contents);
+    g_free (contents);
+  }
+  unlink (job->output);
+  g_free (job->output);
+  job->output = NULL;
+
+  switch (job->result) {
+    case SWFDEC_TEST_RESULT_CRASH:
+      g_print ("ERROR: %s crashed with signal %d\n", job->filename, WTERMSIG (status));
+      break;
+    case SWFDEC_TEST_RESULT_TIMEOUT:
+      g_print ("ERROR: %s timed out after %.1fs\n", job->filename, job->time);
+      break;
+    case SWFDEC_TEST_RESULT_PASS:
+    case SWFDEC_TEST_RESULT_FAIL:
+      break;
+    default:
+      g_assert_not_reached ();
+  }
+}
+
+static void
+swfdec_test_append_json_string (GString *string, const char *s)
+{
+  g_string_append_c (string, '"');
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\')
+      g_string_append_printf (string, "\\%c", *s);
+    else if ((guchar) *s < 0x20)
+      g_string_append_printf (string, "\\u%04X", (guint) *s);
+    else
+      g_string_append_c (string, *s);
+  }
+  g_string_append_c (string, '"');
+}
+
+static gboolean
+swfdec_test_write_report (const char *filename, const SwfdecTestJob *jobs, 
+    guint n_jobs, const guint *count, double time)
+{
+  GError *error = NULL;
+  GString *string;
+  guint i;
+
+  string = g_string_new ("{\n  \"tests\": [\n");
+  for (i = 0; i < n_jobs; i++) {
+    g_string_append (string, "    { \"file\": ");
+    swfdec_test_append_json_string (string, jobs[i].filename);
+    g_string_append_printf (string, ", \"result\": \"%s\", \"time\": %.3f, \"rss\": %ld }%s\n",
+	result_names[jobs[i].result], jobs[i].time, jobs[i].rss, 
+	i + 1 < n_jobs ? "," : "");
+  }
+  g_string_append_printf (string, "  ],\n  \"time\": %.3f", time);
+  for (i = 0; i < G_N_ELEMENTS (result_names); i++) {
+    g_string_append_printf (string, ",\n  \"%s\": %u", result_names[i], count[i]);
+  }
+  g_string_append (string, "\n}\n");
+
+  if (!g_file_set_contents (filename, string->str, string->len, &error)) {
+    g_print ("ERROR: could not write report: %s\n", error->message);
+    g_error_free (error);
+    g_string_free (string, TRUE);
+    return FALSE;
+  }
+  g_string_free (string, TRUE);
+  return TRUE;
+}
+
+/**
+ * swfdec_test_runner_run:
+ * @filenames: files to test
+ * @n_filenames: number of files in @filenames
+ * @n_jobs: maximum number of tests to run at the same time
+ * @timeout: time in seconds after which a test is killed or 0 for no limit
+ * @report: filename to write a JSON report to or %NULL
+ * @func: function running the test for one file
+ * @data: data to pass to @func
+ *
+ * Runs @func for every file in @filenames in a separate process, with up to
+ * @n_jobs of them running in parallel. The report contains result, wall time
+ * and peak memory usage of every test.
+ *
+ * Returns: %EXIT_SUCCESS if all tests passed, %EXIT_FAILURE otherwise
+ **/
+int
+swfdec_test_runner_run (const char * const *filenames, guint n_filenames, 
+    guint n_jobs, guint timeout, const char *report, SwfdecTestRunFunc func,
+    gpointer data)
+{
+  guint count[G_N_ELEMENTS (result_names)] = { 0, };
+  SwfdecTestJob *jobs;
+  GTimer *timer;
+  guint i, next, running;
+  int ret;
+
+  g_return_val_if_fail (filenames != NULL || n_filenames == 0, EXIT_FAILURE);
+  g_return_val_if_fail (func != NULL, EXIT_FAILURE);
+
+  n_jobs = MAX (n_jobs, 1);
+  jobs = g_new0 (SwfdecTestJob, n_filenames);
+  for (i = 0; i < n_filenames; i++) {
+    jobs[i].filename = filenames[i];
+  }
+
+  timer = g_timer_new ();
+  next = 0;
+  running = 0;
+  ret = EXIT_SUCCESS;
+  while (next < n_filenames || running > 0) {
+    struct rusage usage;
+    int status;
+    pid_t pid;
+
+    while (running < n_jobs && next < n_filenames) {
+      if (!swfdec_test_job_start (&jobs[next], func, data)) {
+	ret = EXIT_FAILURE;
+	goto out;
+      }
+      next++;
+      running++;
+    }
+
+    pid = wait4 (-1, &status, WNOHANG, &usage);
+    if (pid > 0) {
+      for (i = 0; i < next; i++) {
+	if (jobs[i].pid == pid)
+	  break;
+      }
+      if (i == next)
+	continue;
+      swfdec_test_job_finish (&jobs[i], status, &usage);
+      count[jobs[i].result]++;
+      running--;
+      continue;
+    } else if (pid < 0 && errno != EINTR) {
+      g_print ("ERROR: waiting for tests failed: %s\n", g_strerror (errno));
+      ret = EXIT_FAILURE;
+      goto out;
+    }
+
+    if (timeout > 0) {
+      for (i = 0; i < next; i++) {
+	if (jobs[i].pid == 0 || jobs[i].killed ||
+	    g_timer_elapsed (jobs[i].timer, NULL) < timeout)
+	  continue;
+	kill (jobs[i].pid, SIGKILL);
+	jobs[i].killed = TRUE;
+      }
+    }
+    g_usleep (G_USEC_PER_SEC / 100);
+  }
+
+  g_timer_stop (timer);
+  if (report && !swfdec_test_write_report (report, jobs, n_filenames, count, 
+	g_timer_elapsed (timer, NULL)))
+    ret = EXIT_FAILURE;
+
+  if (count[SWFDEC_TEST_RESULT_PASS] != n_filenames) {
+    g_print ("ERROR: %u of %u tests failed (%u crashed, %u timed out)\n",
+	n_filenames - count[SWFDEC_TEST_RESULT_PASS], n_filenames,
+	count[SWFDEC_TEST_RESULT_CRASH], count[SWFDEC_TEST_RESULT_TIMEOUT]);
+    ret = EXIT_FAILURE;
+  } else if (ret == EXIT_SUCCESS) {
+    g_print ("SUCCESS\n");
+  }
+
+out:
+  /* only reached with running children on errors, don't leave them behind */
+  for (i = 0; i < next; i++) {
+    if (jobs[i].pid == 0)
+      continue;
+    kill (jobs[i].pid, SIGKILL);
+    waitpid (jobs[i].pid, NULL, 0);
+    g_timer_destroy (jobs[i].timer);
+    unlink (jobs[i].output);
+    g_free (jobs[i].output);
+  }
+  g_timer_destroy (timer);
+  g_free (jobs);
+  return ret;
+}
@@ -0,0 +1,40 @@
+/* Swfdec
+ * Copyright (C) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, 
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifndef _SWFDEC_TEST_RUNNER_H_
+#define _SWFDEC_TEST_RUNNER_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* runs the test for a single file in a forked child, returns the exit code */
+typedef int (* SwfdecTestRunFunc) (const char *filename, gpointer data);
+
+int		swfdec_test_runner_run	(const char * const *	filenames,
+					 guint			n_filenames,
+					 guint			n_jobs,
+					 guint			timeout,
+					 const char *		report,
+					 SwfdecTestRunFunc	func,
+					 gpointer		data);
+
+
+G_END_DECLS
+#endif
@@ -0,0 +1,152 @@
+/* Swfdec
+ * Copyright (C) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, 
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <unistd.h>
+#include <glib/gstdio.h>
+#include "swfdec/swfdec_player_internal.h"
+
+#define ERROR(...) G_STMT_START { \
+  g_printerr ("ERROR (line %u): ", __LINE__); \
+  g_printerr (__VA_ARGS__); \
+  g_printerr ("\n"); \
+  errors++; \
+} G_STMT_END
+
+#define CHECK_STATS(cache, hits, misses) G_STMT_START { \
+  guint h_, m_; \
+  swfdec_load_cache_get_stats (cache, &h_, &m_); \
+  if (h_ != (hits) || m_ != (misses)) { \
+    ERROR ("stats are %u hits and %u misses, not %u and %u", h_, m_, \
+	(guint) (hits), (guint) (misses)); \
+  } \
+} G_STMT_END
+
+/* loads url and returns the size of the loaded data */
+static glong
+load (SwfdecPlayer *player, const char *url, SwfdecBuffer *post)
+{
+  SwfdecLoader *loader;
+  glong size;
+
+  loader = swfdec_player_load (player, url, post);
+  if (!swfdec_stream_is_complete (SWFDEC_STREAM (loader))) {
+    g_object_unref (loader);
+    return -1;
+  }
+  size = swfdec_loader_get_size (loader);
+  g_object_unref (loader);
+  return size;
+}
+
+static gboolean
+write_file (const char *filename, const char *contents)
+{
+  return g_file_set_contents (filename, contents, -1, NULL);
+}
+
+static guint
+check_cache (const char *filename)
+{
+  guint errors = 0;
+  SwfdecPlayer *player;
+  SwfdecLoadCache *cache;
+  SwfdecBuffer *post;
+  char *url;
+  glong size;
+
+  url = g_filename_to_uri (filename, NULL, NULL);
+  player = swfdec_player_new (NULL);
+  cache = swfdec_load_cache_new (1024);
+  swfdec_player_set_load_cache (player, cache);
+
+  /* first load goes to the file */
+  write_file (filename, "Hello");
+  size = load (player, url, NULL);
+  if (size != 5)
+    ERROR ("first load returned %ld bytes, not 5", size);
+  CHECK_STATS (cache, 0, 1);
+  if (swfdec_load_cache_get_size (cache) <= 5)
+    ERROR ("cache size is %zu, the file was not cached", swfdec_load_cache_get_size (cache));
+
+  /* second load is served from the cache, even though the file changed */
+  write_file (filename, "Bye");
+  size = load (player, url, NULL);
+  if (size != 5)
+    ERROR ("repeated load returned %ld bytes, not the 5 cached ones", size);
+  CHECK_STATS (cache, 1, 1);
+
+  /* POST requests bypass the cache */
+  post = swfdec_buffer_new_for_data ((guchar *) g_strdup ("a=b"), 3);
+  size = load (player, url, post);
+  swfdec_buffer_unref (post);
+  if (size != 3)
+    ERROR ("POST request returned %ld bytes, not 3", size);
+  CHECK_STATS (cache, 1, 1);
+
+  /* invalidating loads the file again */
+  if (!swfdec_load_cache_invalidate (cache, url))
+    ERROR ("invalidating %s didn't find a cached file", url);
+  size = load (player, url, NULL);
+  if (size != 3)
+    ERROR ("load after invalidating returned %ld bytes, not 3", size);
+  CHECK_STATS (cache, 1, 2);
+  size = load (player, url, NULL);
+  if (size != 3)
+    ERROR ("repeated load returned %ld bytes, not the 3 cached ones", size);
+  CHECK_STATS (cache, 2, 2);
+
+  /* clearing drops everything */
+  swfdec_load_cache_clear (cache);
+  if (swfdec_load_cache_get_size (cache) != 0)
+    ERROR ("cache size is %zu after clearing", swfdec_load_cache_get_size (cache));
+
+  g_object_unref (player);
+  g_object_unref (cache);
+  g_free (url);
+  return errors;
+}
+
+int
+main (int argc, char **argv)
+{
+  guint errors = 0;
+  char *filename;
+  int fd;
+
+  g_thread_init (NULL);
+  swfdec_init ();
+
+  fd = g_file_open_tmp ("loadcache-XXXXXX", &filename, NULL);
+  if (fd < 0) {
+    g_printerr ("could not create temporary file\n");
+    return 1;
+  }
+  close (fd);
+
+  errors += check_cache (filename);
+
+  g_unlink (filename);
+  g_free (filename);
+  g_print ("TOTAL ERRORS: %u\n", errors);
+  return errors;
+}
@@ -0,0 +1,151 @@
+/* Swfdec
+ * Copyright (C) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "swfdec/swfdec.h"
+#include "swfdec/swfdec_morphshape.h"
+#include "swfdec/swfdec_path.h"
+#include "swfdec/swfdec_pattern.h"
+
+#define ERROR(...) G_STMT_START { \
+  g_printerr ("ERROR (line %u): ", __LINE__); \
+  g_printerr (__VA_ARGS__); \
+  g_printerr ("\n"); \
+  errors++; \
+} G_STMT_END
+
+/* creates a morph shape with one fill using a path of n_points points */
+static SwfdecMorphShape *
+create_morph_shape (guint n_points)
+{
+  SwfdecMorphShape *morph;
+  SwfdecDraw *draw;
+  guint i;
+
+  draw = SWFDEC_DRAW (swfdec_pattern_new_color (0xFFFF0000));
+  swfdec_path_move_to (&draw->path, 0, 0);
+  swfdec_path_move_to (&draw->end_path, 0, 0);
+  for (i = 1; i < n_points; i++) {
+    swfdec_path_line_to (&draw->path, i, i % 2 ? 20 : 0);
+    swfdec_path_line_to (&draw->end_path, i * 2, i % 2 ? 0 : 40);
+  }
+  swfdec_draw_recompute (draw);
+
+  morph = g_object_new (SWFDEC_TYPE_MORPH_SHAPE, NULL);
+  SWFDEC_SHAPE (morph)->draws = g_slist_prepend (NULL, draw);
+  return morph;
+}
+
+static void
+free_draws (GSList *draws)
+{
+  g_slist_foreach (draws, (GFunc) g_object_unref, NULL);
+  g_slist_free (draws);
+}
+
+/* plays a tween of n_ratios ratios in a loop like a morph movie does and 
+ * returns the number of ratios that were found in the cache in the last
+ * loop */
+static guint
+loop_tween (SwfdecMorphShape *morph, guint n_ratios, guint n_loops)
+{
+  GSList **previous;
+  guint i, j, hits = 0;
+
+  previous = g_new0 (GSList *, n_ratios);
+  for (i = 0; i < n_loops; i++) {
+    hits = 0;
+    for (j = 0; j < n_ratios; j++) {
+      /* skip ratio 0, it's not morphed */
+      GSList *draws = swfdec_morph_shape_get_draws (morph, 65535 * (j + 1) / n_ratios);
+      /* previous keeps the old draws alive, so equal pointers mean a hit */
+      if (previous[j] && previous[j]->data == draws->data)
+	hits++;
+      free_draws (previous[j]);
+      previous[j] = draws;
+    }
+  }
+  for (j = 0; j < n_ratios; j++) {
+    free_draws (previous[j]);
+  }
+  g_free (previous);
+  return hits;
+}
+
+/* a tween with more ratios than an LRU cache of a fixed number of entries 
+ * would hold must still be cached when it fits in memory */
+static guint
+check_many_ratios (void)
+{
+  SwfdecMorphShape *morph;
+  guint errors = 0;
+  guint hits;
+
+  morph = create_morph_shape (4);
+  hits = loop_tween (morph, 300, 3);
+  if (hits != 300)
+    ERROR ("%u of 300 small ratios were cached", hits);
+  g_object_unref (morph);
+  return errors;
+}
+
+/* a tween that doesn't fit in memory must keep hitting the ratios it did 
+ * cache instead of evicting the ones it needs next */
+static guint
+check_too_many_ratios (void)
+{
+  SwfdecMorphShape *morph;
+  guint errors = 0;
+  guint hits, more_hits;
+
+  /* each ratio uses about 32kB */
+  morph = create_morph_shape (1000);
+  hits = loop_tween (morph, 200, 2);
+  if (hits == 0)
+    ERROR ("none of 200 large ratios were cached");
+  if (hits == 200)
+    ERROR ("all of 200 large ratios were cached, the test needs bigger ratios");
+  if (morph->ratios_size > SWFDEC_MORPH_SHAPE_MAX_SIZE) {
+    ERROR ("%"G_GSIZE_FORMAT" bytes of ratios cached, more than %u", 
+	morph->ratios_size, (guint) SWFDEC_MORPH_SHAPE_MAX_SIZE);
+  }
+  more_hits = loop_tween (morph, 200, 2);
+  if (more_hits != hits)
+    ERROR ("%u ratios were cached in the next loops, not %u", more_hits, hits);
+  g_object_unref (morph);
+  return errors;
+}
+
+int
+main (int argc, char **argv)
+{
+  guint errors = 0;
+
+  g_thread_init (NULL);
+  swfdec_init ();
+
+  errors += check_many_ratios ();
+  errors += check_too_many_ratios ();
+
+  g_print ("TOTAL ERRORS: %u\n", errors);
+  return errors;
+}
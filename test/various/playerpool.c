@@ -0,0 +1,147 @@
+/* Swfdec
+ * Copyright (C) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, 
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <swfdec/swfdec.h>
+
+#define ERROR(...) G_STMT_START { \
+  g_printerr ("ERROR (line %u): ", __LINE__); \
+  g_printerr (__VA_ARGS__); \
+  g_printerr ("\n"); \
+  errors++; \
+} G_STMT_END
+
+#define N_PLAYERS 2
+#define N_ADVANCES 10
+
+static SwfdecPlayer *
+create_player (const char *filename)
+{
+  SwfdecPlayer *player;
+  SwfdecURL *url;
+  char *uri;
+
+  uri = g_filename_to_uri (filename, NULL, NULL);
+  url = swfdec_url_new (uri);
+  player = swfdec_player_new (NULL);
+  swfdec_player_set_url (player, url);
+  swfdec_url_free (url);
+  g_free (uri);
+  return player;
+}
+
+static gboolean
+surfaces_equal (cairo_surface_t *a, cairo_surface_t *b)
+{
+  int y, width, height;
+
+  width = cairo_image_surface_get_width (a);
+  height = cairo_image_surface_get_height (a);
+  if (width != cairo_image_surface_get_width (b) ||
+      height != cairo_image_surface_get_height (b))
+    return FALSE;
+
+  for (y = 0; y < height; y++) {
+    if (memcmp (cairo_image_surface_get_data (a) + y * cairo_image_surface_get_stride (a),
+	  cairo_image_surface_get_data (b) + y * cairo_image_surface_get_stride (b),
+	  width * 4) != 0)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+/* runs the same file in multiple players in parallel, so that they share 
+ * decoders, images and scripts, and checks they all render the same thing */
+static guint
+check_file (const char *filename)
+{
+  guint errors = 0;
+  SwfdecPlayerPool *pool;
+  SwfdecPlayer *players[N_PLAYERS];
+  cairo_surface_t *surfaces[N_PLAYERS];
+  cairo_t *cr[N_PLAYERS];
+  guint i, step, width, height;
+
+  pool = swfdec_player_pool_new (2);
+  for (i = 0; i < N_PLAYERS; i++) {
+    players[i] = create_player (filename);
+    swfdec_player_pool_add (pool, players[i]);
+  }
+
+  for (step = 0; step < N_ADVANCES; step++) {
+    for (i = 0; i < N_PLAYERS; i++) {
+      swfdec_player_pool_advance (pool, players[i], 100);
+    }
+    swfdec_player_pool_wait (pool, NULL);
+  }
+
+  for (i = 0; i < N_PLAYERS; i++) {
+    if (!swfdec_player_is_initialized (players[i])) {
+      ERROR ("player %u is not initialized", i);
+      surfaces[i] = NULL;
+      continue;
+    }
+    swfdec_player_get_default_size (players[i], &width, &height);
+    surfaces[i] = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+    cr[i] = cairo_create (surfaces[i]);
+    swfdec_player_pool_render (pool, players[i], cr[i]);
+  }
+  swfdec_player_pool_wait (pool, NULL);
+
+  for (i = 0; i < N_PLAYERS; i++) {
+    if (surfaces[i] == NULL)
+      continue;
+    cairo_destroy (cr[i]);
+    if (i > 0 && surfaces[0] != NULL && !surfaces_equal (surfaces[0], surfaces[i]))
+      ERROR ("player %u rendered differently than player 0", i);
+  }
+
+  for (i = 0; i < N_PLAYERS; i++) {
+    swfdec_player_pool_remove (pool, players[i]);
+    g_object_unref (players[i]);
+    if (surfaces[i])
+      cairo_surface_destroy (surfaces[i]);
+  }
+  g_object_unref (pool);
+  return errors;
+}
+
+int
+main (int argc, char **argv)
+{
+  guint errors = 0;
+  int i;
+
+  g_thread_init (NULL);
+  swfdec_init ();
+
+  if (argc > 1) {
+    for (i = 1; i < argc; i++)
+      errors += check_file (argv[i]);
+  } else {
+    errors += check_file (TEST_FILE);
+  }
+
+  g_print ("TOTAL ERRORS: %u\n", errors);
+  return errors;
+}
@@ -0,0 +1,177 @@
+/* Swfdec
+ * Copyright (C) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include "swfdec/swfdec.h"
+#include "swfdec/swfdec_text_buffer.h"
+#include "swfdec/swfdec_text_layout.h"
+
+#define ERROR(...) G_STMT_START { \
+  g_printerr ("ERROR (line %u): ", __LINE__); \
+  g_printerr (__VA_ARGS__); \
+  g_printerr ("\n"); \
+  errors++; \
+} G_STMT_END
+
+/* compares a layout that was updated after changes to one that was layouted
+ * from scratch with the same text */
+static guint
+compare_layout (SwfdecTextLayout *layout, const char *name)
+{
+  SwfdecTextBuffer *buffer;
+  SwfdecTextLayout *expected;
+  guint errors = 0;
+  guint i, n;
+
+  buffer = swfdec_text_buffer_new ();
+  swfdec_text_buffer_insert_text (buffer, 0,
+      swfdec_text_buffer_get_text (layout->text));
+  expected = swfdec_text_layout_new (buffer);
+  swfdec_text_layout_set_word_wrap (expected,
+      swfdec_text_layout_get_word_wrap (layout));
+  swfdec_text_layout_set_wrap_width (expected,
+      swfdec_text_layout_get_wrap_width (layout));
+
+  n = swfdec_text_layout_get_n_rows (expected);
+  if (swfdec_text_layout_get_n_rows (layout) != n) {
+    ERROR ("%s: %u rows, not %u", name, swfdec_text_layout_get_n_rows (layout), n);
+  } else {
+    for (i = 0; i < n; i++) {
+      gsize index_, expected_index;
+      swfdec_text_layout_query_position (expected, i, 0, 0, &expected_index, NULL, NULL);
+      swfdec_text_layout_query_position (layout, i, 0, 0, &index_, NULL, NULL);
+      if (index_ != expected_index)
+	ERROR ("%s: row %u starts at %zu, not %zu", name, i, index_, expected_index);
+    }
+  }
+  if (swfdec_text_layout_get_width (layout) != swfdec_text_layout_get_width (expected)) {
+    ERROR ("%s: width is %u, not %u", name, swfdec_text_layout_get_width (layout),
+	swfdec_text_layout_get_width (expected));
+  }
+  if (swfdec_text_layout_get_height (layout) != swfdec_text_layout_get_height (expected)) {
+    ERROR ("%s: height is %u, not %u", name, swfdec_text_layout_get_height (layout),
+	swfdec_text_layout_get_height (expected));
+  }
+
+  g_object_unref (expected);
+  g_object_unref (buffer);
+  return errors;
+}
+
+static void
+replace (SwfdecTextBuffer *buffer, gsize pos, gsize length, const char *text)
+{
+  if (length)
+    swfdec_text_buffer_delete_text (buffer, pos, length);
+  swfdec_text_buffer_insert_text (buffer, pos, text);
+}
+
+static guint
+check_changes (gboolean word_wrap, gboolean ensure)
+{
+  SwfdecTextBuffer *buffer;
+  SwfdecTextLayout *layout;
+  guint errors = 0;
+  guint i;
+
+#define CHECK(name) G_STMT_START { \
+  if (ensure) \
+    errors += compare_layout (layout, name); \
+} G_STMT_END
+
+  buffer = swfdec_text_buffer_new ();
+  layout = swfdec_text_layout_new (buffer);
+  swfdec_text_layout_set_word_wrap (layout, word_wrap);
+  swfdec_text_layout_set_wrap_width (layout, 60);
+  errors += compare_layout (layout, "empty");
+
+  /* appending lots of small pieces like the HTML parser does */
+  for (i = 0; i < 50; i++) {
+    swfdec_text_buffer_insert_text (buffer, swfdec_text_buffer_get_length (buffer),
+	i % 7 == 6 ? "\n" : "word ");
+    CHECK ("appending");
+  }
+  errors += compare_layout (layout, "appended");
+
+  /* changes in the middle of a paragraph, at its start and at its end */
+  replace (buffer, 12, 3, "changed");
+  CHECK ("middle");
+  replace (buffer, 0, 1, "W");
+  CHECK ("start");
+  replace (buffer, 34, 0, "more words in this paragraph ");
+  CHECK ("end");
+
+  /* joining and splitting paragraphs */
+  for (i = 0; i < swfdec_text_buffer_get_length (buffer); i++) {
+    if (swfdec_text_buffer_get_text (buffer)[i] == '\n') {
+      replace (buffer, i, 1, " ");
+      break;
+    }
+  }
+  CHECK ("join");
+  replace (buffer, 20, 0, "\r\n");
+  CHECK ("split");
+
+  /* two changes far apart before layouting again */
+  replace (buffer, 3, 2, "xx");
+  replace (buffer, swfdec_text_buffer_get_length (buffer) - 10, 4, "yyyyyyyy");
+  CHECK ("two changes");
+
+  /* replacing everything but a common start, like setting the text does */
+  replace (buffer, 40, swfdec_text_buffer_get_length (buffer) - 40, "new end\nof text");
+  CHECK ("new end");
+  replace (buffer, 0, swfdec_text_buffer_get_length (buffer), "");
+  CHECK ("delete all");
+  replace (buffer, 0, 0, "a\n\nb");
+  CHECK ("empty paragraph");
+  replace (buffer, 1, 2, "");
+  CHECK ("remove empty paragraph");
+
+  errors += compare_layout (layout, "final");
+  if (errors) {
+    g_printerr ("  with word wrap %s, %s\n", word_wrap ? "on" : "off",
+	ensure ? "layouting after every change" : "layouting at the end");
+  }
+#undef CHECK
+
+  g_object_unref (layout);
+  g_object_unref (buffer);
+  return errors;
+}
+
+int
+main (int argc, char **argv)
+{
+  guint errors = 0;
+
+  g_thread_init (NULL);
+  swfdec_init ();
+
+  errors += check_changes (FALSE, FALSE);
+  errors += check_changes (FALSE, TRUE);
+  errors += check_changes (TRUE, FALSE);
+  errors += check_changes (TRUE, TRUE);
+
+  g_print ("TOTAL ERRORS: %u\n", errors);
+  return errors;
+}
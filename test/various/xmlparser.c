@@ -0,0 +1,245 @@
+/* Swfdec
+ * Copyright (C) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include "swfdec/swfdec_player_internal.h"
+#include "swfdec/swfdec_sandbox.h"
+#include "swfdec/swfdec_xml.h"
+
+#define ERROR(...) G_STMT_START { \
+  g_printerr ("ERROR (line %u): ", __LINE__); \
+  g_printerr (__VA_ARGS__); \
+  g_printerr ("\n"); \
+  errors++; \
+} G_STMT_END
+
+/* every kind of token, with enough whitespace to make ignoreWhite matter */
+static const char *document =
+  "<?xml version=\"1.0\" ?>"
+  "<!DOCTYPE greeting [ <!ELEMENT greeting (#PCDATA)> ]>\n"
+  "<greeting lang=\"en\" id='hello' escaped=\"a \\\" b\">\n"
+  "  <!-- a comment with <tags> inside -->\n"
+  "  Hello &amp; welcome\n"
+  "  <![CDATA[ <not> a tag ]]>\n"
+  "  <empty />\n"
+  "  <nested a=\"1\"\tb = \"2\"><deeper>text</deeper></nested>\n"
+  "</greeting>\n";
+
+typedef struct {
+  SwfdecXmlNode *	other;
+  guint			count;
+  guint			errors;
+} AttributeData;
+
+static gboolean
+check_attribute (SwfdecAsObject *object, const char *variable,
+    SwfdecAsValue *value, guint flags, gpointer datap)
+{
+  AttributeData *data = datap;
+  const char *mine, *other;
+
+  data->count++;
+  mine = swfdec_as_value_to_string (object->context, *value);
+  other = swfdec_xml_node_get_attribute (data->other, variable);
+  if (other == NULL || strcmp (mine, other) != 0) {
+    g_printerr ("ERROR: attribute %s is \"%s\", not \"%s\"\n", variable,
+	other ? other : "(none)", mine);
+    data->errors++;
+  }
+  return TRUE;
+}
+
+static guint
+count_attributes (SwfdecXmlNode *node)
+{
+  GSList *list;
+  guint count;
+
+  list = swfdec_as_object_enumerate (node->attributes);
+  count = g_slist_length (list);
+  g_slist_free (list);
+  return count;
+}
+
+/* compares node trees made by parsing at once and parsing while streaming */
+static guint
+compare_nodes (SwfdecXmlNode *expected, SwfdecXmlNode *node)
+{
+  AttributeData data = { node, 0, 0 };
+  guint errors = 0;
+  gint32 i;
+
+  if (expected->type != node->type) {
+    ERROR ("node type is %u, not %u", node->type, expected->type);
+    return errors;
+  }
+  if (g_strcmp0 (expected->name, node->name) != 0)
+    ERROR ("node name is \"%s\", not \"%s\"", node->name, expected->name);
+  if (g_strcmp0 (expected->value, node->value) != 0)
+    ERROR ("node value is \"%s\", not \"%s\"", node->value, expected->value);
+
+  swfdec_as_object_foreach (expected->attributes, check_attribute, &data);
+  errors += data.errors;
+  if (data.count != count_attributes (node))
+    ERROR ("%u attributes, not %u", count_attributes (node), data.count);
+
+  if (swfdec_xml_node_num_children (expected) != swfdec_xml_node_num_children (node)) {
+    ERROR ("%d children, not %d", swfdec_xml_node_num_children (node),
+	swfdec_xml_node_num_children (expected));
+    return errors;
+  }
+  for (i = 0; i < swfdec_xml_node_num_children (expected); i++) {
+    errors += compare_nodes (swfdec_xml_node_get_child (expected, i),
+	swfdec_xml_node_get_child (node, i));
+  }
+  return errors;
+}
+
+/* feeds the document in chunks of chunk_size bytes, so most tokens are split
+ * across pushes, and parses with a budget of budget tokens per call */
+static guint
+check_streaming (SwfdecPlayer *player, gboolean ignore_white, gsize chunk_size,
+    guint budget)
+{
+  SwfdecAsContext *cx = SWFDEC_AS_CONTEXT (player);
+  SwfdecXmlParser *parser;
+  SwfdecXml *expected, *xml;
+  guint errors = 0;
+  const char *s;
+  gsize pos, len;
+
+  s = swfdec_as_context_get_string (cx, document);
+  len = strlen (document);
+  expected = swfdec_xml_new_no_properties (cx, s, ignore_white);
+
+  parser = swfdec_xml_parser_new (cx, ignore_white);
+  for (pos = 0; pos < len; pos += chunk_size) {
+    guint left;
+    gboolean more;
+
+    swfdec_xml_parser_push (parser, document + pos, MIN (chunk_size, len - pos));
+    do {
+      left = budget;
+      more = swfdec_xml_parser_parse (parser, &left);
+      if (left > budget)
+	ERROR ("budget grew from %u to %u", budget, left);
+      if (more && left != 0)
+	ERROR ("parsing was interrupted with %u tokens left", left);
+    } while (more);
+  }
+
+  /* this is what the loaders do when the stream is closed */
+  swfdec_xml_parser_finish (parser, s);
+  player->priv->xml_parser = parser;
+  xml = swfdec_xml_new_no_properties (cx, s, ignore_white);
+  player->priv->xml_parser = NULL;
+
+  if (xml->status != expected->status) {
+    ERROR ("%u byte chunks, %u tokens: status is %d, not %d", (guint) chunk_size,
+	budget, xml->status, expected->status);
+  }
+  if (g_strcmp0 (xml->xml_decl, expected->xml_decl) != 0)
+    ERROR ("xml declaration is \"%s\", not \"%s\"", xml->xml_decl, expected->xml_decl);
+  if (g_strcmp0 (xml->doc_type_decl, expected->doc_type_decl) != 0)
+    ERROR ("doctype is \"%s\", not \"%s\"", xml->doc_type_decl, expected->doc_type_decl);
+  errors += compare_nodes (SWFDEC_XML_NODE (expected), SWFDEC_XML_NODE (xml));
+  if (errors) {
+    g_printerr ("  while parsing %u byte chunks with %u tokens per call%s\n",
+	(guint) chunk_size, budget, ignore_white ? ", ignoring whitespace" : "");
+  }
+
+  swfdec_xml_parser_free (parser);
+  return errors;
+}
+
+/* the budget counts tokens, so how far parsing gets is the same everywhere */
+static guint
+check_budget (SwfdecPlayer *player)
+{
+  SwfdecXmlParser *parser;
+  guint errors = 0;
+  guint budget, calls;
+
+  parser = swfdec_xml_parser_new (SWFDEC_AS_CONTEXT (player), FALSE);
+  /* 5 complete tokens and the start of a 6th */
+  swfdec_xml_parser_push (parser, "<a><b>text</b></a><c", strlen ("<a><b>text</b></a><c"));
+
+  calls = 0;
+  do {
+    budget = 2;
+    calls++;
+  } while (swfdec_xml_parser_parse (parser, &budget));
+  if (calls != 3)
+    ERROR ("parsing 5 tokens 2 at a time took %u calls, not 3", calls);
+  if (budget != 1)
+    ERROR ("%u tokens left after parsing the last one, not 1", budget);
+
+  /* an incomplete token must not use up the budget */
+  budget = 2;
+  if (swfdec_xml_parser_parse (parser, &budget))
+    ERROR ("parsing an incomplete token wants to continue");
+  if (budget != 2)
+    ERROR ("parsing an incomplete token used %u tokens", 2 - budget);
+
+  /* without a budget everything is parsed */
+  swfdec_xml_parser_push (parser, " /><d /><e />", strlen (" /><d /><e />"));
+  if (swfdec_xml_parser_parse (parser, NULL))
+    ERROR ("parsing without a budget wants to continue");
+
+  swfdec_xml_parser_free (parser);
+  return errors;
+}
+
+int
+main (int argc, char **argv)
+{
+  static const gsize chunk_sizes[] = { 1, 2, 3, 7, 64, 4096 };
+  static const guint budgets[] = { 1, 2, 5, 1024 };
+  SwfdecPlayer *player;
+  SwfdecSandbox *sandbox;
+  SwfdecURL *url;
+  guint errors = 0;
+  guint i, j;
+
+  g_thread_init (NULL);
+  swfdec_init ();
+
+  player = swfdec_player_new (NULL);
+  url = swfdec_url_new ("file:///");
+  sandbox = swfdec_sandbox_get_for_url (player, url, 8, FALSE);
+  swfdec_url_free (url);
+  swfdec_sandbox_use (sandbox);
+
+  errors += check_budget (player);
+  for (i = 0; i < G_N_ELEMENTS (chunk_sizes); i++) {
+    for (j = 0; j < G_N_ELEMENTS (budgets); j++) {
+      errors += check_streaming (player, FALSE, chunk_sizes[i], budgets[j]);
+      errors += check_streaming (player, TRUE, chunk_sizes[i], budgets[j]);
+    }
+  }
+
+  swfdec_sandbox_unuse (sandbox);
+  g_object_unref (player);
+  g_print ("TOTAL ERRORS: %u\n", errors);
+  return errors;
+}
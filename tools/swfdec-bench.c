@@ -0,0 +1,975 @@
+/* Swfdec
+ * Copyright (C) 2008 Benjamin Otte <otte@gnome.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <swfdec/swfdec.h>
+#include <swfdec/swfdec_as_internal.h>
+#include <swfdec/swfdec_as_string.h>
+#include <swfdec/swfdec_image_decoder.h>
+#include <swfdec/swfdec_movie.h>
+#include <swfdec/swfdec_player_internal.h>
+#include <swfdec/swfdec_resource.h>
+#include <swfdec/swfdec_sandbox.h>
+#include <swfdec/swfdec_sprite_movie.h>
+#include <swfdec/swfdec_swf_decoder.h>
+
+/* Plays every file for a fixed amount of virtual time and measures where the
+ * real time went. ActionScript time is measured using a debugger that watches
+ * the outermost frame, garbage collection is triggered by us instead of the
+ * player so it can be timed, and decoding is measured by hooking the parse
+ * functions of the decoders. Note that images are decoded lazily, so their
+ * decoding time is part of the rendering time.
+ */
+
+typedef enum {
+  BENCH_AS,
+  BENCH_RENDER,
+  BENCH_AUDIO,
+  BENCH_GC,
+  BENCH_DECODE,
+  BENCH_OTHER,
+  BENCH_TOTAL,
+  N_BENCH_TIMES
+} BenchTime;
+
+static const char *bench_time_names[N_BENCH_TIMES] = {
+  "as", "render", "audio", "gc", "decode", "other", "time"
+};
+
+typedef struct {
+  char *		filename;	/* file that was benchmarked */
+  double		time[N_BENCH_TIMES]; /* seconds spent in the various parts */
+  guint			frames;		/* number of frames played */
+  gsize			memory;		/* peak memory used by the script engine */
+  gboolean		aborted;	/* TRUE if the file didn't play for the full time */
+} BenchResult;
+
+/* timers for the code we can't call ourselves */
+static GTimer *as_timer = NULL;
+static GTimer *decode_timer = NULL;
+static double as_time, decode_time;
+
+/*** DEBUGGER ***/
+
+typedef SwfdecAsDebugger BenchDebugger;
+typedef SwfdecAsDebuggerClass BenchDebuggerClass;
+
+GType bench_debugger_get_type (void);
+G_DEFINE_TYPE (BenchDebugger, bench_debugger, SWFDEC_TYPE_AS_DEBUGGER)
+
+static void
+bench_debugger_enter_frame (SwfdecAsDebugger *debugger, SwfdecAsContext *context,
+    SwfdecAsFrame *frame)
+{
+  if (as_timer == NULL)
+    as_timer = g_timer_new ();
+}
+
+static void
+bench_debugger_leave_frame (SwfdecAsDebugger *debugger, SwfdecAsContext *context,
+    SwfdecAsFrame *frame, const SwfdecAsValue *return_value)
+{
+  /* the frame has already been removed when this function gets called */
+  if (as_timer == NULL || context->frame != NULL)
+    return;
+
+  as_time += g_timer_elapsed (as_timer, NULL);
+  g_timer_destroy (as_timer);
+  as_timer = NULL;
+}
+
+static void
+bench_debugger_class_init (BenchDebuggerClass *klass)
+{
+  klass->enter_frame = bench_debugger_enter_frame;
+  klass->leave_frame = bench_debugger_leave_frame;
+}
+
+static void
+bench_debugger_init (BenchDebugger *debugger)
+{
+}
+
+/*** DECODERS ***/
+
+static SwfdecStatus (* swf_decoder_parse) (SwfdecDecoder *, SwfdecBuffer *);
+static SwfdecStatus (* image_decoder_parse) (SwfdecDecoder *, SwfdecBuffer *);
+
+static SwfdecStatus
+bench_decoder_parse (SwfdecDecoder *decoder, SwfdecBuffer *buffer)
+{
+  SwfdecStatus status;
+
+  g_timer_start (decode_timer);
+  if (SWFDEC_IS_SWF_DECODER (decoder))
+    status = swf_decoder_parse (decoder, buffer);
+  else
+    status = image_decoder_parse (decoder, buffer);
+  decode_time += g_timer_elapsed (decode_timer, NULL);
+  return status;
+}
+
+static void
+bench_hook_decoders (void)
+{
+  SwfdecDecoderClass *klass;
+
+  decode_timer = g_timer_new ();
+  klass = g_type_class_ref (SWFDEC_TYPE_SWF_DECODER);
+  swf_decoder_parse = klass->parse;
+  klass->parse = bench_decoder_parse;
+  klass = g_type_class_ref (SWFDEC_TYPE_IMAGE_DECODER);
+  image_decoder_parse = klass->parse;
+  klass->parse = bench_decoder_parse;
+}
+
+/*** BENCHMARKING ***/
+
+static void
+bench_render_audio (SwfdecPlayer *player, guint msecs, guint n_samples, double *audio_time)
+{
+  static gint16 *samples = NULL;
+  static guint samples_size = 0;
+  const GList *walk;
+  GTimer *timer;
+
+  if (n_samples > samples_size) {
+    g_free (samples);
+    samples_size = n_samples;
+    samples = g_new (gint16, 2 * samples_size);
+  }
+  timer = g_timer_new ();
+  for (walk = swfdec_player_get_audio (player); walk; walk = walk->next) {
+    memset (samples, 0, n_samples * 2 * sizeof (gint16));
+    swfdec_audio_render (walk->data, samples, 0, n_samples);
+  }
+  *audio_time += g_timer_elapsed (timer, NULL);
+  g_timer_destroy (timer);
+}
+
+static void
+bench_run (BenchResult *result, glong play_time, glong max_time,
+    int width, int height, gsize gc_threshold, SwfdecAsProfiler *profiler)
+{
+  static const GTimeVal the_beginning = { 1035840244, 123 };
+  SwfdecAsDebugger *debugger;
+  SwfdecAsContext *context;
+  SwfdecPlayer *player;
+  cairo_surface_t *surface;
+  GTimer *timer, *part;
+  double advance_time, audio_time;
+  glong played, advance;
+  guint w, h;
+  SwfdecURL *url;
+  cairo_t *cr;
+
+  as_time = 0;
+  decode_time = 0;
+  advance_time = 0;
+  audio_time = 0;
+  timer = g_timer_new ();
+  part = g_timer_new ();
+
+  debugger = g_object_new (bench_debugger_get_type (), NULL);
+  /* GC never triggers itself, we call it below to be able to time it */
+  player = g_object_new (SWFDEC_TYPE_PLAYER, "random-seed", 0,
+      "loader-type", SWFDEC_TYPE_FILE_LOADER, "max-runtime", 0,
+      "start-time", &the_beginning, "memory-until-gc", G_MAXULONG,
+      "debugger", debugger, "profiler", profiler, NULL);
+  g_object_unref (debugger);
+  context = SWFDEC_AS_CONTEXT (player);
+  g_signal_connect (player, "advance", G_CALLBACK (bench_render_audio), &audio_time);
+  url = swfdec_url_new_from_input (result->filename);
+  swfdec_player_set_url (player, url);
+  swfdec_url_free (url);
+  while (swfdec_player_get_next_event (player) == 0)
+    swfdec_player_advance (player, 0);
+
+  if (width > 0 && height > 0) {
+    swfdec_player_set_size (player, width, height);
+  } else {
+    swfdec_player_get_default_size (player, &w, &h);
+    width = MAX (w, 1);
+    height = MAX (h, 1);
+  }
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cr = cairo_create (surface);
+
+  played = 0;
+  while (played < play_time && !swfdec_as_context_is_aborted (context)) {
+    if (g_timer_elapsed (timer, NULL) * 1000 >= max_time)
+      break;
+    advance = swfdec_player_get_next_event (player);
+    if (advance < 0)
+      break;
+
+    g_timer_start (part);
+    played += swfdec_player_advance (player, MIN (advance, play_time - played));
+    advance_time += g_timer_elapsed (part, NULL);
+    result->frames++;
+
+    result->memory = MAX (result->memory, context->memory);
+    if (context->memory_since_gc >= gc_threshold) {
+      g_timer_start (part);
+      swfdec_as_context_gc (context);
+      result->time[BENCH_GC] += g_timer_elapsed (part, NULL);
+    }
+
+    g_timer_start (part);
+    swfdec_player_render (player, cr);
+    cairo_surface_flush (surface);
+    result->time[BENCH_RENDER] += g_timer_elapsed (part, NULL);
+  }
+  result->aborted = played < play_time;
+
+  g_object_unref (player);
+  cairo_destroy (cr);
+  cairo_surface_destroy (surface);
+
+  result->time[BENCH_TOTAL] = g_timer_elapsed (timer, NULL);
+  result->time[BENCH_AS] = as_time;
+  result->time[BENCH_AUDIO] = audio_time;
+  result->time[BENCH_DECODE] = decode_time;
+  /* everything happening inside swfdec_player_advance() we don't know about */
+  result->time[BENCH_OTHER] = MAX (0, advance_time - as_time - audio_time - decode_time);
+  g_timer_destroy (part);
+  g_timer_destroy (timer);
+}
+
+/* creates sandboxes for different hosts and measures how long their 
+ * initialization takes. This is what loading content from lots of domains 
+ * costs. */
+static void
+bench_sandboxes (guint n_sandboxes, guint version)
+{
+  SwfdecPlayer *player;
+  GTimer *timer;
+  double startup;
+  guint i;
+
+  timer = g_timer_new ();
+  player = swfdec_player_new (NULL);
+  startup = g_timer_elapsed (timer, NULL);
+
+  g_timer_start (timer);
+  for (i = 0; i < n_sandboxes; i++) {
+    SwfdecURL *url;
+    char *s;
+
+    s = g_strdup_printf ("http://host%u.example/", i);
+    url = swfdec_url_new (s);
+    swfdec_sandbox_get_for_url (player, url, version, TRUE);
+    swfdec_url_free (url);
+    g_free (s);
+  }
+  g_print ("SANDBOXES: player %.3fms, %u sandboxes %.3fms (%.3fms each), memory %"G_GSIZE_FORMAT"\n",
+      startup * 1000, n_sandboxes, g_timer_elapsed (timer, NULL) * 1000,
+      n_sandboxes ? g_timer_elapsed (timer, NULL) * 1000 / n_sandboxes : 0.0,
+      SWFDEC_AS_CONTEXT (player)->memory);
+
+  g_object_unref (player);
+  g_timer_destroy (timer);
+}
+
+/* adds lots of timeouts that reschedule themselves like intervals and plays 
+ * them for the given amount of time. This stresses the timeout scheduling 
+ * done for every setInterval() and every frame. */
+typedef struct {
+  SwfdecTimeout		timeout;
+  SwfdecPlayer *	player;
+  SwfdecTick		interval;	/* time between two triggers */
+  guint *		triggered;	/* counter for triggered timeouts */
+} BenchTimeout;
+
+static void
+bench_timeout_trigger (SwfdecTimeout *timeout)
+{
+  BenchTimeout *bench = (BenchTimeout *) timeout;
+
+  (*bench->triggered)++;
+  timeout->timestamp += bench->interval;
+  swfdec_player_add_timeout (bench->player, timeout);
+}
+
+static void
+bench_timeouts (guint n_timeouts, glong play_time)
+{
+  BenchTimeout *timeouts;
+  SwfdecPlayer *player;
+  guint i, triggered = 0;
+  glong played = 0;
+  GTimer *timer;
+
+  player = swfdec_player_new (NULL);
+  timeouts = g_new0 (BenchTimeout, n_timeouts);
+  timer = g_timer_new ();
+  for (i = 0; i < n_timeouts; i++) {
+    timeouts[i].player = player;
+    timeouts[i].triggered = &triggered;
+    /* intervals between 10ms and 1s, lots of them identical */
+    timeouts[i].interval = SWFDEC_MSECS_TO_TICKS (10 + (i * 37) % 100 * 10);
+    timeouts[i].timeout.timestamp = player->priv->time + timeouts[i].interval;
+    timeouts[i].timeout.callback = bench_timeout_trigger;
+    swfdec_player_add_timeout (player, &timeouts[i].timeout);
+  }
+  g_print ("TIMEOUTS: adding %u timeouts %.3fms\n", n_timeouts,
+      g_timer_elapsed (timer, NULL) * 1000);
+
+  g_timer_start (timer);
+  while (played < play_time) {
+    glong advance = swfdec_player_get_next_event (player);
+    if (advance < 0)
+      break;
+    played += swfdec_player_advance (player, MIN (advance, play_time - played));
+  }
+  g_print ("TIMEOUTS: %u triggers in %ldms virtual time took %.3fms\n", triggered,
+      played, g_timer_elapsed (timer, NULL) * 1000);
+
+  g_timer_start (timer);
+  for (i = 0; i < n_timeouts; i++) {
+    swfdec_player_remove_timeout (player, &timeouts[i].timeout);
+  }
+  g_print ("TIMEOUTS: removing %u timeouts %.3fms\n", n_timeouts,
+      g_timer_elapsed (timer, NULL) * 1000);
+
+  g_object_unref (player);
+  g_timer_destroy (timer);
+  g_free (timeouts);
+}
+
+/* puts lots of children into one movie and looks them up by name and depth 
+ * like path lookups in scripts do. This is what content with huge numbers of
+ * attached or duplicated movies costs. */
+static void
+bench_children (guint n_children, guint n_lookups)
+{
+  SwfdecResource *resource;
+  SwfdecPlayer *player;
+  SwfdecMovie *root;
+  const char **names;
+  GTimer *timer;
+  guint i, found;
+
+  player = swfdec_player_new (NULL);
+  resource = g_object_new (SWFDEC_TYPE_RESOURCE, "context", player, NULL);
+  root = SWFDEC_MOVIE (swfdec_player_create_movie_at_level (player, resource, 0));
+  names = g_new (const char *, n_children);
+  timer = g_timer_new ();
+  for (i = 0; i < n_children; i++) {
+    names[i] = swfdec_as_context_give_string (SWFDEC_AS_CONTEXT (player),
+	g_strdup_printf ("child%u", i));
+    swfdec_movie_new (player, i, root, resource, NULL, names[i]);
+  }
+  g_print ("CHILDREN: adding %u children %.3fms\n", n_children,
+      g_timer_elapsed (timer, NULL) * 1000);
+
+  found = 0;
+  g_timer_start (timer);
+  for (i = 0; i < n_lookups; i++) {
+    if (swfdec_movie_get_by_name (root, names[(i * 7919) % n_children], TRUE))
+      found++;
+  }
+  g_print ("CHILDREN: %u lookups by name (%u found) %.3fms\n", n_lookups, found,
+      g_timer_elapsed (timer, NULL) * 1000);
+
+  found = 0;
+  g_timer_start (timer);
+  for (i = 0; i < n_lookups; i++) {
+    if (swfdec_movie_find (root, (i * 7919) % n_children))
+      found++;
+  }
+  g_print ("CHILDREN: %u lookups by depth (%u found) %.3fms\n", n_lookups, found,
+      g_timer_elapsed (timer, NULL) * 1000);
+
+  g_timer_start (timer);
+  swfdec_movie_destroy (root);
+  g_print ("CHILDREN: removing %u children %.3fms\n", n_children,
+      g_timer_elapsed (timer, NULL) * 1000);
+
+  g_object_unref (player);
+  g_timer_destroy (timer);
+  g_free (names);
+}
+
+/* builds a long string by appending pieces to it like scripts doing s += x in
+ * a loop do. The time this takes should grow linearly with the size. */
+static void
+bench_concat (guint n_bytes)
+{
+  SwfdecAsContext *cx;
+  SwfdecResource *resource;
+  SwfdecPlayer *player;
+  SwfdecAsObject *object;
+  SwfdecAsValue val;
+  const char *strings[2];
+  const char *piece, *name;
+  char *tmp;
+  GTimer *timer, *gc_timer;
+  guint i, n_pieces;
+
+  player = swfdec_player_new (NULL);
+  cx = SWFDEC_AS_CONTEXT (player);
+  resource = g_object_new (SWFDEC_TYPE_RESOURCE, "context", player, NULL);
+  /* the root movie keeps the strings alive while collecting garbage */
+  object = swfdec_as_relay_get_as_object (SWFDEC_AS_RELAY (
+	swfdec_player_create_movie_at_level (player, resource, 0)));
+  tmp = g_strnfill (1024, 'x');
+  piece = swfdec_as_context_give_string (cx, tmp);
+  SWFDEC_AS_VALUE_SET_STRING (&val, piece);
+  swfdec_as_object_set_variable (object, swfdec_as_context_get_string (cx, "piece"), &val);
+  name = swfdec_as_context_get_string (cx, "s");
+  n_pieces = MAX (1, n_bytes / 1024);
+
+  timer = g_timer_new ();
+  gc_timer = g_timer_new ();
+  g_timer_stop (gc_timer);
+  strings[0] = piece;
+  strings[1] = piece;
+  for (i = 1; i < n_pieces; i++) {
+    /* like the Add2 action does */
+    strings[0] = swfdec_as_context_join_strings (cx, strings, 2);
+    if (i % 16 == 0) {
+      g_timer_continue (gc_timer);
+      SWFDEC_AS_VALUE_SET_STRING (&val, strings[0]);
+      swfdec_as_object_set_variable (object, name, &val);
+      swfdec_as_context_gc (cx);
+      g_timer_stop (gc_timer);
+    }
+  }
+  g_print ("CONCAT: appending %u pieces of 1024 bytes %.3fms (gc %.3fms)\n",
+      n_pieces, g_timer_elapsed (timer, NULL) * 1000,
+      g_timer_elapsed (gc_timer, NULL) * 1000);
+
+  g_object_unref (player);
+  g_timer_destroy (timer);
+  g_timer_destroy (gc_timer);
+}
+
+static void
+bench_char_codes_scan (SwfdecAsContext *cx, const char *name, const char *str)
+{
+  GTimer *timer;
+  gsize i, length;
+  gunichar sum;
+
+  timer = g_timer_new ();
+  length = swfdec_as_str_length (cx, str);
+  sum = 0;
+  for (i = 0; i < length; i++) {
+    sum += g_utf8_get_char (swfdec_as_str_offset_to_pointer (cx, str, i));
+  }
+  g_print ("CHARCODES: scanning %"G_GSIZE_FORMAT" characters of %s string (%u) %.3fms\n",
+      length, name, sum, g_timer_elapsed (timer, NULL) * 1000);
+  g_timer_destroy (timer);
+}
+
+/* reads every character of a string like parsers doing charCodeAt() in a 
+ * loop do, both for ASCII strings and for strings with other characters */
+static void
+bench_char_codes (guint n_bytes)
+{
+  SwfdecAsContext *cx;
+  SwfdecPlayer *player;
+  GString *string;
+
+  player = swfdec_player_new (NULL);
+  cx = SWFDEC_AS_CONTEXT (player);
+
+  string = g_string_new ("");
+  while (string->len < n_bytes)
+    g_string_append (string, "abcd");
+  bench_char_codes_scan (cx, "ASCII", swfdec_as_context_get_string (cx, string->str));
+
+  g_string_truncate (string, 0);
+  while (string->len < n_bytes)
+    g_string_append (string, "abc\xc3\xa4");
+  bench_char_codes_scan (cx, "UTF-8", swfdec_as_context_get_string (cx, string->str));
+
+  g_string_free (string, TRUE);
+  g_object_unref (player);
+}
+
+/* loads a file and duplicates the first movie clip of the root movie lots of
+ * times, like particle systems using duplicateMovieClip() do */
+static void
+bench_duplicates (const char *filename, guint n_duplicates)
+{
+  SwfdecPlayer *player;
+  SwfdecMovie *root, *clip;
+  SwfdecSandbox *sandbox;
+  SwfdecURL *url;
+  GTimer *timer;
+  GList *walk;
+  guint i;
+
+  player = g_object_new (SWFDEC_TYPE_PLAYER, "loader-type", SWFDEC_TYPE_FILE_LOADER,
+      "max-runtime", 0, NULL);
+  url = swfdec_url_new_from_input (filename);
+  swfdec_player_set_url (player, url);
+  swfdec_url_free (url);
+  while (swfdec_player_get_next_event (player) == 0)
+    swfdec_player_advance (player, 0);
+
+  clip = NULL;
+  root = player->priv->roots ? player->priv->roots->data : NULL;
+  for (walk = root ? root->list : NULL; walk; walk = walk->next) {
+    if (SWFDEC_IS_SPRITE_MOVIE (walk->data)) {
+      clip = walk->data;
+      break;
+    }
+  }
+  if (clip == NULL) {
+    g_print ("DUPLICATES: %s contains no movie clip to duplicate\n", filename);
+    g_object_unref (player);
+    return;
+  }
+
+  sandbox = clip->resource->sandbox;
+  timer = g_timer_new ();
+  swfdec_sandbox_use (sandbox);
+  for (i = 0; i < n_duplicates; i++) {
+    const char *name = swfdec_as_context_give_string (SWFDEC_AS_CONTEXT (player),
+	g_strdup_printf ("duplicate%u", i));
+    swfdec_movie_duplicate (clip, name, i);
+  }
+  swfdec_sandbox_unuse (sandbox);
+  g_print ("DUPLICATES: duplicating %s %u times %.3fms\n", clip->name, n_duplicates,
+      g_timer_elapsed (timer, NULL) * 1000);
+
+  g_object_unref (player);
+  g_timer_destroy (timer);
+}
+
+static double
+bench_fps (const BenchResult *result)
+{
+  if (result->time[BENCH_TOTAL] <= 0)
+    return 0;
+  return result->frames / result->time[BENCH_TOTAL];
+}
+
+/*** OUTPUT ***/
+
+static void
+bench_append_json_string (GString *string, const char *s)
+{
+  g_string_append_c (string, '"');
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\')
+      g_string_append_printf (string, "\\%c", *s);
+    else if ((guchar) *s < 0x20)
+      g_string_append_printf (string, "\\u%04X", (guint) *s);
+    else
+      g_string_append_c (string, *s);
+  }
+  g_string_append_c (string, '"');
+}
+
+/* NB: bench_load_baseline() relies on every result being on a single line */
+static void
+bench_append_json_result (GString *string, const BenchResult *result)
+{
+  guint i;
+
+  g_string_append (string, "{ \"file\": ");
+  bench_append_json_string (string, result->filename);
+  for (i = 0; i < N_BENCH_TIMES; i++) {
+    g_string_append_printf (string, ", \"%s\": %.6f", bench_time_names[i], result->time[i]);
+  }
+  g_string_append_printf (string, ", \"frames\": %u, \"fps\": %.2f, \"memory\": %"G_GSIZE_FORMAT", \"aborted\": %s }",
+      result->frames, bench_fps (result), result->memory, result->aborted ? "true" : "false");
+}
+
+static gboolean
+bench_write_json (const char *filename, const BenchResult *results, guint n_results,
+    const BenchResult *total, glong peak_rss)
+{
+  GError *error = NULL;
+  GString *string;
+  guint i;
+
+  string = g_string_new ("{\n  \"files\": [\n");
+  for (i = 0; i < n_results; i++) {
+    g_string_append (string, "    ");
+    bench_append_json_result (string, &results[i]);
+    g_string_append (string, i + 1 < n_results ? ",\n" : "\n");
+  }
+  g_string_append (string, "  ],\n  \"total\": ");
+  bench_append_json_result (string, total);
+  g_string_append_printf (string, ",\n  \"peak-rss\": %ld\n}\n", peak_rss);
+
+  if (g_str_equal (filename, "-")) {
+    g_print ("%s", string->str);
+  } else if (!g_file_set_contents (filename, string->str, string->len, &error)) {
+    g_printerr ("Couldn't write %s: %s\n", filename, error->message);
+    g_error_free (error);
+    g_string_free (string, TRUE);
+    return FALSE;
+  }
+  g_string_free (string, TRUE);
+  return TRUE;
+}
+
+/*** PROFILE ***/
+
+typedef struct {
+  const char *		name;
+  guint64		calls;
+  guint64		time;
+} BenchProfileEntry;
+
+static void
+bench_profile_collect (const char *name, guint64 calls, guint64 time, gpointer array)
+{
+  BenchProfileEntry entry = { name, calls, time };
+
+  g_array_append_val (array, entry);
+}
+
+static int
+bench_profile_compare (gconstpointer a, gconstpointer b)
+{
+  const BenchProfileEntry *ea = a, *eb = b;
+
+  if (ea->time == eb->time)
+    return 0;
+  return ea->time < eb->time ? 1 : -1;
+}
+
+static void
+bench_profile_print (SwfdecAsProfiler *profiler, const char *title,
+    void (* foreach) (SwfdecAsProfiler *, SwfdecAsProfilerFunc, gpointer))
+{
+  GArray *array;
+  guint i;
+
+  array = g_array_new (FALSE, FALSE, sizeof (BenchProfileEntry));
+  foreach (profiler, bench_profile_collect, array);
+  g_array_sort (array, bench_profile_compare);
+  g_print ("Top %s:\n", title);
+  for (i = 0; i < MIN (array->len, 10); i++) {
+    BenchProfileEntry *entry = &g_array_index (array, BenchProfileEntry, i);
+    g_print ("  %10.3fms %10"G_GUINT64_FORMAT" calls  %s\n", entry->time / 1000000.,
+	entry->calls, entry->name);
+  }
+  g_array_free (array, TRUE);
+}
+
+static gboolean
+bench_profile_write (SwfdecAsProfiler *profiler, const char *filename)
+{
+  GError *error = NULL;
+  char *folded;
+  gboolean ret;
+
+  bench_profile_print (profiler, "actions", swfdec_as_profiler_foreach_action);
+  bench_profile_print (profiler, "native functions", swfdec_as_profiler_foreach_native);
+  bench_profile_print (profiler, "scripts", swfdec_as_profiler_foreach_script);
+
+  folded = swfdec_as_profiler_get_folded_stacks (profiler);
+  ret = g_file_set_contents (filename, folded, -1, &error);
+  if (!ret) {
+    g_printerr ("Couldn't write %s: %s\n", filename, error->message);
+    g_error_free (error);
+  }
+  g_free (folded);
+  return ret;
+}
+
+/*** BASELINE ***/
+
+/* parses the output of bench_write_json(), returns file => total time */
+static GHashTable *
+bench_load_baseline (const char *filename)
+{
+  GError *error = NULL;
+  GHashTable *table;
+  char *contents, **lines;
+  guint i;
+
+  if (!g_file_get_contents (filename, &contents, NULL, &error)) {
+    g_printerr ("Couldn't read baseline: %s\n", error->message);
+    g_error_free (error);
+    return NULL;
+  }
+  table = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  lines = g_strsplit (contents, "\n", -1);
+  g_free (contents);
+  for (i = 0; lines[i]; i++) {
+    char *file, *time, *end;
+    double *value;
+
+    file = strstr (lines[i], "\"file\": \"");
+    time = strstr (lines[i], "\"time\": ");
+    if (file == NULL || time == NULL)
+      continue;
+    file += 9;
+    for (end = file; *end && *end != '"'; end++) {
+      if (*end == '\\' && end[1])
+	end++;
+    }
+    *end = 0;
+    value = g_new (double, 1);
+    *value = g_ascii_strtod (time + 8, NULL);
+    g_hash_table_insert (table, g_strcompress (file), value);
+  }
+  g_strfreev (lines);
+  return table;
+}
+
+static void
+bench_print_comparison (const char *name, double old, double new, double threshold)
+{
+  double change = old > 0 ? (new - old) / old * 100 : 0;
+
+  g_print ("%s: %.3fs => %.3fs (%+.1f%%)%s\n", name, old, new, change,
+      change > threshold ? " SLOWER" : change < -threshold ? " FASTER" : "");
+}
+
+/* returns TRUE if the total time regressed by more than threshold percent */
+static gboolean
+bench_compare (GHashTable *baseline, const BenchResult *results, guint n_results,
+    double threshold)
+{
+  double old_total = 0, new_total = 0;
+  guint i;
+
+  g_print ("Comparison against baseline:\n");
+  for (i = 0; i < n_results; i++) {
+    double *old = g_hash_table_lookup (baseline, results[i].filename);
+    if (old == NULL) {
+      g_print ("%s: not in baseline\n", results[i].filename);
+      continue;
+    }
+    bench_print_comparison (results[i].filename, *old, results[i].time[BENCH_TOTAL], threshold);
+    old_total += *old;
+    new_total += results[i].time[BENCH_TOTAL];
+  }
+  bench_print_comparison ("TOTAL", old_total, new_total, threshold);
+  return old_total > 0 && (new_total - old_total) / old_total * 100 > threshold;
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *err = NULL;
+  BenchResult *results, total;
+  struct rusage usage;
+  guint i, j, n_results;
+  gboolean regressed = FALSE;
+  char *size = NULL;
+  char *output = NULL;
+  char *baseline = NULL;
+  char *profile = NULL;
+  SwfdecAsProfiler *profiler = NULL;
+  int width = 0, height = 0;
+  glong play_per_file = 10;
+  glong max_per_file = 60;
+  glong gc_threshold = 8 * 1024 * 1024;
+  double threshold = 10;
+  int n_sandboxes = 0;
+  int sandbox_version = 8;
+  int n_timeouts = 0;
+  int n_children = 0;
+  int n_duplicates = 0;
+  int n_concat = 0;
+  int n_char_codes = 0;
+  char **filenames = NULL;
+  const GOptionEntry entries[] = {
+    {
+      "play-time", 'p', 0, G_OPTION_ARG_INT, &play_per_file,
+      "How many seconds of virtual time will be played from each file (default 10)", NULL
+    },
+    {
+      "max-per-file", '\0', 0, G_OPTION_ARG_INT, &max_per_file,
+      "Maximum runtime in seconds allowed for each file (default 60)", NULL
+    },
+    {
+      "size", 's', 0, G_OPTION_ARG_STRING, &size,
+      "Size of the image to render to (default: size of the movie)", "WIDTHxHEIGHT"
+    },
+    {
+      "gc-threshold", '\0', 0, G_OPTION_ARG_INT, &gc_threshold,
+      "Bytes to allocate before garbage collecting (default 8388608)", NULL
+    },
+    {
+      "output", 'o', 0, G_OPTION_ARG_FILENAME, &output,
+      "Write results as JSON to the given file or - for stdout", "FILE"
+    },
+    {
+      "baseline", 'b', 0, G_OPTION_ARG_FILENAME, &baseline,
+      "Compare results to a file previously written with --output", "FILE"
+    },
+    {
+      "profile", '\0', 0, G_OPTION_ARG_FILENAME, &profile,
+      "Profile scripts and write folded stacks for flame graphs to the given file", "FILE"
+    },
+    {
+      "threshold", 't', 0, G_OPTION_ARG_DOUBLE, &threshold,
+      "Percentage of slowdown against the baseline that is a failure (default 10)", NULL
+    },
+    {
+      "sandboxes", '\0', 0, G_OPTION_ARG_INT, &n_sandboxes,
+      "Measure creating the given number of sandboxes for different hosts", "N"
+    },
+    {
+      "sandbox-version", '\0', 0, G_OPTION_ARG_INT, &sandbox_version,
+      "Flash version of the sandboxes created by --sandboxes (default 8)", NULL
+    },
+    {
+      "timeouts", '\0', 0, G_OPTION_ARG_INT, &n_timeouts,
+      "Measure scheduling the given number of repeating timeouts for --play-time seconds", "N"
+    },
+    {
+      "children", '\0', 0, G_OPTION_ARG_INT, &n_children,
+      "Measure looking up children in a movie containing the given number of children", "N"
+    },
+    {
+      "duplicates", '\0', 0, G_OPTION_ARG_INT, &n_duplicates,
+      "Measure duplicating the first movie clip of each input file the given number of times", "N"
+    },
+    {
+      "concat", '\0', 0, G_OPTION_ARG_INT, &n_concat,
+      "Measure building a string of the given number of bytes by appending to it", "N"
+    },
+    {
+      "char-codes", '\0', 0, G_OPTION_ARG_INT, &n_char_codes,
+      "Measure reading every character of strings with the given number of bytes", "N"
+    },
+    {
+      G_OPTION_REMAINING, '\0', 0, G_OPTION_ARG_FILENAME_ARRAY, &filenames,
+      NULL, "<INPUT FILE> [<INPUT FILE> ...]"
+    },
+    {
+      NULL
+    }
+  };
+
+  // catch asserts and don't spew debug output by default
+  g_log_set_always_fatal (G_LOG_LEVEL_ERROR | G_LOG_LEVEL_CRITICAL | G_LOG_LEVEL_WARNING);
+  g_setenv ("SWFDEC_DEBUG", "0", FALSE);
+
+  // init
+  swfdec_init ();
+
+  // read command line params
+  context = g_option_context_new ("Benchmark playback of Flash files");
+  g_option_context_add_main_entries (context, entries, NULL);
+
+  if (g_option_context_parse (context, &argc, &argv, &err) == FALSE) {
+    g_printerr ("Couldn't parse command-line options: %s\n", err->message);
+    g_error_free (err);
+    return 1;
+  }
+  g_option_context_free (context);
+
+  if (n_sandboxes > 0)
+    bench_sandboxes (n_sandboxes, sandbox_version);
+  if (n_timeouts > 0)
+    bench_timeouts (n_timeouts, play_per_file * 1000);
+  if (n_children > 0)
+    bench_children (n_children, 100000);
+  if (n_concat > 0)
+    bench_concat (n_concat);
+  if (n_char_codes > 0)
+    bench_char_codes (n_char_codes);
+  if ((n_sandboxes > 0 || n_timeouts > 0 || n_children > 0 || n_concat > 0 ||
+	n_char_codes > 0) && filenames == NULL)
+    return 0;
+  if (filenames == NULL || g_strv_length (filenames) < 1) {
+    g_printerr ("At least one input filename is required\n");
+    return 1;
+  }
+  if (size != NULL &&
+      (sscanf (size, "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0)) {
+    g_printerr ("Invalid size \"%s\", must be WIDTHxHEIGHT\n", size);
+    return 1;
+  }
+
+  bench_hook_decoders ();
+  if (n_duplicates > 0) {
+    for (i = 0; filenames[i]; i++) {
+      bench_duplicates (filenames[i], n_duplicates);
+    }
+  }
+  if (profile)
+    profiler = swfdec_as_profiler_new ();
+
+  n_results = g_strv_length (filenames);
+  results = g_new0 (BenchResult, n_results);
+  memset (&total, 0, sizeof (BenchResult));
+  total.filename = g_strdup ("total");
+  for (i = 0; i < n_results; i++) {
+    results[i].filename = filenames[i];
+    bench_run (&results[i], play_per_file * 1000, max_per_file * 1000,
+	width, height, (gsize) gc_threshold, profiler);
+    g_print ("%s: %.3fs (as %.3fs, render %.3fs, audio %.3fs, gc %.3fs, decode %.3fs), %.1f fps%s\n",
+	results[i].filename, results[i].time[BENCH_TOTAL], results[i].time[BENCH_AS],
+	results[i].time[BENCH_RENDER], results[i].time[BENCH_AUDIO], results[i].time[BENCH_GC],
+	results[i].time[BENCH_DECODE], bench_fps (&results[i]),
+	results[i].aborted ? " *** Aborted ***" : "");
+    for (j = 0; j < N_BENCH_TIMES; j++) {
+      total.time[j] += results[i].time[j];
+    }
+    total.frames += results[i].frames;
+    total.memory = MAX (total.memory, results[i].memory);
+    total.aborted |= results[i].aborted;
+  }
+  getrusage (RUSAGE_SELF, &usage);
+  g_print ("TOTAL: %.3fs (as %.3fs, render %.3fs, audio %.3fs, gc %.3fs, decode %.3fs), %.1f fps, peak RSS %ldkB\n",
+      total.time[BENCH_TOTAL], total.time[BENCH_AS], total.time[BENCH_RENDER],
+      total.time[BENCH_AUDIO], total.time[BENCH_GC], total.time[BENCH_DECODE],
+      bench_fps (&total), usage.ru_maxrss);
+
+  if (profiler) {
+    if (!bench_profile_write (profiler, profile))
+      regressed = TRUE;
+    g_object_unref (profiler);
+  }
+  if (output && !bench_write_json (output, results, n_results, &total, usage.ru_maxrss))
+    regressed = TRUE;
+  if (baseline) {
+    GHashTable *table = bench_load_baseline (baseline);
+    if (table == NULL) {
+      regressed = TRUE;
+    } else {
+      regressed |= bench_compare (table, results, n_results, threshold);
+      g_hash_table_destroy (table);
+    }
+  }
+
+  g_free (total.filename);
+  g_free (results);
+  g_strfreev (filenames);
+  g_free (size);
+  g_free (output);
+  g_free (baseline);
+  g_free (profile);
+
+  return regressed ? 1 : 0;
+}